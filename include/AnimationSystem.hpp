@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "BezierCurve.hpp"
+#include "LayoutCalculator.hpp"
+
+// Timing of one transition, in milliseconds
+struct TransitionParams {
+    float durationMs = 800.0f;
+    float staggerMs = 50.0f;
+    TransitionStyle style = TransitionStyle::SMOOTH_SLIDE;
+};
+
+// Frame-driven transition scheduler.
+//
+// Interpolates every slot of a LayoutBatch from its start to its target
+// geometry. Slot i starts `i * staggerMs` after the transition begins and
+// runs for `durationMs`; slots that start on their target are done from
+// the start. tick() is called once per monitor frame and reports which
+// slots changed, so the caller only touches and damages the windows that
+// actually moved in that frame.
+class AnimationSystem {
+  public:
+    // Starts a transition; `from` and `to` must have the same size and
+    // slot i of both batches must describe the same window.
+    void start(const LayoutBatch& from, const LayoutBatch& to, const TransitionParams& params,
+               double nowMs);
+
+    // Advances the transition to `nowMs`. Returns true while any slot is
+    // still running; current() and moved() describe this frame.
+    bool tick(double nowMs);
+
+    void cancel();
+
+    bool active() const { return m_running > 0; }
+    std::size_t size() const { return m_to.size(); }
+
+    const LayoutBatch& current() const { return m_current; }
+    const LayoutBatch& target() const { return m_to; }
+    const std::vector<std::uint32_t>& moved() const { return m_moved; }
+
+  private:
+    LayoutBatch m_from;
+    LayoutBatch m_to;
+    LayoutBatch m_current;
+
+    // Per-slot eased progress for the current frame
+    std::vector<float> m_progress;
+    std::vector<std::uint8_t> m_done;
+    std::vector<std::uint32_t> m_moved;
+
+    EasingFn m_easing = nullptr;
+    double m_startMs = 0.0;
+    float m_durationMs = 0.0f;
+    float m_staggerMs = 0.0f;
+    std::size_t m_running = 0;
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// Easing curves for stack transitions. Host-independent like
+// LayoutCalculator so it can be exercised without a compositor.
+
+// Values match plugin:stack3d:transition_style
+enum class TransitionStyle : std::int32_t {
+    SMOOTH_SLIDE = 0,
+    BOUNCE_OUT = 1,
+    ELASTIC_OUT = 2,
+    CASCADE_WAVE = 3,
+    SPIRAL_MOTION = 4,
+    MAGNETIC_ATTRACT = 5,
+    LIQUID_FLOW = 6,
+};
+
+// Maps normalized time [0, 1] to eased progress
+using EasingFn = float (*)(float);
+
+// Cubic Bezier with P0 = (0, 0) and P3 = (1, 1), sampled once into a
+// lookup table so evaluation on the frame path is a lerp between samples.
+class BezierCurve {
+  public:
+    BezierCurve(float x1, float y1, float x2, float y2);
+
+    float evaluate(float t) const;
+
+  private:
+    static constexpr int SAMPLES = 256;
+
+    std::array<float, SAMPLES + 1> m_table{};
+};
+
+// Easing function for a configured style; unknown values fall back to
+// SMOOTH_SLIDE. Resolve it once per transition, not per window.
+EasingFn easingForStyle(TransitionStyle style);
+
+// Converts the raw plugin:stack3d:transition_style value
+TransitionStyle transitionStyleFromConfig(std::int64_t value);
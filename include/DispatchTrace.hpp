@@ -0,0 +1,167 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "LayoutCalculator.hpp"
+#include "Stack3DConfig.hpp"
+
+// One record of a dispatch trace
+enum class TraceEventType : std::uint8_t {
+    // RawStack3DConfig in effect from here on
+    CONFIG,
+    // Dispatches on `workspace`, shown on `monitor`
+    TOGGLE,
+    CYCLE,
+    LAYER,
+    SPREAD,
+    // Window index events
+    WINDOW_OPEN,
+    WINDOW_CLOSE,
+    WINDOW_MOVE,
+    // Goal geometry, alpha and flags of a window, written before a
+    // dispatch or re-layout whenever they changed since last written
+    WINDOW_STATE,
+    // Live re-layout of `workspace` on `monitor`
+    RELAYOUT,
+    WORKSPACE_DESTROY,
+    // Geometry each window ended up with, written when recording stops
+    FINAL,
+    COUNT,
+};
+
+const char* traceEventName(TraceEventType type);
+
+// Dispatch flags: a transition was running when the dispatch came in, and
+// the workspace draws its stacks as render transforms afterwards
+inline constexpr std::uint8_t TRACE_MOTION_ACTIVE = 1u << 0;
+inline constexpr std::uint8_t TRACE_RENDER_TRANSFORM = 1u << 1;
+
+// Window state flags; excluded windows (hidden, fullscreen) are indexed
+// but left out of dispatches
+inline constexpr std::uint8_t TRACE_WINDOW_FLOATING = 1u << 0;
+inline constexpr std::uint8_t TRACE_WINDOW_EXCLUDED = 1u << 1;
+
+// Spread dispatch without a layout argument
+inline constexpr std::int32_t TRACE_DEFAULT_LAYOUT = -1;
+
+// Decoded trace record; fields a type does not use are left at defaults
+struct TraceEvent {
+    TraceEventType type = TraceEventType::CONFIG;
+    // Microseconds since the trace started
+    std::uint64_t timeUs = 0;
+
+    // Trace-local window number, assigned on first sight
+    std::uint32_t window = 0;
+    std::int64_t workspace = 0;
+
+    // Cycle step, layer, or spread layout (TRACE_DEFAULT_LAYOUT)
+    std::int32_t value = 0;
+    // Dispatch or window state flags
+    std::uint8_t flags = 0;
+
+    MonitorGeometry monitor;
+
+    float x = 0.0f;
+    float y = 0.0f;
+    float width = 0.0f;
+    float height = 0.0f;
+    float alpha = 1.0f;
+
+    RawStack3DConfig config;
+};
+
+// What a WINDOW_STATE record holds
+struct TraceWindow {
+    float x = 0.0f;
+    float y = 0.0f;
+    float width = 0.0f;
+    float height = 0.0f;
+    float alpha = 1.0f;
+    std::uint8_t flags = 0;
+
+    bool operator==(const TraceWindow&) const = default;
+};
+
+// Records dispatches and window events into a compact binary trace.
+//
+// A trace is an 8-byte magic and a version, followed by records: a type
+// byte, the time since the previous record as a LEB128 varint in
+// microseconds, then the type's fields (varints for ids and small ints,
+// zigzag varints for signed values, little-endian float32 for geometry,
+// and float64 for config values). Window pointers are replaced by small
+// sequential numbers, so traces hold no addresses. Host-independent: the
+// plugin appends events and writes the buffer out when recording stops.
+//
+// Window geometry is not derived from the dispatches: before each one the
+// plugin syncs the workspace's windows, and only those whose goal state
+// changed (moved by the compositor, caught mid-transition) are written.
+// A replay therefore feeds every dispatch exactly the input it had live.
+class TraceWriter {
+  public:
+    // Recording stops appending once the buffer reaches this size
+    static constexpr std::size_t MAX_BYTES = 64u << 20;
+
+    void start(double nowMs);
+    void stop();
+    bool recording() const { return m_recording; }
+    // The buffer filled up and later events were dropped
+    bool truncated() const { return m_truncated; }
+
+    // Trace-local number of `id`, assigned on first use
+    std::uint32_t windowNumber(WindowId id);
+    // Drops a closed window, so a new one at the same address gets a
+    // number of its own
+    void forgetWindow(WindowId id);
+
+    void append(const TraceEvent& event, double nowMs);
+    // Appends WINDOW_STATE for `id` unless `window` is what was last
+    // written or expected for it
+    void syncWindow(WindowId id, const TraceWindow& window, double nowMs);
+    // Notes the state the plugin itself left `id` in; a replay computes it
+    // too, so it is not written
+    void expectWindow(WindowId id, const TraceWindow& window);
+
+    const std::vector<std::uint8_t>& bytes() const { return m_bytes; }
+    std::size_t events() const { return m_events; }
+
+  private:
+    std::vector<std::uint8_t> m_bytes;
+    std::unordered_map<WindowId, std::uint32_t> m_windowNumbers;
+    std::unordered_map<WindowId, TraceWindow> m_windowStates;
+    std::uint32_t m_nextWindow = 0;
+    double m_startMs = 0.0;
+    std::uint64_t m_lastUs = 0;
+    std::size_t m_events = 0;
+    bool m_recording = false;
+    bool m_truncated = false;
+};
+
+// Decodes a trace written by TraceWriter
+class TraceReader {
+  public:
+    explicit TraceReader(std::span<const std::uint8_t> bytes);
+
+    // Header matched; a reader over a foreign file yields no events
+    bool valid() const { return m_valid; }
+    // Decoding stopped at a record cut short or of unknown type
+    bool corrupt() const { return m_corrupt; }
+
+    // Decodes the next record; false at the end of the trace or on
+    // corruption
+    bool next(TraceEvent& event);
+
+  private:
+    std::span<const std::uint8_t> m_bytes;
+    std::size_t m_offset = 0;
+    std::uint64_t m_timeUs = 0;
+    bool m_valid = false;
+    bool m_corrupt = false;
+};
+
+bool writeTraceFile(const std::string& path, std::span<const std::uint8_t> bytes);
+std::optional<std::vector<std::uint8_t>> readTraceFile(const std::string& path);
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Effect levels, cheapest last; each tier keeps the cuts of the ones
+// before it
+enum class QualityTier : std::uint8_t {
+    FULL,
+    // No motion blur
+    NO_BLUR,
+    // At most CAPPED_WINDOWS windows animate per transition, the rest warp
+    CAPPED,
+    // Every transition warps
+    WARP,
+};
+
+const char* qualityTierName(QualityTier tier);
+
+// Keeps the plugin's per-frame cost inside a share of the refresh
+// interval.
+//
+// Each frame that ran a transition step reports what it cost. Once
+// OVERRUN_FRAMES frames in a row exceed BUDGET_SHARE of the monitor's
+// refresh interval the governor steps down one tier; it steps back up one
+// tier after RECOVER_MS in which every measured frame stayed under
+// HEADROOM of the budget. Frames without plugin work count as headroom,
+// so a warped workspace recovers too. The gap between the two thresholds,
+// and recovery being counted from the last change, keep a borderline load
+// from flapping between tiers. Host-independent: the plugin times its
+// preRender and reads tier() on every transition.
+class FrameGovernor {
+  public:
+    static constexpr double BUDGET_SHARE = 0.25;
+    static constexpr int OVERRUN_FRAMES = 6;
+    static constexpr double HEADROOM = 0.5;
+    static constexpr double RECOVER_MS = 3000.0;
+    static constexpr std::uint32_t CAPPED_WINDOWS = 8;
+
+    // A frame that ran plugin work costing `costMs`, on a monitor
+    // refreshing every `refreshIntervalMs`; true if the tier changed
+    bool record(double costMs, double refreshIntervalMs, double nowMs);
+    // A frame without plugin work; true if the tier changed
+    bool idle(double nowMs);
+
+    QualityTier tier() const { return m_tier; }
+    // Back to FULL, counters cleared
+    void reset();
+
+    // Tier, the last frame's cost against its budget and the tier changes
+    std::string report() const;
+
+  private:
+    bool recover(double nowMs);
+
+    QualityTier m_tier = QualityTier::FULL;
+    int m_overruns = 0;
+    double m_lastChangeMs = 0.0;
+    // Last frame above HEADROOM of its budget
+    double m_lastTightMs = 0.0;
+    double m_lastCostMs = 0.0;
+    double m_lastBudgetMs = 0.0;
+    std::uint64_t m_stepsDown = 0;
+    std::uint64_t m_stepsUp = 0;
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "LayoutCalculator.hpp"
+
+// What a window looked like before it was stacked
+struct SavedGeometry {
+    WindowId id = 0;
+    std::int64_t workspace = 0;
+    float x = 0.0f;
+    float y = 0.0f;
+    float width = 0.0f;
+    float height = 0.0f;
+    float alpha = 1.0f;
+    bool floating = false;
+    // Identifies the window beyond its id, which a new window can reuse
+    // once this one closes (see SessionWindow::fingerprint)
+    std::uint64_t fingerprint = 0;
+};
+
+// Saved-state table keyed by window identity.
+//
+// Records live in one dense pool and an open-addressing index maps window
+// ids to pool slots, so lookups are O(1), restore is O(n) regardless of
+// windows opened or closed while stacked, and clear() keeps both
+// allocations for the next toggle. Records carry their workspace so
+// several workspaces can be stacked at once.
+class GeometryStore {
+  public:
+    // Inserts or overwrites the record for `geometry.id`
+    void save(const SavedGeometry& geometry);
+
+    const SavedGeometry* find(WindowId id) const;
+    bool contains(WindowId id) const { return find(id) != nullptr; }
+
+    bool erase(WindowId id);
+
+    // Drops every record saved for `workspace`
+    void eraseWorkspace(std::int64_t workspace);
+
+    void clear();
+    void reserve(std::size_t count);
+
+    std::size_t size() const { return m_records.size(); }
+    bool empty() const { return m_records.empty(); }
+    const std::vector<SavedGeometry>& records() const { return m_records; }
+
+  private:
+    static constexpr std::uint32_t EMPTY_SLOT = 0xFFFFFFFFu;
+    static constexpr std::size_t MIN_BUCKETS = 16;
+
+    std::size_t bucketFor(WindowId id) const;
+    std::size_t findBucket(WindowId id) const;
+    void removeBucket(std::size_t bucket);
+    void rehash(std::size_t bucketCount);
+
+    // Dense record pool; removal swaps the last record into the hole
+    std::vector<SavedGeometry> m_records;
+    // Power-of-two sized, linear probing, values index into m_records
+    std::vector<std::uint32_t> m_buckets;
+};
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Timed sections of a dispatch or frame
+enum class LatencyPhase : std::uint8_t {
+    // Whole dispatches
+    TOGGLE,
+    CYCLE,
+    SPREAD,
+    // Sections inside a dispatch
+    COLLECT,
+    LAYOUT,
+    APPLY,
+    NOTIFY,
+    // One transition step in onPreRender
+    FRAME,
+    // Live re-layout after window events
+    RELAYOUT,
+    COUNT,
+};
+
+const char* latencyPhaseName(LatencyPhase phase);
+
+struct LatencySummary {
+    std::uint64_t count = 0;
+    double meanNs = 0.0;
+    // Upper bounds of the buckets holding the percentile
+    std::uint64_t p50Ns = 0;
+    std::uint64_t p99Ns = 0;
+    std::uint64_t maxNs = 0;
+};
+
+// Fixed-size log-linear histogram of nanosecond samples.
+//
+// Values below 16 ns get a bucket each; above that every power of two is
+// split into 8 buckets, so a bucket bound is within 12.5% of any value in
+// it. Counters are relaxed atomics written by a single thread (the
+// compositor's) with a plain load / store, no lock and no read-modify-write,
+// so a sample costs a few ns; any thread may read a summary, which is then
+// approximate while samples are being added.
+class LatencyHistogram {
+  public:
+    static constexpr unsigned SUB_BUCKET_BITS = 3;
+    static constexpr unsigned LINEAR_BUCKETS = 2u << SUB_BUCKET_BITS;
+    static constexpr std::size_t BUCKETS = LINEAR_BUCKETS + (64 - SUB_BUCKET_BITS - 1) * (1u << SUB_BUCKET_BITS);
+
+    void record(std::uint64_t ns) {
+        bump(m_buckets[bucketOf(ns)], 1);
+        bump(m_count, 1);
+        bump(m_sum, ns);
+        if (ns > m_max.load(std::memory_order_relaxed)) {
+            m_max.store(ns, std::memory_order_relaxed);
+        }
+    }
+
+    LatencySummary summary() const;
+    void reset();
+
+    static std::size_t bucketOf(std::uint64_t ns);
+    // Largest value that falls into `bucket`
+    static std::uint64_t bucketUpperBound(std::size_t bucket);
+
+  private:
+    static void bump(std::atomic<std::uint64_t>& counter, std::uint64_t amount) {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<std::uint64_t>, BUCKETS> m_buckets{};
+    std::atomic<std::uint64_t> m_count{0};
+    std::atomic<std::uint64_t> m_sum{0};
+    std::atomic<std::uint64_t> m_max{0};
+};
+
+// One histogram per LatencyPhase
+class LatencyStats {
+  public:
+    void record(LatencyPhase phase, std::uint64_t ns) { m_phases[static_cast<std::size_t>(phase)].record(ns); }
+    LatencySummary summary(LatencyPhase phase) const { return m_phases[static_cast<std::size_t>(phase)].summary(); }
+    void reset();
+
+    // One line per phase with samples: count, mean, p50, p99 and max
+    std::string report() const;
+
+  private:
+    std::array<LatencyHistogram, static_cast<std::size_t>(LatencyPhase::COUNT)> m_phases;
+};
+
+using LatencyClock = std::chrono::steady_clock;
+
+inline std::uint64_t elapsedNs(LatencyClock::time_point start, LatencyClock::time_point end) {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+}
+
+// Records the lifetime of the scope under `phase`, early returns included
+class ScopedLatency {
+  public:
+    ScopedLatency(LatencyStats& stats, LatencyPhase phase)
+        : m_stats(stats), m_phase(phase), m_start(LatencyClock::now()) {}
+    ~ScopedLatency() { m_stats.record(m_phase, elapsedNs(m_start, LatencyClock::now())); }
+
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+  private:
+    LatencyStats& m_stats;
+    LatencyPhase m_phase;
+    LatencyClock::time_point m_start;
+};
+
+// Times consecutive sections of straight-line code: mark() records the
+// time since construction or the previous mark() under `phase`
+class LatencyLap {
+  public:
+    explicit LatencyLap(LatencyStats& stats) : m_stats(stats), m_last(LatencyClock::now()) {}
+
+    void mark(LatencyPhase phase) {
+        const LatencyClock::time_point now = LatencyClock::now();
+        m_stats.record(phase, elapsedNs(m_last, now));
+        m_last = now;
+    }
+
+  private:
+    LatencyStats& m_stats;
+    LatencyClock::time_point m_last;
+};
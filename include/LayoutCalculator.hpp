@@ -0,0 +1,183 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Host-independent stack layout engine.
+//
+// Nothing in this header (or LayoutCalculator.cpp) may include Hyprland
+// headers: main.cpp gathers the workspace into a WindowBatch, runs one of
+// the kernels below and applies the resulting LayoutBatch to the windows.
+// That keeps the geometry math testable and benchmarkable against
+// tests/mocks/hyprland_mocks.hpp.
+
+// Opaque window identity (the CWindow address inside the plugin)
+using WindowId = std::uint64_t;
+
+// Logical monitor rectangle the layout is centred on
+struct MonitorGeometry {
+    float x = 0.0f;
+    float y = 0.0f;
+    float width = 0.0f;
+    float height = 0.0f;
+    float scale = 1.0f;
+
+    float centerX() const { return x + width / 2.0f; }
+    float centerY() const { return y + height / 2.0f; }
+};
+
+// Parameters of the row-of-stacks layout (plugin:stack3d:* layout values)
+struct StackLayoutParams {
+    int windowsPerStack = 6;
+    float stackSpacing = 400.0f;
+    float windowWidth = 800.0f;
+    float windowHeight = 600.0f;
+    float depthOffsetX = 20.0f;
+    float depthOffsetY = 15.0f;
+    float transparencyStep = 0.15f;
+    float minAlpha = 0.4f;
+    int frontLayer = 0;
+    // Stacks per row before a new row is started (0: a single row) and
+    // the vertical distance between row centres
+    int stacksPerRow = 0;
+    float rowSpacing = 0.0f;
+    // Scale each window into the windowWidth x windowHeight box with its
+    // own aspect ratio (never up) instead of resizing it to the box
+    bool keepAspect = false;
+};
+
+// Structure-of-arrays view of the windows to lay out. Slot i is the i-th
+// window in stacking order; the vectors are reused between dispatches so
+// steady-state toggles do not allocate.
+struct WindowBatch {
+    std::vector<WindowId> ids;
+    std::vector<float> widths;
+    std::vector<float> heights;
+
+    std::size_t size() const { return ids.size(); }
+    bool empty() const { return ids.empty(); }
+
+    void clear() {
+        ids.clear();
+        widths.clear();
+        heights.clear();
+    }
+
+    void reserve(std::size_t count) {
+        ids.reserve(count);
+        widths.reserve(count);
+        heights.reserve(count);
+    }
+
+    void push(WindowId id, float width, float height) {
+        ids.push_back(id);
+        widths.push_back(width);
+        heights.push_back(height);
+    }
+};
+
+// Structure-of-arrays kernel output, one entry per WindowBatch slot
+struct LayoutBatch {
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> width;
+    std::vector<float> height;
+    std::vector<float> alpha;
+
+    std::size_t size() const { return x.size(); }
+
+    void resize(std::size_t count) {
+        x.resize(count);
+        y.resize(count);
+        width.resize(count);
+        height.resize(count);
+        alpha.resize(count);
+    }
+
+    // Slot i holds exactly the same geometry and alpha in both batches
+    bool sameSlot(const LayoutBatch& other, std::size_t i) const {
+        return x[i] == other.x[i] && y[i] == other.y[i] && width[i] == other.width[i] &&
+            height[i] == other.height[i] && alpha[i] == other.alpha[i];
+    }
+};
+
+// Number of stacks needed for `windowCount` windows
+inline int stackCount(std::size_t windowCount, int windowsPerStack) {
+    const std::size_t perStack = static_cast<std::size_t>(std::max(1, windowsPerStack));
+    return static_cast<int>((windowCount + perStack - 1) / perStack);
+}
+
+// Placement of stacks in rows; offsets are in units of the stack / row
+// spacing from the monitor centre
+struct StackGrid {
+    int stacks = 0;
+    int columns = 1;
+    int rows = 1;
+
+    float columnOffset(int stack) const {
+        const int row = stack / columns;
+        const int rowColumns = std::min(columns, stacks - row * columns);
+        return (stack - row * columns) - (rowColumns - 1) / 2.0f;
+    }
+
+    float rowOffset(int stack) const { return (stack / columns) - (rows - 1) / 2.0f; }
+};
+
+inline StackGrid stackGrid(int numStacks, int stacksPerRow) {
+    const int columns = std::max(1, stacksPerRow > 0 ? std::min(stacksPerRow, numStacks) : numStacks);
+    return StackGrid{numStacks, columns, (numStacks + columns - 1) / columns};
+}
+
+// Transparency of a window based on its position in the stack
+inline float calculateAlpha(int positionInStack, int frontLayer, const StackLayoutParams& params) {
+    if (positionInStack == frontLayer) {
+        return 1.0f;
+    }
+    return std::max(params.minAlpha, 1.0f - (positionInStack * params.transparencyStep));
+}
+
+// Largest scale (at most 1) that fits a width x height window into a
+// boxWidth x boxHeight box
+inline float fitScale(float width, float height, float boxWidth, float boxHeight) {
+    return std::min({1.0f, boxWidth / std::max(width, 1.0f), boxHeight / std::max(height, 1.0f)});
+}
+
+// Row-of-stacks layout: windows are grouped `windowsPerStack` at a time,
+// stacks are spread horizontally around the monitor centre (in rows of
+// stacksPerRow when set, last row centred) and every layer
+// is shifted by the depth offset. With keepAspect each window is fitted
+// into the window box instead of resized to it. Fills `out` in a single
+// pass; the inner per-layer loop is branch-free so the compiler can
+// vectorize it.
+void computeStackLayout(const WindowBatch& windows, const MonitorGeometry& monitor,
+                        const StackLayoutParams& params, LayoutBatch& out);
+
+// Most stack counts fitStackLayout() tries above the minimum
+inline constexpr int ADAPTIVE_STACK_SEARCH = 32;
+
+// Shortest edge of the smallest window box fitStackLayout() produces
+inline constexpr float ADAPTIVE_MIN_BOX = 64.0f;
+
+// Adaptive sizing: solves stack count, rows, layers per stack, spacing and
+// the window box for `windowCount` windows so that every stack, including
+// its depth offsets, fits on the monitor with `padding` around and between
+// stacks. `base.windowsPerStack` caps the layers per stack and the box
+// keeps base's aspect ratio. Tries at most ADAPTIVE_STACK_SEARCH stack
+// counts above the minimum, each with the two row lengths around the
+// closed-form optimum, and keeps the largest box; windows are fitted into
+// it with keepAspect.
+//
+// The box never drops below ADAPTIVE_MIN_BOX: the stack count is capped
+// at what fits on the monitor at that size, stacks beyond the cap's
+// capacity get deeper than `base.windowsPerStack`, and deep stacks have
+// their per-layer depth offsets shrunk to stay on the monitor.
+StackLayoutParams fitStackLayout(std::size_t windowCount, const MonitorGeometry& monitor,
+                                 const StackLayoutParams& base, float padding);
+
+// Slots whose alpha changes when the front layer moves from `oldFront` to
+// `newFront`: at most two per stack, appended to `dirty` in slot order.
+// Cycling touches O(stacks) windows instead of the whole workspace.
+void collectFrontLayerChanges(std::size_t windowCount, int windowsPerStack, int oldFront, int newFront,
+                              std::vector<std::uint32_t>& dirty);
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "LayoutCalculator.hpp"
+
+// Trail of a blurred window: where its farthest tap sits relative to the
+// window, in layout pixels (pointing back along the motion)
+struct BlurStreak {
+    float dx = 0.0f;
+    float dy = 0.0f;
+};
+
+// Per-window velocity of a running transition and the windows fast enough
+// to blur.
+//
+// Velocity is the finite difference of each slot's box centre between the
+// frames it moved in, kept in SoA arrays indexed like the transition's
+// batch. Only the slots a frame moved are visited, and a slot that did not
+// move is at rest, so the cost of a frame and of drawing the blur grows
+// with the number of moving windows, not with the stack. A blurred window
+// is drawn with TAPS - 1 fading copies along its streak; the streak is the
+// distance covered in the last frame (capped at MAX_STREAK), so the taps
+// stay inside the area the move already damaged.
+class MotionBlur {
+  public:
+    // Copies drawn per blurred window, the window itself included
+    static constexpr int TAPS = 4;
+    // Slower windows are drawn without blur (px/s)
+    static constexpr float MIN_SPEED = 600.0f;
+    // Longest streak (px), so a frame drop cannot smear a window across
+    // the screen
+    static constexpr float MAX_STREAK = 96.0f;
+    // Opacity of the tap next to the window, relative to the window
+    static constexpr float TAP_ALPHA = 0.35f;
+
+    // Starts tracking a transition beginning at `from`
+    void start(const LayoutBatch& from, double nowMs);
+
+    // Takes the frame's positions of the slots in `moved` and rebuilds
+    // the blurred list from them. Slots outside the batch passed to
+    // start() are ignored.
+    void update(const LayoutBatch& current, std::span<const std::uint32_t> moved, double nowMs);
+
+    // Nothing is blurred until the next start()
+    void clear();
+
+    // Centre velocity of slot `i` (px/s); zero for slots at rest
+    float velocityX(std::size_t i) const { return m_velocityX[i]; }
+    float velocityY(std::size_t i) const { return m_velocityY[i]; }
+
+    // Slots moving faster than MIN_SPEED this frame
+    const std::vector<std::uint32_t>& blurred() const { return m_blurred; }
+    BlurStreak streak(std::size_t i) const { return BlurStreak{m_streakX[i], m_streakY[i]}; }
+
+    // Offset of tap `k` (1 .. TAPS - 1, 1 nearest the window) along
+    // `streak` and its opacity relative to the window
+    static float tapFraction(int k) { return static_cast<float>(k) / (TAPS - 1); }
+    static float tapAlpha(int k) { return TAP_ALPHA * (1.0f - static_cast<float>(k - 1) / (TAPS - 1)); }
+
+  private:
+    // Centres at the last frame each slot moved
+    std::vector<float> m_centerX;
+    std::vector<float> m_centerY;
+    std::vector<float> m_velocityX;
+    std::vector<float> m_velocityY;
+    std::vector<float> m_streakX;
+    std::vector<float> m_streakY;
+    std::vector<std::uint32_t> m_blurred;
+    // Slots the last update gave a velocity, zeroed by the next one
+    std::vector<std::uint32_t> m_moving;
+    double m_lastMs = 0.0;
+};
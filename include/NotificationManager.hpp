@@ -0,0 +1,115 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+// Verbosity of a notification; shown when <= plugin:stack3d:notify_level
+enum class NotifyLevel : std::int32_t {
+    WARNING = 1,
+    INFO = 2,
+    DEBUG = 3,
+};
+
+// Coalescing key: a newer message replaces a pending one of the same topic
+enum class NotifyTopic : std::uint8_t {
+    COMMAND,
+    TOGGLE,
+    CYCLE,
+    WARNING,
+    PLUGIN,
+    OCCLUSION,
+    STATS,
+    TRACE,
+    SEARCH,
+    GOVERNOR,
+    COUNT,
+};
+
+struct NotifyColor {
+    float r = 1.0f;
+    float g = 1.0f;
+    float b = 1.0f;
+    float a = 1.0f;
+};
+
+struct NotifyParams {
+    // 0 off, 1 warnings, 2 status toasts, 3 verbose
+    int verbosity = 2;
+    // Minimum time between two toasts of the same topic
+    double intervalMs = 250.0;
+};
+
+// Rate-limited, coalescing front end for the notification overlay.
+//
+// Messages below the configured verbosity are dropped before their text is
+// built: post() takes a callable producing the text and only invokes it
+// when the message will be kept. A message opens a coalescing window of one
+// interval for its topic and is shown when the window closes; messages
+// arriving meanwhile replace it, so key-repeat cycling ends in a single
+// toast with the latest state instead of one overlay redraw per press.
+// Toasts of one topic are at least one interval apart.
+//
+// Host-independent: the plugin supplies a sink that forwards to
+// HyprlandAPI::addNotification and calls flush() from a timer.
+class NotificationManager {
+  public:
+    using Sink = void (*)(const std::string& text, const NotifyColor& color, int durationMs);
+
+    explicit NotificationManager(Sink sink) : m_sink(sink) {}
+
+    void configure(const NotifyParams& params) { m_params = params; }
+    const NotifyParams& params() const { return m_params; }
+
+    bool enabled(NotifyLevel level) const { return static_cast<int>(level) <= m_params.verbosity; }
+
+    template <typename MakeText>
+    void post(NotifyLevel level, NotifyTopic topic, const NotifyColor& color, int durationMs, double nowMs,
+              MakeText&& makeText) {
+        if (!enabled(level)) {
+            return;
+        }
+        submit(topic, color, durationMs, nowMs, std::string(std::forward<MakeText>(makeText)()));
+    }
+
+    void post(NotifyLevel level, NotifyTopic topic, const NotifyColor& color, int durationMs, double nowMs,
+              const char* text) {
+        post(level, topic, color, durationMs, nowMs, [text] { return text; });
+    }
+
+    // Shows pending toasts whose coalescing window has closed
+    void flush(double nowMs);
+
+    // Milliseconds until the next pending toast is due, or -1 if none
+    double nextFlushDelayMs(double nowMs) const;
+
+    void clear();
+
+    // Messages kept, shown, and replaced before they were shown
+    std::uint64_t posted() const { return m_posted; }
+    std::uint64_t shown() const { return m_shown; }
+    std::uint64_t coalesced() const { return m_coalesced; }
+
+  private:
+    struct TopicState {
+        double lastShownMs = -1.0e300;
+        // When the pending toast is shown
+        double dueMs = 0.0;
+        bool pending = false;
+        std::string text;
+        NotifyColor color;
+        int durationMs = 0;
+    };
+
+    void submit(NotifyTopic topic, const NotifyColor& color, int durationMs, double nowMs, std::string text);
+    void show(TopicState& state, double nowMs);
+
+    Sink m_sink;
+    NotifyParams m_params;
+    std::array<TopicState, static_cast<std::size_t>(NotifyTopic::COUNT)> m_topics;
+
+    std::uint64_t m_posted = 0;
+    std::uint64_t m_shown = 0;
+    std::uint64_t m_coalesced = 0;
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "LayoutCalculator.hpp"
+
+// Axis-aligned rectangle in layout coordinates
+struct VisibleRect {
+    float x = 0.0f;
+    float y = 0.0f;
+    float width = 0.0f;
+    float height = 0.0f;
+};
+
+enum class Visibility : std::uint8_t {
+    HIDDEN,
+    PARTIAL,
+    VISIBLE,
+};
+
+struct OcclusionStats {
+    std::size_t hidden = 0;
+    std::size_t partial = 0;
+    // Window area in total and the part of it covered by opaque windows
+    double totalPixels = 0.0;
+    double culledPixels = 0.0;
+};
+
+// Visible region of every window of a layout.
+//
+// Window j covers window i when j is opaque and closer to the viewer
+// (depth[j] < depth[i]). Each window's rectangle has every covering
+// rectangle subtracted from it; what is left is its visible region as a
+// small set of disjoint rectangles. Candidate occluders come from a
+// uniform grid over the layout, so a window is only tested against the
+// opaque windows near it. A region that would split into more than
+// MAX_RECTS pieces stops subtracting and stays conservatively large, so
+// a window is never reported hidden when any part of it shows.
+class OcclusionCuller {
+  public:
+    static constexpr std::size_t MAX_RECTS = 16;
+    static constexpr int MAX_GRID = 64;
+
+    // `rects` supplies x / y / width / height; `opaque` and `depth` have
+    // one entry per slot
+    void compute(const LayoutBatch& rects, std::span<const std::uint8_t> opaque, std::span<const int> depth);
+
+    std::size_t size() const { return m_visibility.size(); }
+    Visibility visibility(std::size_t i) const { return m_visibility[i]; }
+
+    std::span<const VisibleRect> visibleRects(std::size_t i) const {
+        return std::span<const VisibleRect>(m_rects).subspan(m_offsets[i], m_offsets[i + 1] - m_offsets[i]);
+    }
+
+    const OcclusionStats& stats() const { return m_stats; }
+
+  private:
+    void buildGrid(const LayoutBatch& rects, std::span<const std::uint8_t> opaque);
+    void cellRange(float x, float y, float width, float height, int& x0, int& y0, int& x1, int& y1) const;
+
+    std::vector<Visibility> m_visibility;
+    std::vector<std::uint32_t> m_offsets;
+    std::vector<VisibleRect> m_rects;
+    OcclusionStats m_stats;
+
+    // Occluder grid (CSR: cell -> opaque slots overlapping it)
+    float m_originX = 0.0f;
+    float m_originY = 0.0f;
+    float m_cellW = 1.0f;
+    float m_cellH = 1.0f;
+    int m_columns = 1;
+    int m_rows = 1;
+    std::vector<std::uint32_t> m_cellStart;
+    std::vector<std::uint32_t> m_cellSlots;
+
+    // Scratch
+    std::vector<std::uint32_t> m_stamp;
+    std::vector<VisibleRect> m_region;
+    std::vector<VisibleRect> m_pieces;
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+
+#include "LayoutCalculator.hpp"
+
+// Inputs of the per-layer projection table
+struct ProjectionParams {
+    // Distance of the vanishing point above the stack centre (px)
+    float perspective = 800.0f;
+    // Camera distance from the front layer (px)
+    float eyeDistance = 1000.0f;
+    // Depth between consecutive layers (px), plugin:stack3d:stack_depth_step
+    float depthStep = 100.0f;
+    int layers = 6;
+    float monitorWidth = 0.0f;
+    float monitorHeight = 0.0f;
+
+    bool operator==(const ProjectionParams&) const = default;
+};
+
+// Per-depth-layer perspective table.
+//
+// Layer L sits at depth z = L * depthStep behind the front window and is
+// scaled by eyeDistance / (eyeDistance + z). Its centre is pulled towards
+// a vanishing point `perspective` px above the stack centre (clamped to
+// stay on the monitor), so back windows shrink and rise above the front
+// one. The table depends only on config and monitor size, so update() is
+// a cheap comparison on every toggle and only rebuilds when they change.
+class PerspectiveProjection {
+  public:
+    // Returns true if the table had to be rebuilt
+    bool update(const ProjectionParams& params);
+
+    int layers() const { return static_cast<int>(m_scale.size()); }
+    const float* scales() const { return m_scale.data(); }
+    const float* lifts() const { return m_lift.data(); }
+
+  private:
+    ProjectionParams m_params;
+    bool m_valid = false;
+
+    // Size multiplier per layer
+    std::vector<float> m_scale;
+    // Vertical offset of the layer centre, negative is up (px)
+    std::vector<float> m_lift;
+};
+
+// Row-of-stacks layout with each layer projected through `projection`
+// instead of the flat depth offsets. Same single pass and output as
+// computeStackLayout(); `projection` must cover params.windowsPerStack
+// layers.
+void computePerspectiveStackLayout(const WindowBatch& windows, const MonitorGeometry& monitor,
+                                   const StackLayoutParams& params, const PerspectiveProjection& projection,
+                                   LayoutBatch& out);
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "LayoutCalculator.hpp"
+
+// Spring-damper tuning, from plugin:stack3d:spring_strength and damping
+struct PhysicsParams {
+    // Scaled into the spring stiffness (1/s^2)
+    float springStrength = 0.8f;
+    // Damping ratio: 1 is critically damped, lower values overshoot
+    float damping = 0.92f;
+};
+
+// Fixed-timestep spring integrator for stack windows.
+//
+// Every window is a body with five spring channels (x, y, width, height,
+// alpha) pulled towards its target. All bodies live in structure-of-arrays
+// buffers and are stepped together with semi-implicit Euler in one
+// vectorizable loop per channel. Bodies that settle below the epsilons
+// snap to their target and go to sleep; once every body sleeps tick() is a
+// no-op, so an idle stack costs nothing.
+class PhysicsMotion {
+  public:
+    static constexpr float TIMESTEP_SECONDS = 1.0f / 240.0f;
+    static constexpr int MAX_STEPS_PER_TICK = 16;
+    static constexpr float STIFFNESS_SCALE = 400.0f;
+    static constexpr float POSITION_EPSILON = 0.5f;
+    static constexpr float ALPHA_EPSILON = 0.002f;
+    static constexpr float VELOCITY_EPSILON = 4.0f;
+    static constexpr float ALPHA_VELOCITY_EPSILON = 0.02f;
+
+    // Starts all bodies at rest at `from`, pulled towards `to`; bodies
+    // that start exactly on their target are asleep from the start
+    void start(const LayoutBatch& from, const LayoutBatch& to, const PhysicsParams& params, double nowMs);
+
+    // Integrates fixed steps up to `nowMs`. Returns true while any body is
+    // awake; current() and moved() describe this frame, and moved() is
+    // empty when the frame was too short for a step.
+    bool tick(double nowMs);
+
+    // Runs exactly one fixed step regardless of wall time (benchmarks)
+    void step();
+
+    void cancel();
+
+    bool active() const { return m_awake > 0; }
+    std::size_t size() const { return m_target.size(); }
+    std::size_t awakeCount() const { return m_awake; }
+
+    const LayoutBatch& current() const { return m_position; }
+    const LayoutBatch& target() const { return m_target; }
+    const std::vector<std::uint32_t>& moved() const { return m_moved; }
+
+  private:
+    void settle();
+
+    LayoutBatch m_position;
+    LayoutBatch m_velocity;
+    LayoutBatch m_target;
+
+    std::vector<std::uint8_t> m_asleep;
+    std::vector<std::uint32_t> m_moved;
+
+    float m_stiffness = 0.0f;
+    float m_friction = 0.0f;
+    double m_lastMs = 0.0;
+    double m_accumulatorSeconds = 0.0;
+    std::size_t m_awake = 0;
+};
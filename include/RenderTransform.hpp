@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <unordered_map>
+
+#include "LayoutCalculator.hpp"
+
+// Box, in layout coordinates, a window is drawn into while its stack is
+// applied as a render transform instead of a resize
+struct RenderBox {
+    float x = 0.0f;
+    float y = 0.0f;
+    float width = 0.0f;
+    float height = 0.0f;
+};
+
+// Uniform scale and top-left position that draw a surface into a box
+struct RenderTransform {
+    float x = 0.0f;
+    float y = 0.0f;
+    float scale = 1.0f;
+};
+
+// Fits a window whose logical box is `real` into `target`, centred and
+// with its aspect ratio kept. An identical box gives the identity.
+RenderTransform fitRenderTransform(const RenderBox& real, const RenderBox& target);
+
+// Render boxes of the windows of transform-mode stacks, keyed by window.
+//
+// The dispatch and motion code write the boxes they would otherwise apply
+// to m_realPosition / m_realSize; the renderWindow hook looks each window
+// up once per frame and draws its existing texture into the box, so the
+// client never sees a configure.
+class RenderTransformTable {
+  public:
+    void set(WindowId id, const RenderBox& box) { m_boxes[id] = box; }
+
+    const RenderBox* find(WindowId id) const {
+        const auto it = m_boxes.find(id);
+        return it != m_boxes.end() ? &it->second : nullptr;
+    }
+
+    bool erase(WindowId id) { return m_boxes.erase(id) != 0; }
+    void clear() { m_boxes.clear(); }
+
+    std::size_t size() const { return m_boxes.size(); }
+    bool empty() const { return m_boxes.empty(); }
+
+  private:
+    std::unordered_map<WindowId, RenderBox> m_boxes;
+};
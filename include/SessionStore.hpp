@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "LayoutCalculator.hpp"
+
+// Saved geometry of one stacked window, as stored in the session file
+struct SessionWindow {
+    // 0 marks a free slot
+    WindowId id = 0;
+    // sessionFingerprint() of the window's initial class, so a new window
+    // at a freed address is not mistaken for the saved one
+    std::uint64_t fingerprint = 0;
+    std::int64_t workspace = 0;
+    float x = 0.0f;
+    float y = 0.0f;
+    float width = 0.0f;
+    float height = 0.0f;
+    float alpha = 1.0f;
+    std::uint32_t floating = 0;
+    // Place in its workspace's slot order while stacked or spread, so a
+    // reload lays the windows out in the same order
+    std::uint32_t slot = 0;
+};
+
+// Stack state of one stacked or spread workspace; its windows' order is
+// kept in their records' `slot`
+struct SessionWorkspace {
+    std::int64_t workspace = 0;
+    // Plugin's StackMode value; 0 (normal) marks a free slot
+    std::int32_t mode = 0;
+    std::int32_t frontLayer = 0;
+    std::int32_t spreadLayout = 0;
+    std::int32_t renderTransform = 0;
+    StackLayoutParams layout;
+};
+
+static_assert(std::is_trivially_copyable_v<SessionWindow> && std::is_trivially_copyable_v<SessionWorkspace>);
+
+// FNV-1a of `text`
+std::uint64_t sessionFingerprint(std::string_view text);
+
+// Stack state kept in a memory-mapped file, so it survives plugin reloads.
+//
+// The file is a header followed by fixed-size records: MAX_WORKSPACES
+// workspace slots, then window slots, grown by remapping. Records are the
+// structs above, so open() is a header check and the restore reads them
+// in place, with nothing to parse. sync() only writes the slots whose
+// contents changed; the mapping is shared, so a write is in the file as
+// soon as it is made. A file of another version, record layout or
+// compositor instance is reset. Host-independent (POSIX only): the plugin
+// builds the records and matches them to its windows.
+class SessionStore {
+  public:
+    static constexpr std::uint32_t VERSION = 2;
+    // Workspaces beyond this many stacked at once are not kept
+    static constexpr std::uint32_t MAX_WORKSPACES = 64;
+    static constexpr std::uint32_t INITIAL_WINDOWS = 256;
+
+    SessionStore() = default;
+    SessionStore(const SessionStore&) = delete;
+    SessionStore& operator=(const SessionStore&) = delete;
+    ~SessionStore() { close(); }
+
+    // Maps `path`, creating it if needed; false if it cannot be mapped or
+    // is a symlink
+    bool open(const std::string& path, std::uint64_t instance);
+    void close();
+    bool isOpen() const { return m_base != nullptr; }
+
+    // Every slot, free ones included (id / mode 0)
+    std::span<const SessionWindow> windows() const;
+    std::span<const SessionWorkspace> workspaces() const;
+
+    // Makes the file hold exactly these records
+    void sync(std::span<const SessionWindow> windows, std::span<const SessionWorkspace> workspaces);
+
+  private:
+    struct Header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t windowSize;
+        std::uint32_t workspaceSize;
+        std::uint32_t windowCapacity;
+        std::uint64_t instance;
+    };
+
+    static std::size_t fileSize(std::uint32_t windowCapacity);
+    Header* header() const { return static_cast<Header*>(m_base); }
+    SessionWindow* windowSlots() const;
+    SessionWorkspace* workspaceSlots() const;
+    bool map(std::size_t size);
+    bool grow();
+
+    int m_fd = -1;
+    void* m_base = nullptr;
+    std::size_t m_size = 0;
+    // Slot of each stored window, and the free slots
+    std::unordered_map<WindowId, std::uint32_t> m_slots;
+    std::vector<std::uint32_t> m_free;
+    // Slots written by the running sync(), by slot
+    std::vector<std::uint8_t> m_touched;
+};
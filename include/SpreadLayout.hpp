@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+#include "LayoutCalculator.hpp"
+
+// Values of plugin:stack3d:default_layout
+enum class SpreadLayout : std::int32_t {
+    GRID = 0,
+    CIRCULAR = 1,
+    SPIRAL = 2,
+    FIBONACCI = 3,
+};
+
+inline constexpr int SPREAD_LAYOUT_COUNT = 4;
+
+// Parameters shared by the spread layouts
+struct SpreadParams {
+    // Gap between windows and around the monitor edge (px)
+    float padding = 20.0f;
+};
+
+// Spread kernel: gives every window of the batch its own cell on the
+// monitor, scales it down (never up) to fit the cell with its aspect ratio
+// kept, and leaves it fully opaque. Cells never overlap.
+using SpreadLayoutFn = void (*)(const WindowBatch& windows, const MonitorGeometry& monitor,
+                                const SpreadParams& params, LayoutBatch& out);
+
+// One specialization per SpreadLayout. Each is a single pass over the
+// batch whose per-window loop has no layout branching; callers pick the
+// kernel once with spreadLayoutKernel() and call through the pointer.
+template <SpreadLayout Layout>
+void computeSpreadLayout(const WindowBatch& windows, const MonitorGeometry& monitor, const SpreadParams& params,
+                         LayoutBatch& out);
+
+SpreadLayoutFn spreadLayoutKernel(SpreadLayout layout);
+
+// Out-of-range config values fall back to GRID
+SpreadLayout spreadLayoutFromConfig(std::int64_t value);
+
+// Accepts "grid", "circular", "spiral", "fibonacci" or their number
+std::optional<SpreadLayout> parseSpreadLayout(std::string_view name);
+
+const char* spreadLayoutName(SpreadLayout layout);
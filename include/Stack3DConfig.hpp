@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+
+#include "AnimationSystem.hpp"
+#include "LayoutCalculator.hpp"
+#include "NotificationManager.hpp"
+#include "PhysicsMotion.hpp"
+#include "SpreadLayout.hpp"
+#include "ThumbnailCache.hpp"
+
+// Values of plugin:stack3d:animation_mode
+enum class AnimationMode : std::int32_t {
+    EASED = 0,
+    PHYSICS = 1,
+};
+
+// Values of plugin:stack3d:projection
+enum class ProjectionMode : std::int32_t {
+    FLAT = 0,
+    PERSPECTIVE = 1,
+};
+
+// plugin:stack3d:* values as Hyprland stores them (INT / FLOAT, seconds).
+// Defaults match the values registered in pluginInit.
+struct RawStack3DConfig {
+    std::int64_t enabled = 1;
+    double transitionDuration = 0.8;
+    double staggerDelay = 0.05;
+    std::int64_t transitionStyle = 0;
+    double stackDepthStep = 100.0;
+    double spreadPadding = 20.0;
+    std::int64_t defaultLayout = 0;
+    double springStrength = 0.8;
+    double damping = 0.92;
+    std::int64_t animationMode = 0;
+    std::int64_t motionBlur = 1;
+    double perspective = 800.0;
+    double eyeDistance = 1000.0;
+    std::int64_t projection = 0;
+    std::int64_t windowsPerStack = 6;
+    double stackSpacing = 400.0;
+    double windowWidth = 800.0;
+    double windowHeight = 600.0;
+    double depthOffsetX = 20.0;
+    double depthOffsetY = 15.0;
+    double transparencyStep = 0.15;
+    double minAlpha = 0.4;
+    std::int64_t adaptive = 0;
+    std::int64_t renderTransform = 0;
+    std::int64_t thumbnailBudgetMb = 64;
+    double thumbnailScale = 0.5;
+    std::int64_t thumbnailRefreshMs = 100;
+    std::int64_t notifyLevel = 2;
+    std::int64_t notifyIntervalMs = 250;
+};
+
+// Typed, validated snapshot of the plugin configuration.
+//
+// Built once at load and again on every configReloaded event; dispatch and
+// frame paths only read this struct, so they never look a value up by
+// name and a reload cannot change values halfway through a dispatch.
+struct Stack3DConfig {
+    bool enabled = true;
+
+    // frontLayer is per monitor and left at 0 here
+    StackLayoutParams layout;
+    // Solve stack count and window size per toggle (fitStackLayout)
+    bool adaptive = false;
+    TransitionParams transition;
+    PhysicsParams physics;
+    AnimationMode animationMode = AnimationMode::EASED;
+
+    ProjectionMode projection = ProjectionMode::FLAT;
+    float perspective = 800.0f;
+    float eyeDistance = 1000.0f;
+    float stackDepthStep = 100.0f;
+
+    SpreadParams spread;
+    SpreadLayout defaultLayout = SpreadLayout::GRID;
+    bool motionBlur = true;
+
+    // Draw stacks as render-time transforms of the existing surfaces
+    // instead of resizing the clients
+    bool renderTransform = false;
+
+    // Snapshots drawn for back-of-stack windows
+    ThumbnailParams thumbnails;
+
+    NotifyParams notify;
+};
+
+// Largest accepted plugin:stack3d:windows_per_stack
+inline constexpr int MAX_WINDOWS_PER_STACK = 64;
+
+// Documented ranges of plugin:stack3d:spring_strength and damping
+inline constexpr double MIN_SPRING_STRENGTH = 0.1;
+inline constexpr double MAX_SPRING_STRENGTH = 2.0;
+inline constexpr double MIN_DAMPING = 0.1;
+inline constexpr double MAX_DAMPING = 1.0;
+
+// Converts raw values to the snapshot, clamping anything out of range so
+// the layout and motion code never sees e.g. an empty stack or a negative
+// duration
+Stack3DConfig buildStack3DConfig(const RawStack3DConfig& raw);
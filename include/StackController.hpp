@@ -0,0 +1,189 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "GeometryStore.hpp"
+#include "LayoutCalculator.hpp"
+#include "PerspectiveProjection.hpp"
+#include "SpreadLayout.hpp"
+#include "Stack3DConfig.hpp"
+
+// What a workspace's windows currently show
+enum class StackMode {
+    NORMAL,
+    STACKED,
+    SPREAD,
+};
+
+// Dispatch state of one workspace: what the toggle, spread, cycle and
+// re-layout decisions read and write. main.cpp and the trace replayer
+// extend it with their own per-workspace state.
+struct StackWorkspace {
+    StackMode mode = StackMode::NORMAL;
+    int frontLayer = 0;
+    // Layout the current stacks were built with; cycling stays on it
+    // across config reloads
+    StackLayoutParams layout;
+    // Kernel of the current spread, reused by live re-layouts
+    SpreadLayout spreadLayout = SpreadLayout::GRID;
+    // Per-layer perspective table, rebuilt only when its inputs change
+    PerspectiveProjection projection;
+};
+
+// What the dispatch code needs to know about one window
+struct WindowState {
+    WindowId id = 0;
+    std::int64_t workspace = 0;
+    float x = 0.0f;
+    float y = 0.0f;
+    float width = 0.0f;
+    float height = 0.0f;
+    float alpha = 1.0f;
+    bool floating = false;
+    // Copied into the window's SavedGeometry when it is saved
+    std::uint64_t fingerprint = 0;
+};
+
+// A window that has saved geometry to go back to
+struct RestoreSlot {
+    // Index into the windows passed to restore()
+    std::uint32_t index = 0;
+    // Floating state before the window was stacked
+    bool floating = false;
+};
+
+// Host-independent core of the toggle / spread / cycle dispatches and of
+// live re-layouts.
+//
+// main.cpp snapshots the workspace into WindowState records, calls one of
+// the methods below and applies the returned batch to the real windows;
+// the benchmarks and the trace replayer drive the same code against the
+// mocks. Saved geometry and
+// all scratch buffers live here and are reused, so steady-state dispatches
+// do not allocate.
+class StackController {
+  public:
+    // Saves each window's pre-stack geometry and lays the windows out as
+    // stacks. `windows` are on one workspace; without `keepSaved` records
+    // of other windows left on it are dropped. With `keepSaved` (a
+    // transition back to normal was cut short) windows that still have a
+    // record there keep it instead of saving the mid-flight geometry.
+    // `projection` selects the perspective kernel.
+    const LayoutBatch& stack(std::span<const WindowState> windows, const MonitorGeometry& monitor,
+                             const StackLayoutParams& params, const PerspectiveProjection* projection,
+                             bool keepSaved);
+
+    // Same bookkeeping as stack(), but gives every window its own cell
+    // using the spread kernel picked by the caller
+    const LayoutBatch& spread(std::span<const WindowState> windows, const MonitorGeometry& monitor,
+                              SpreadLayoutFn kernel, const SpreadParams& params, bool keepSaved);
+
+    // Saved geometry of the windows that have a record, in order. Windows
+    // opened while stacked have none and are skipped, and so are windows
+    // now on another workspace than their record, which is dropped.
+    // restoreSlots() maps each output slot back to its window. The other
+    // records stay until the next stack without `keepSaved`, so a restore
+    // cut short can be re-stacked from them.
+    const LayoutBatch& restore(std::span<const WindowState> windows);
+    const std::vector<RestoreSlot>& restoreSlots() const { return m_restoreSlots; }
+
+    // Slots whose alpha changes when the front layer moves from `oldFront`
+    // to params.frontLayer; alphaFor() gives their new value
+    const std::vector<std::uint32_t>& cycle(std::size_t windowCount, const StackLayoutParams& params,
+                                            int oldFront);
+    static float alphaFor(std::uint32_t slot, const StackLayoutParams& params);
+
+    // Workspace-level dispatches. Each updates `workspace` the way the
+    // dispatch does and returns the batch to move `windows` to.
+
+    // Whether a toggle or a spread with `layout` goes back to normal
+    // instead of laying the windows out
+    static bool toggleRestores(const StackWorkspace& workspace) { return workspace.mode != StackMode::NORMAL; }
+    static bool spreadRestores(const StackWorkspace& workspace, std::optional<SpreadLayout> layout) {
+        return workspace.mode == StackMode::SPREAD && !layout;
+    }
+
+    // Enters stack mode with the front layer at 0. `keepSaved` as for
+    // stack(): set while a transition back to normal is still running.
+    const LayoutBatch& stackWorkspace(StackWorkspace& workspace, std::span<const WindowState> windows,
+                                      const MonitorGeometry& monitor, const Stack3DConfig& config, bool keepSaved);
+
+    // Enters spread mode with `layout`, default_layout when not given.
+    // Coming from stack mode or with `motionActive` (an unfinished
+    // restore) the saved records are still the windows' real geometry.
+    const LayoutBatch& spreadWorkspace(StackWorkspace& workspace, std::span<const WindowState> windows,
+                                       const MonitorGeometry& monitor, const Stack3DConfig& config,
+                                       std::optional<SpreadLayout> layout, bool motionActive);
+
+    // Windows with a record saved on `workspace`, in the order they were
+    // saved. A restore walks these rather than the stackable windows, so a
+    // window an exclude rule or title change took out meanwhile still gets
+    // its geometry back.
+    const std::vector<WindowId>& savedWindows(std::int64_t workspace);
+
+    // Goes back to normal mode; restore() of `windows`
+    const LayoutBatch& restoreWorkspace(StackWorkspace& workspace, std::span<const WindowState> windows);
+
+    // Whether `layer` exists in the workspace's stacks
+    static bool layerInRange(const StackWorkspace& workspace, int layer) {
+        return layer >= 0 && layer < workspace.layout.windowsPerStack;
+    }
+
+    // Moves the front layer by `step`, wrapping, or to `layer` when given
+    // (check it with layerInRange() first). Returns the slots whose alpha
+    // changes, as cycle().
+    const std::vector<std::uint32_t>& cycleWorkspace(StackWorkspace& workspace, std::size_t windowCount, int step,
+                                                     std::optional<int> layer);
+
+    // Compares the windows a re-layout found with the ids laid out before
+    // it. departed() then tells whether one of those is gone and
+    // arrivals() indexes the newcomers in `windows`; callers drop the
+    // saved geometry of both before relayoutWorkspace().
+    void diffMembers(std::span<const WindowId> previous, std::span<const WindowState> windows);
+    bool departed(WindowId id) const;
+    const std::vector<std::uint32_t>& arrivals() const { return m_arrivals; }
+
+    // Lays the windows of a stacked or spread workspace out again after
+    // some opened, closed or moved. Saved geometry is kept; adaptive
+    // stacks are re-fitted to the new count, fixed ones keep the layout
+    // they were built with, and the front layer stays within it.
+    const LayoutBatch& relayoutWorkspace(StackWorkspace& workspace, std::span<const WindowState> windows,
+                                         const MonitorGeometry& monitor, const Stack3DConfig& config);
+
+    // Layout for `windowCount` windows on `monitor`; adaptive configs size
+    // the stacks to fit
+    static StackLayoutParams layoutFor(const Stack3DConfig& config, const MonitorGeometry& monitor,
+                                       std::size_t windowCount);
+    // The workspace's layout with its current front layer
+    static StackLayoutParams frontParams(const StackWorkspace& workspace);
+    // Projection table of `workspace` for `params`, or null for the flat
+    // layout
+    static const PerspectiveProjection* projectionFor(StackWorkspace& workspace, const Stack3DConfig& config,
+                                                      const MonitorGeometry& monitor,
+                                                      const StackLayoutParams& params);
+
+    GeometryStore& savedGeometry() { return m_saved; }
+    const GeometryStore& savedGeometry() const { return m_saved; }
+
+    void clear();
+
+  private:
+    // Fills m_windowBatch with the windows' pre-stack sizes, saving
+    // geometry for windows that have no record yet
+    void saveWindows(std::span<const WindowState> windows, bool keepSaved);
+
+    GeometryStore m_saved;
+
+    WindowBatch m_windowBatch;
+    LayoutBatch m_layoutBatch;
+    LayoutBatch m_restoreBatch;
+    std::vector<RestoreSlot> m_restoreSlots;
+    std::vector<std::uint32_t> m_dirtySlots;
+    std::vector<WindowId> m_previous;
+    std::vector<WindowId> m_current;
+    std::vector<std::uint32_t> m_arrivals;
+    std::vector<WindowId> m_savedWindows;
+};
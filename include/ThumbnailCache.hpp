@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "LayoutCalculator.hpp"
+
+// plugin:stack3d:thumbnail_* values
+struct ThumbnailParams {
+    // Upper bound on snapshot memory (RGBA8); 0 disables snapshots
+    std::size_t budgetBytes = 64u << 20;
+    // Snapshot resolution relative to the window's logical size
+    float scale = 0.5f;
+    // Minimum time between two refreshes of the same snapshot
+    double refreshIntervalMs = 100.0;
+};
+
+// Bookkeeping of downscaled snapshots for back-of-stack windows.
+//
+// Windows behind the front layer of a stack are drawn from a snapshot
+// instead of live. A snapshot is re-captured only after its surface
+// committed, and no more often than refreshIntervalMs; snapshots are kept
+// in LRU order and the least recently drawn ones are evicted once their
+// total size exceeds the budget. An evicted window is drawn live and only
+// re-captured after a draw missed it and refreshIntervalMs has passed, so a
+// back-layer set larger than the budget cycles through the budget at most
+// once per interval instead of every frame.
+//
+// Host-independent: the plugin owns the framebuffers, asks refreshes()
+// which ones to capture each frame, reports captures with stored() and
+// frees what evicted() lists.
+class ThumbnailCache {
+  public:
+    static constexpr std::size_t BYTES_PER_PIXEL = 4;
+    // Captures per refreshes() call, so a commit storm spreads over frames
+    static constexpr std::size_t MAX_REFRESHES_PER_FRAME = 4;
+
+    void configure(const ThumbnailParams& params);
+    const ThumbnailParams& params() const { return m_params; }
+    bool enabled() const { return m_params.budgetBytes > 0; }
+
+    // Marks a window as drawn from its snapshot (back layer) or live.
+    // Becoming a back layer forces a refresh.
+    void setBackLayer(WindowId id, bool back);
+
+    // The window's surface committed new content
+    void markDirty(WindowId id);
+
+    // Back-layer windows whose snapshot is missing or stale and due; at
+    // most MAX_REFRESHES_PER_FRAME, resuming the scan where the previous
+    // call stopped so every window gets its turn
+    const std::vector<WindowId>& refreshes(double nowMs);
+
+    // Snapshot size (pixels) for a window of the given logical size
+    void snapshotSize(float width, float height, std::uint32_t& outWidth, std::uint32_t& outHeight) const;
+
+    // Records a capture of `id`, makes it most recently used and evicts
+    // least recently used snapshots beyond the budget
+    void stored(WindowId id, std::uint32_t width, std::uint32_t height, double nowMs);
+
+    // Snapshots dropped by the last stored() / configure(); the plugin
+    // frees their framebuffers and calls clearEvicted()
+    const std::vector<WindowId>& evicted() const { return m_evicted; }
+    void clearEvicted() { m_evicted.clear(); }
+
+    // True if `id` should be drawn from its snapshot this frame; marks it
+    // most recently used
+    bool draw(WindowId id);
+
+    void erase(WindowId id);
+    void clear();
+
+    std::size_t bytes() const { return m_bytes; }
+    std::size_t snapshots() const { return m_snapshots; }
+    std::uint64_t hits() const { return m_hits; }
+    std::uint64_t misses() const { return m_misses; }
+
+  private:
+    static constexpr std::uint32_t NONE = 0xFFFFFFFFu;
+
+    struct Entry {
+        WindowId id = 0;
+        std::size_t bytes = 0;
+        double refreshedMs = 0.0;
+        bool back = false;
+        bool dirty = true;
+        bool captured = false;
+        // Dropped over budget at evictedMs; missed: drawn since
+        bool evicted = false;
+        bool missed = false;
+        double evictedMs = 0.0;
+        // LRU list of captured entries, most recent at m_head
+        std::uint32_t prev = NONE;
+        std::uint32_t next = NONE;
+    };
+
+    Entry* find(WindowId id);
+    Entry& obtain(WindowId id);
+    void link(std::uint32_t index);
+    void unlink(std::uint32_t index);
+    void drop(std::uint32_t index);
+    void evictOverBudget(double nowMs);
+
+    ThumbnailParams m_params;
+    std::vector<Entry> m_entries;
+    std::vector<std::uint32_t> m_free;
+    std::unordered_map<WindowId, std::uint32_t> m_lookup;
+    std::uint32_t m_head = NONE;
+    std::uint32_t m_tail = NONE;
+    std::size_t m_cursor = 0;
+
+    std::vector<WindowId> m_refreshes;
+    std::vector<WindowId> m_evicted;
+    std::size_t m_bytes = 0;
+    std::size_t m_snapshots = 0;
+    std::uint64_t m_hits = 0;
+    std::uint64_t m_misses = 0;
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <optional>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "LayoutCalculator.hpp"
+
+// plugin:stack3d:exclude_* values
+struct WindowRuleParams {
+    // Regexes matched against the whole class / title; empty matches
+    // nothing
+    std::string classPattern;
+    std::string titlePattern;
+    bool excludeFloating = false;
+    bool excludePinned = false;
+    // Windows smaller than this in either dimension stay out (px)
+    float minWidth = 0.0f;
+    float minHeight = 0.0f;
+};
+
+// What the rules look at for one window
+struct WindowFacts {
+    std::string_view windowClass;
+    std::string_view title;
+    bool floating = false;
+    bool pinned = false;
+    float width = 0.0f;
+    float height = 0.0f;
+};
+
+// Rules deciding which windows get stacked and spread.
+//
+// The patterns are compiled once per configure(). Their verdict is cached
+// per window together with the class and title it was computed for, so a
+// window's regexes only run again after its class or title changed; a
+// dispatch over settled windows compares two strings per window and runs
+// no regex at all. Floating, pinned and size rules are plain comparisons
+// and are checked on every call. Host-independent: the plugin passes the
+// facts in and drops closed windows with forget().
+class WindowFilter {
+  public:
+    // Compiles the patterns and drops every cached verdict. A pattern that
+    // does not compile is ignored and named in error().
+    void configure(const WindowRuleParams& params);
+    const WindowRuleParams& params() const { return m_params; }
+    // Empty when every pattern compiled
+    const std::string& error() const { return m_error; }
+
+    // `id` may be stacked
+    bool accepts(WindowId id, const WindowFacts& facts);
+
+    // Re-evaluates the patterns for a window whose title or class changed;
+    // true if that flipped its verdict. Windows not seen yet are only
+    // cached.
+    bool refresh(WindowId id, std::string_view windowClass, std::string_view title);
+
+    void forget(WindowId id) { m_verdicts.erase(id); }
+    void clear() { m_verdicts.clear(); }
+
+    // Cached verdicts, for tests and stats
+    std::size_t cached() const { return m_verdicts.size(); }
+
+  private:
+    struct Verdict {
+        std::string windowClass;
+        std::string title;
+        // Class or title matched an exclude pattern
+        bool excluded = false;
+    };
+
+    bool hasPatterns() const { return m_classRegex.has_value() || m_titleRegex.has_value(); }
+    bool matchesPatterns(std::string_view windowClass, std::string_view title) const;
+    // Cached verdict of `id`, recomputed if class or title differ
+    bool excludedByPatterns(WindowId id, std::string_view windowClass, std::string_view title);
+
+    WindowRuleParams m_params;
+    std::optional<std::regex> m_classRegex;
+    std::optional<std::regex> m_titleRegex;
+    std::string m_error;
+    std::unordered_map<WindowId, Verdict> m_verdicts;
+};
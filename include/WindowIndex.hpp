@@ -0,0 +1,99 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+// Per-workspace index of mapped windows, maintained incrementally from
+// openWindow / closeWindow / moveWindow events instead of rescanning every
+// compositor window on each dispatch.
+//
+// Templated on the window handle so it stays host-independent: the plugin
+// instantiates it with CWindow*, tests with the mock window type. Windows
+// keep their insertion order within a workspace, which is the stacking
+// order the layout kernels see.
+template <typename Window>
+class WindowIndex {
+  public:
+    using WorkspaceId = std::int64_t;
+
+    // Adds `window` to `workspace`, moving it if it is indexed elsewhere
+    void insert(Window window, WorkspaceId workspace) {
+        const auto location = m_locations.find(window);
+        if (location != m_locations.end()) {
+            if (location->second == workspace) {
+                return;
+            }
+            removeFrom(location->second, window);
+            location->second = workspace;
+        } else {
+            m_locations.emplace(window, workspace);
+        }
+        m_workspaces[workspace].push_back(window);
+    }
+
+    void move(Window window, WorkspaceId workspace) {
+        insert(window, workspace);
+    }
+
+    void erase(Window window) {
+        const auto location = m_locations.find(window);
+        if (location == m_locations.end()) {
+            return;
+        }
+        removeFrom(location->second, window);
+        m_locations.erase(location);
+    }
+
+    // Drops a destroyed workspace and every window still filed under it
+    void eraseWorkspace(WorkspaceId workspace) {
+        const auto bucket = m_workspaces.find(workspace);
+        if (bucket == m_workspaces.end()) {
+            return;
+        }
+        for (const auto& window : bucket->second) {
+            m_locations.erase(window);
+        }
+        m_workspaces.erase(bucket);
+    }
+
+    // Windows on `workspace` in insertion order; O(1), never allocates
+    const std::vector<Window>& windowsOn(WorkspaceId workspace) const {
+        const auto bucket = m_workspaces.find(workspace);
+        return bucket != m_workspaces.end() ? bucket->second : m_empty;
+    }
+
+    bool contains(Window window) const { return m_locations.contains(window); }
+
+    // Workspace `window` is filed under, if it is indexed
+    std::optional<WorkspaceId> workspaceOf(Window window) const {
+        const auto location = m_locations.find(window);
+        return location != m_locations.end() ? std::optional(location->second) : std::nullopt;
+    }
+    std::size_t size() const { return m_locations.size(); }
+
+    void clear() {
+        m_workspaces.clear();
+        m_locations.clear();
+    }
+
+  private:
+    // Order-preserving removal; O(windows on that workspace)
+    void removeFrom(WorkspaceId workspace, Window window) {
+        const auto bucket = m_workspaces.find(workspace);
+        if (bucket == m_workspaces.end()) {
+            return;
+        }
+        auto& windows = bucket->second;
+        const auto it = std::find(windows.begin(), windows.end(), window);
+        if (it != windows.end()) {
+            windows.erase(it);
+        }
+    }
+
+    std::unordered_map<WorkspaceId, std::vector<Window>> m_workspaces;
+    std::unordered_map<Window, WorkspaceId> m_locations;
+    std::vector<Window> m_empty;
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Type-to-filter search over the titles and classes of a fixed set of
+// windows (slots).
+//
+// A window matches when every space-separated term of the query occurs in
+// its title or class, ignoring ASCII case. The texts are lowercased once
+// and indexed by trigram when the search starts. Typing only ever narrows
+// the match set, so each typed character filters the previous level's
+// matches instead of rescanning every window: the trigram ending at the
+// new character must be in a window's posting list before its text is
+// searched at all. Levels are kept per typed character, so erasing one
+// pops back to the previous match set without any matching. Every call
+// reports the slots whose visibility flipped, and the plugin re-lays out
+// those windows only. Host-independent: the plugin adds the texts and
+// maps slots back to windows.
+class WindowSearch {
+  public:
+    // Drops the windows, the index and the query
+    void reset();
+
+    // Indexes one window, before anything is typed; slots are numbered in
+    // call order
+    std::uint32_t add(std::string_view title, std::string_view windowClass);
+    std::size_t size() const { return m_texts.size(); }
+
+    // Appends typed characters (UTF-8), one level per code point
+    void type(std::string_view text);
+    // Removes the last typed character
+    void erase();
+    // Goes to `query` through its common prefix with the current one, so
+    // scripted queries refine like typing does
+    void setQuery(std::string_view query);
+
+    const std::string& query() const { return m_query; }
+    bool matches(std::uint32_t slot) const { return m_visible[slot] != 0; }
+    std::size_t matchCount() const { return m_levels.back().slots.size(); }
+
+    // Slots whose match state changed with the last type / erase /
+    // setQuery call; a slot hidden and shown again by one setQuery is
+    // listed twice, so read matches() for its state
+    const std::vector<std::uint32_t>& changed() const { return m_changed; }
+
+  private:
+    struct Level {
+        // Query length in bytes when the level was pushed
+        std::size_t length = 0;
+        // Matching slots, ascending
+        std::vector<std::uint32_t> slots;
+    };
+
+    static std::uint32_t trigram(const char* text) {
+        return static_cast<std::uint8_t>(text[0]) | static_cast<std::uint8_t>(text[1]) << 8 |
+            static_cast<std::uint32_t>(static_cast<std::uint8_t>(text[2])) << 16;
+    }
+
+    // Appends one code point and narrows the last level's matches
+    void push(std::string_view character);
+    void pop();
+    bool matchesQuery(std::uint32_t slot) const;
+    void markChanged(std::uint32_t slot);
+
+    // Lowercased "title\nclass" per slot
+    std::vector<std::string> m_texts;
+    // Trigram -> ascending slots whose text contains it
+    std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> m_postings;
+    std::string m_query;
+    // m_levels[0] matches everything (empty query)
+    std::vector<Level> m_levels;
+    std::vector<std::uint8_t> m_visible;
+    std::vector<std::uint32_t> m_changed;
+    std::vector<std::uint32_t> m_scratch;
+};
@@ -3,191 +3,2444 @@
 #include <hyprland/src/config/ConfigManager.hpp>
 #include <hyprland/src/plugins/PluginAPI.hpp>
 #include <hyprland/src/SharedDefs.hpp>
+#include <hyprland/src/layout/IHyprLayout.hpp>
+#include <hyprland/src/managers/LayoutManager.hpp>
+#include <hyprland/src/desktop/WLSurface.hpp>
+#include <hyprland/src/devices/IKeyboard.hpp>
+#include <hyprland/src/protocols/core/Compositor.hpp>
+#include <hyprland/src/render/Framebuffer.hpp>
+#include <hyprland/src/render/OpenGL.hpp>
+#include <hyprland/src/render/Renderer.hpp>
+#include <hyprland/src/render/pass/RendererHintsPassElement.hpp>
+#include <hyprland/src/render/pass/TexPassElement.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <optional>
+#include <span>
+#include <unordered_map>
+
+#include <xkbcommon/xkbcommon.h>
+
+#include "AnimationSystem.hpp"
+#include "DispatchTrace.hpp"
+#include "FrameGovernor.hpp"
+#include "LatencyStats.hpp"
+#include "LayoutCalculator.hpp"
+#include "MotionBlur.hpp"
+#include "NotificationManager.hpp"
+#include "OcclusionCuller.hpp"
+#include "PerspectiveProjection.hpp"
+#include "PhysicsMotion.hpp"
+#include "RenderTransform.hpp"
+#include "SessionStore.hpp"
+#include "SpreadLayout.hpp"
+#include "Stack3DConfig.hpp"
+#include "StackController.hpp"
+#include "ThumbnailCache.hpp"
+#include "WindowFilter.hpp"
+#include "WindowIndex.hpp"
+#include "WindowSearch.hpp"
 
 // Global plugin handle
 inline HANDLE PHANDLE = nullptr;
 
-// Constants for 3D stack configuration
-namespace Stack3DConstants {
-    constexpr int WINDOWS_PER_STACK = 6;
-    constexpr float STACK_SPACING = 400.0f;
-    constexpr float STANDARD_WINDOW_WIDTH = 800.0f;
-    constexpr float STANDARD_WINDOW_HEIGHT = 600.0f;
-    constexpr float DEPTH_OFFSET_X = 20.0f;
-    constexpr float DEPTH_OFFSET_Y = 15.0f;
-    constexpr float TRANSPARENCY_STEP = 0.15f;
-    constexpr float MIN_ALPHA = 0.4f;
-    constexpr float FALLBACK_CENTER_X = 960.0f;
-    constexpr float FALLBACK_CENTER_Y = 540.0f;
+// Typed pointers into Hyprland's config store, resolved once in pluginInit
+struct ConfigHandles {
+    Hyprlang::INT* const* enabled = nullptr;
+    Hyprlang::FLOAT* const* transitionDuration = nullptr;
+    Hyprlang::FLOAT* const* staggerDelay = nullptr;
+    Hyprlang::INT* const* transitionStyle = nullptr;
+    Hyprlang::FLOAT* const* stackDepthStep = nullptr;
+    Hyprlang::FLOAT* const* spreadPadding = nullptr;
+    Hyprlang::INT* const* defaultLayout = nullptr;
+    Hyprlang::FLOAT* const* springStrength = nullptr;
+    Hyprlang::FLOAT* const* damping = nullptr;
+    Hyprlang::INT* const* animationMode = nullptr;
+    Hyprlang::INT* const* motionBlur = nullptr;
+    Hyprlang::FLOAT* const* perspective = nullptr;
+    Hyprlang::FLOAT* const* eyeDistance = nullptr;
+    Hyprlang::INT* const* projection = nullptr;
+    Hyprlang::INT* const* windowsPerStack = nullptr;
+    Hyprlang::FLOAT* const* stackSpacing = nullptr;
+    Hyprlang::FLOAT* const* windowWidth = nullptr;
+    Hyprlang::FLOAT* const* windowHeight = nullptr;
+    Hyprlang::FLOAT* const* depthOffsetX = nullptr;
+    Hyprlang::FLOAT* const* depthOffsetY = nullptr;
+    Hyprlang::FLOAT* const* transparencyStep = nullptr;
+    Hyprlang::FLOAT* const* minAlpha = nullptr;
+    Hyprlang::INT* const* adaptive = nullptr;
+    Hyprlang::INT* const* renderTransform = nullptr;
+    Hyprlang::INT* const* thumbnailBudgetMb = nullptr;
+    Hyprlang::FLOAT* const* thumbnailScale = nullptr;
+    Hyprlang::INT* const* thumbnailRefreshMs = nullptr;
+    Hyprlang::INT* const* notifyLevel = nullptr;
+    Hyprlang::INT* const* notifyIntervalMs = nullptr;
+    Hyprlang::STRING const* excludeClass = nullptr;
+    Hyprlang::STRING const* excludeTitle = nullptr;
+    Hyprlang::INT* const* excludeFloating = nullptr;
+    Hyprlang::INT* const* excludePinned = nullptr;
+    Hyprlang::INT* const* minWindowWidth = nullptr;
+    Hyprlang::INT* const* minWindowHeight = nullptr;
+};
+
+static ConfigHandles g_configHandles;
+
+// Snapshot read by every dispatch and frame path; rebuilt on configReloaded
+static Stack3DConfig g_config;
+static SP<HOOK_CALLBACK_FN> g_configReloadedHook;
+
+// Toggle / cycle core; owns the pre-stack geometry, which survives toggles
+static StackController g_controller;
+
+// Mapped windows per workspace, kept current by window events
+static WindowIndex<CWindow*> g_windowIndex;
+static std::vector<CWindow*> g_workspaceWindows;
+static std::vector<SP<HOOK_CALLBACK_FN>> g_windowHooks;
+
+// plugin:stack3d:exclude_* rules, compiled on config load
+static WindowFilter g_windowFilter;
+
+// Scratch buffers reused between dispatches
+static std::vector<WindowState> g_windowStates;
+static LayoutBatch g_currentBatch;
+static LayoutBatch g_cycleTarget;
+static std::vector<std::uint32_t> g_cappedOrder;
+static std::vector<CWindow*> g_restoreWindows;
+
+static SP<HOOK_CALLBACK_FN> g_preRenderHook;
+static SP<HOOK_CALLBACK_FN> g_monitorRemovedHook;
+static std::vector<SP<HOOK_CALLBACK_FN>> g_workspaceHooks;
+static SP<SHyprCtlCommand> g_hyprCtlCommand;
+
+// Dispatch and frame timings, dumped by "stack3d stats"
+static LatencyStats g_latency;
+
+// Effect tier for the measured frame cost, shown by "stack3d governor"
+static FrameGovernor g_governor;
+
+// Dispatch trace, recorded between "stack3d trace start" and "trace stop"
+static TraceWriter g_trace;
+
+// Type-to-filter search over one stacked or spread workspace
+struct SearchSession {
+    bool active = false;
+    // Keys go to the query instead of the focused client
+    bool typing = false;
+    WORKSPACEID workspace = 0;
+    // Windows indexed when the search started, by WindowSearch slot
+    std::vector<PHLWINDOWREF> windows;
+    // Windows the query hides, and those of them taken out of the layout
+    // so far; both sorted
+    std::vector<WindowId> hidden;
+    std::vector<WindowId> parked;
+    // Keys whose press was taken, so their release is taken too
+    std::vector<std::uint32_t> swallowedKeys;
+};
+
+static WindowSearch g_search;
+static SearchSession g_searchSession;
+static SP<HOOK_CALLBACK_FN> g_keyPressHook;
+
+// Stack state mirrored into a mapped file, restored by the next pluginInit
+static SessionStore g_session;
+static std::vector<SessionWindow> g_sessionWindows;
+static std::vector<SessionWorkspace> g_sessionWorkspaces;
+// Slot of each window laid out on a stacked or spread workspace
+static std::unordered_map<WindowId, std::uint32_t> g_sessionSlots;
+
+// The running search hides `id` on `workspace`
+bool searchHides(WORKSPACEID workspace, WindowId id) {
+    return g_searchSession.active && g_searchSession.workspace == workspace &&
+        std::ranges::binary_search(g_searchSession.hidden, id);
+}
+
+// Boxes of windows stacked with render_transform = 1, drawn by the
+// renderWindow hook
+static RenderTransformTable g_renderTransforms;
+static CFunctionHook* g_renderWindowHook = nullptr;
+
+// Client commits only damage a window's logical box; these listeners
+// damage the render box a transformed window is actually drawn in
+static std::unordered_map<WindowId, CHyprSignalListener> g_transformCommits;
+
+void setRenderTransform(CWindow* window, const RenderBox& box) {
+    const WindowId id = reinterpret_cast<WindowId>(window);
+    g_renderTransforms.set(id, box);
+    if (!g_transformCommits.contains(id) && window->m_wlSurface && window->m_wlSurface->resource()) {
+        g_transformCommits[id] = window->m_wlSurface->resource()->m_events.commit.registerListener([id](std::any) {
+            if (const RenderBox* rendered = g_renderTransforms.find(id)) {
+                g_pHyprRenderer->damageBox(CBox{rendered->x, rendered->y, rendered->width, rendered->height});
+            }
+        });
+    }
+}
+
+void eraseRenderTransform(WindowId id) {
+    g_renderTransforms.erase(id);
+    g_transformCommits.erase(id);
+}
+
+// Snapshot of a back-of-stack window and the commit listener that marks
+// it stale
+struct ThumbnailSurface {
+    CFramebuffer framebuffer;
+    CHyprSignalListener commit;
+};
+
+static ThumbnailCache g_thumbnails;
+static std::unordered_map<WindowId, ThumbnailSurface> g_thumbnailSurfaces;
+
+// Frees the framebuffers of snapshots the cache evicted
+void freeEvictedThumbnails() {
+    for (const WindowId id : g_thumbnails.evicted()) {
+        if (const auto it = g_thumbnailSurfaces.find(id); it != g_thumbnailSurfaces.end()) {
+            it->second.framebuffer.release();
+        }
+    }
+    g_thumbnails.clearEvicted();
+}
+
+// Stack state of one workspace. Each workspace toggles, cycles and
+// animates on its own, so several can stay stacked at once and switching
+// between them touches nothing. A workspace is laid out on, and ticked
+// from the preRender of, the monitor currently showing it.
+struct WorkspaceStackState : StackWorkspace {
+    PHLWORKSPACEREF workspace;
+    // Stacks are render transforms (g_renderTransforms), not resizes
+    bool renderTransform = false;
+    // Windows opened, closed or moved since the last frame; folded into
+    // one re-layout in the next preRender
+    bool relayoutPending = false;
+
+    // Visible regions of the settled stack, indexed like animatedWindows,
+    // and the boxes of the front windows they were computed from
+    OcclusionCuller occlusion;
+    std::vector<RenderBox> occluderBoxes;
+    // Compositor z-order of the workspace's windows, bottom to top, before
+    // raiseFrontLayer first changed it
+    std::vector<PHLWINDOWREF> zOrder;
+
+    AnimationSystem animation;
+    PhysicsMotion physics;
+    std::vector<PHLWINDOWREF> animatedWindows;
+
+    // Velocity of the running transition, indexed like animatedWindows,
+    // and the windows currently listed in g_blurSlots. blurActive is set
+    // only for transitions that started the tracker, with motion_blur on
+    // and the governor at full effects; neither changing mid-flight can
+    // feed it slots it was never sized for.
+    MotionBlur blur;
+    bool blurActive = false;
+    std::vector<PHLWINDOWREF> blurredWindows;
+};
+
+static std::unordered_map<WORKSPACEID, WorkspaceStackState> g_workspaceStates;
+
+// Windows of settled stacks that are at least partly covered, mapped to
+// their slot in the owning workspace's culler
+struct OcclusionSlot {
+    const OcclusionCuller* culler = nullptr;
+    std::uint32_t slot = 0;
+
+    Visibility visibility() const { return culler->visibility(slot); }
+    std::span<const VisibleRect> rects() const { return culler->visibleRects(slot); }
+};
+
+static std::unordered_map<WindowId, OcclusionSlot> g_occlusionSlots;
+static LayoutBatch g_occlusionRects;
+static std::vector<std::uint8_t> g_occlusionOpaque;
+static std::vector<int> g_occlusionDepth;
+
+const OcclusionSlot* findOcclusion(WindowId id) {
+    if (g_occlusionSlots.empty()) {
+        return nullptr;
+    }
+    const auto it = g_occlusionSlots.find(id);
+    return it != g_occlusionSlots.end() ? &it->second : nullptr;
+}
+
+// Windows moving fast enough this frame to be drawn with motion blur,
+// mapped to their slot in the owning workspace's tracker
+struct BlurSlot {
+    const MotionBlur* blur = nullptr;
+    std::uint32_t slot = 0;
+
+    BlurStreak streak() const { return blur->streak(slot); }
+};
+
+static std::unordered_map<WindowId, BlurSlot> g_blurSlots;
+
+const BlurSlot* findBlur(WindowId id) {
+    if (g_blurSlots.empty()) {
+        return nullptr;
+    }
+    const auto it = g_blurSlots.find(id);
+    return it != g_blurSlots.end() ? &it->second : nullptr;
+}
+
+// Milliseconds on the monotonic clock, used as the transition timebase
+double monotonicMs() {
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+template <typename T>
+T* const* resolveConfigHandle(const char* name) {
+    return (T* const*)HyprlandAPI::getConfigValue(PHANDLE, name)->getDataStaticPtr();
+}
+
+// Looks every plugin:stack3d:* value up by name, once
+void resolveConfigHandles() {
+    auto& h = g_configHandles;
+    h.enabled = resolveConfigHandle<Hyprlang::INT>("plugin:stack3d:enabled");
+    h.transitionDuration = resolveConfigHandle<Hyprlang::FLOAT>("plugin:stack3d:transition_duration");
+    h.staggerDelay = resolveConfigHandle<Hyprlang::FLOAT>("plugin:stack3d:stagger_delay");
+    h.transitionStyle = resolveConfigHandle<Hyprlang::INT>("plugin:stack3d:transition_style");
+    h.stackDepthStep = resolveConfigHandle<Hyprlang::FLOAT>("plugin:stack3d:stack_depth_step");
+    h.spreadPadding = resolveConfigHandle<Hyprlang::FLOAT>("plugin:stack3d:spread_padding");
+    h.defaultLayout = resolveConfigHandle<Hyprlang::INT>("plugin:stack3d:default_layout");
+    h.springStrength = resolveConfigHandle<Hyprlang::FLOAT>("plugin:stack3d:spring_strength");
+    h.damping = resolveConfigHandle<Hyprlang::FLOAT>("plugin:stack3d:damping");
+    h.animationMode = resolveConfigHandle<Hyprlang::INT>("plugin:stack3d:animation_mode");
+    h.motionBlur = resolveConfigHandle<Hyprlang::INT>("plugin:stack3d:motion_blur");
+    h.perspective = resolveConfigHandle<Hyprlang::FLOAT>("plugin:stack3d:perspective");
+    h.eyeDistance = resolveConfigHandle<Hyprlang::FLOAT>("plugin:stack3d:eye_distance");
+    h.projection = resolveConfigHandle<Hyprlang::INT>("plugin:stack3d:projection");
+    h.windowsPerStack = resolveConfigHandle<Hyprlang::INT>("plugin:stack3d:windows_per_stack");
+    h.stackSpacing = resolveConfigHandle<Hyprlang::FLOAT>("plugin:stack3d:stack_spacing");
+    h.windowWidth = resolveConfigHandle<Hyprlang::FLOAT>("plugin:stack3d:window_width");
+    h.windowHeight = resolveConfigHandle<Hyprlang::FLOAT>("plugin:stack3d:window_height");
+    h.depthOffsetX = resolveConfigHandle<Hyprlang::FLOAT>("plugin:stack3d:depth_offset_x");
+    h.depthOffsetY = resolveConfigHandle<Hyprlang::FLOAT>("plugin:stack3d:depth_offset_y");
+    h.transparencyStep = resolveConfigHandle<Hyprlang::FLOAT>("plugin:stack3d:transparency_step");
+    h.minAlpha = resolveConfigHandle<Hyprlang::FLOAT>("plugin:stack3d:min_alpha");
+    h.adaptive = resolveConfigHandle<Hyprlang::INT>("plugin:stack3d:adaptive");
+    h.renderTransform = resolveConfigHandle<Hyprlang::INT>("plugin:stack3d:render_transform");
+    h.thumbnailBudgetMb = resolveConfigHandle<Hyprlang::INT>("plugin:stack3d:thumbnail_budget_mb");
+    h.thumbnailScale = resolveConfigHandle<Hyprlang::FLOAT>("plugin:stack3d:thumbnail_scale");
+    h.thumbnailRefreshMs = resolveConfigHandle<Hyprlang::INT>("plugin:stack3d:thumbnail_refresh_ms");
+    h.notifyLevel = resolveConfigHandle<Hyprlang::INT>("plugin:stack3d:notify_level");
+    h.notifyIntervalMs = resolveConfigHandle<Hyprlang::INT>("plugin:stack3d:notify_interval_ms");
+    h.excludeClass = (Hyprlang::STRING const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:stack3d:exclude_class")
+                         ->getDataStaticPtr();
+    h.excludeTitle = (Hyprlang::STRING const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:stack3d:exclude_title")
+                         ->getDataStaticPtr();
+    h.excludeFloating = resolveConfigHandle<Hyprlang::INT>("plugin:stack3d:exclude_floating");
+    h.excludePinned = resolveConfigHandle<Hyprlang::INT>("plugin:stack3d:exclude_pinned");
+    h.minWindowWidth = resolveConfigHandle<Hyprlang::INT>("plugin:stack3d:min_window_width");
+    h.minWindowHeight = resolveConfigHandle<Hyprlang::INT>("plugin:stack3d:min_window_height");
+}
+
+// Current values behind the handles
+RawStack3DConfig readRawConfig() {
+    const auto& h = g_configHandles;
+    RawStack3DConfig raw;
+    raw.enabled = **h.enabled;
+    raw.transitionDuration = **h.transitionDuration;
+    raw.staggerDelay = **h.staggerDelay;
+    raw.transitionStyle = **h.transitionStyle;
+    raw.stackDepthStep = **h.stackDepthStep;
+    raw.spreadPadding = **h.spreadPadding;
+    raw.defaultLayout = **h.defaultLayout;
+    raw.springStrength = **h.springStrength;
+    raw.damping = **h.damping;
+    raw.animationMode = **h.animationMode;
+    raw.motionBlur = **h.motionBlur;
+    raw.perspective = **h.perspective;
+    raw.eyeDistance = **h.eyeDistance;
+    raw.projection = **h.projection;
+    raw.windowsPerStack = **h.windowsPerStack;
+    raw.stackSpacing = **h.stackSpacing;
+    raw.windowWidth = **h.windowWidth;
+    raw.windowHeight = **h.windowHeight;
+    raw.depthOffsetX = **h.depthOffsetX;
+    raw.depthOffsetY = **h.depthOffsetY;
+    raw.transparencyStep = **h.transparencyStep;
+    raw.minAlpha = **h.minAlpha;
+    raw.adaptive = **h.adaptive;
+    raw.renderTransform = **h.renderTransform;
+    raw.thumbnailBudgetMb = **h.thumbnailBudgetMb;
+    raw.thumbnailScale = **h.thumbnailScale;
+    raw.thumbnailRefreshMs = **h.thumbnailRefreshMs;
+    raw.notifyLevel = **h.notifyLevel;
+    raw.notifyIntervalMs = **h.notifyIntervalMs;
+    return raw;
+}
+
+// Appends the config in effect from now on to the trace
+void traceConfig(const RawStack3DConfig& raw) {
+    if (g_trace.recording()) {
+        TraceEvent event;
+        event.type = TraceEventType::CONFIG;
+        event.config = raw;
+        g_trace.append(event, monotonicMs());
+    }
+}
+
+// State of `workspace`, created on first use
+WorkspaceStackState& getWorkspaceState(const PHLWORKSPACE& workspace) {
+    auto& state = g_workspaceStates[workspace->m_id];
+    state.workspace = workspace;
+    return state;
+}
+
+WorkspaceStackState* findWorkspaceState(WORKSPACEID workspace) {
+    const auto it = g_workspaceStates.find(workspace);
+    return it != g_workspaceStates.end() ? &it->second : nullptr;
+}
+
+// Monitor the state's workspace is on, shown or not
+PHLMONITOR monitorOf(const WorkspaceStackState& state) {
+    const auto workspace = state.workspace.lock();
+    return workspace ? workspace->m_monitor.lock() : nullptr;
+}
+
+bool isShown(const WorkspaceStackState& state) {
+    const auto monitor = monitorOf(state);
+    return monitor && monitor->m_activeWorkspace && monitor->m_activeWorkspace == state.workspace.lock();
+}
+
+// Writes the saved geometry and the stacked and spread workspaces to the
+// session file; records that did not change are not touched
+void persistSession() {
+    if (!g_session.isOpen()) {
+        return;
+    }
+    g_sessionSlots.clear();
+    for (const auto& [id, state] : g_workspaceStates) {
+        for (std::uint32_t slot = 0; slot < state.animatedWindows.size(); ++slot) {
+            g_sessionSlots.emplace(reinterpret_cast<WindowId>(state.animatedWindows[slot].get()), slot);
+        }
+    }
+    g_sessionWindows.clear();
+    for (const SavedGeometry& saved : g_controller.savedGeometry().records()) {
+        const auto slot = g_sessionSlots.find(saved.id);
+        g_sessionWindows.push_back(SessionWindow{.id = saved.id,
+                                                 .fingerprint = saved.fingerprint,
+                                                 .workspace = saved.workspace,
+                                                 .x = saved.x,
+                                                 .y = saved.y,
+                                                 .width = saved.width,
+                                                 .height = saved.height,
+                                                 .alpha = saved.alpha,
+                                                 .floating = saved.floating ? 1u : 0u,
+                                                 .slot = slot != g_sessionSlots.end() ? slot->second : 0u});
+    }
+    g_sessionWorkspaces.clear();
+    for (const auto& [id, state] : g_workspaceStates) {
+        if (state.mode == StackMode::NORMAL) {
+            continue;
+        }
+        g_sessionWorkspaces.push_back(SessionWorkspace{.workspace = id,
+                                                       .mode = static_cast<std::int32_t>(state.mode),
+                                                       .frontLayer = state.frontLayer,
+                                                       .spreadLayout = static_cast<std::int32_t>(state.spreadLayout),
+                                                       .renderTransform = state.renderTransform ? 1 : 0,
+                                                       .layout = state.layout});
+    }
+    g_session.sync(g_sessionWindows, g_sessionWorkspaces);
+}
+
+// Persists the session once the dispatch or re-layout returns, early
+// returns included
+class SessionSync {
+  public:
+    SessionSync() = default;
+    ~SessionSync() { persistSession(); }
+
+    SessionSync(const SessionSync&) = delete;
+    SessionSync& operator=(const SessionSync&) = delete;
+};
+
+// Hidden, fullscreen and unmapped windows stay out of stacks and spreads,
+// and so do windows the exclude_* rules reject. Windows of a stacked or
+// spread workspace are judged by their saved floating state and size, not
+// by what the stack made them; anywhere else a record left over from an
+// earlier stack is ignored and the live state counts.
+bool isStackable(const CWindow* window) {
+    if (!window->m_isMapped || window->isHidden() || window->isFullscreen()) {
+        return false;
+    }
+    const WindowId id = reinterpret_cast<WindowId>(window);
+    const Vector2D size = window->m_realSize->goal();
+    WindowFacts facts{window->m_class, window->m_title, window->m_isFloating, window->m_pinned,
+                      static_cast<float>(size.x), static_cast<float>(size.y)};
+    const SavedGeometry* saved = g_controller.savedGeometry().find(id);
+    if (saved && window->m_workspace && saved->workspace == window->m_workspace->m_id) {
+        const WorkspaceStackState* state = findWorkspaceState(saved->workspace);
+        if (state && state->mode != StackMode::NORMAL) {
+            facts.floating = saved->floating;
+            facts.width = saved->width;
+            facts.height = saved->height;
+        }
+    }
+    return g_windowFilter.accepts(id, facts);
+}
+
+// Helper function to get filtered windows of a workspace. Reads the
+// incremental index, so the cost is O(windows on that workspace) and the
+// returned scratch vector is reused between dispatches.
+const std::vector<CWindow*>& getWorkspaceWindows(WORKSPACEID workspace) {
+    g_workspaceWindows.clear();
+
+    for (auto* window : g_windowIndex.windowsOn(workspace)) {
+        if (!isStackable(window) || searchHides(workspace, reinterpret_cast<WindowId>(window))) {
+            continue;
+        }
+        g_workspaceWindows.push_back(window);
+    }
+    return g_workspaceWindows;
+}
+
+// Goal state of `window` as a trace records it
+TraceWindow traceWindowState(CWindow* window) {
+    const Vector2D position = window->m_realPosition->goal();
+    const Vector2D size = window->m_realSize->goal();
+    TraceWindow state;
+    state.x = static_cast<float>(position.x);
+    state.y = static_cast<float>(position.y);
+    state.width = static_cast<float>(size.x);
+    state.height = static_cast<float>(size.y);
+    state.alpha = window->m_activeInactiveAlpha ? window->m_activeInactiveAlpha->goal() : 1.0f;
+    state.flags = (window->m_isFloating ? TRACE_WINDOW_FLOATING : 0) | (isStackable(window) ? 0 : TRACE_WINDOW_EXCLUDED);
+    return state;
+}
+
+// Appends a window index event to the trace
+void traceWindowEvent(TraceEventType type, CWindow* window, WORKSPACEID workspace) {
+    if (!g_trace.recording()) {
+        return;
+    }
+    TraceEvent event;
+    event.type = type;
+    event.window = g_trace.windowNumber(reinterpret_cast<WindowId>(window));
+    event.workspace = workspace;
+    g_trace.append(event, monotonicMs());
+}
+
+// Writes the windows of `workspace` whose goal state changed since the
+// trace last saw it; runs before everything that reads that state
+void traceWorkspaceWindows(WORKSPACEID workspace) {
+    if (!g_trace.recording()) {
+        return;
+    }
+    const double now = monotonicMs();
+    for (auto* window : g_windowIndex.windowsOn(workspace)) {
+        g_trace.syncWindow(reinterpret_cast<WindowId>(window), traceWindowState(window), now);
+    }
+}
+
+// Workspaces with a re-layout due in the next frame
+static std::vector<WORKSPACEID> g_pendingRelayouts;
+
+// Marks `workspace` for a re-layout in the next frame if it is stacked or
+// spread; hidden workspaces are re-laid out too, so windows leaving them
+// get their own geometry back right away
+void requestRelayout(WORKSPACEID workspace) {
+    WorkspaceStackState* state = findWorkspaceState(workspace);
+    if (!state || state->mode == StackMode::NORMAL || state->relayoutPending) {
+        return;
+    }
+    state->relayoutPending = true;
+    g_pendingRelayouts.push_back(workspace);
+    if (const auto monitor = monitorOf(*state)) {
+        g_pCompositor->scheduleFrameForMonitor(monitor);
+    }
+}
+
+// Window event handlers keeping g_windowIndex current
+void onWindowOpen(PHLWINDOW window) {
+    if (window && window->m_workspace) {
+        g_windowIndex.insert(window.get(), window->m_workspace->m_id);
+        traceWindowEvent(TraceEventType::WINDOW_OPEN, window.get(), window->m_workspace->m_id);
+        requestRelayout(window->m_workspace->m_id);
+    }
+}
+
+void onWindowClose(PHLWINDOW window) {
+    if (window) {
+        if (const auto workspace = g_windowIndex.workspaceOf(window.get())) {
+            requestRelayout(*workspace);
+            traceWindowEvent(TraceEventType::WINDOW_CLOSE, window.get(), *workspace);
+            g_trace.forgetWindow(reinterpret_cast<WindowId>(window.get()));
+        }
+        g_windowIndex.erase(window.get());
+        // Its record must not outlive it in the session file either, or a
+        // reload could hand it to a new window at the same address
+        if (g_controller.savedGeometry().erase(reinterpret_cast<WindowId>(window.get()))) {
+            persistSession();
+        }
+        eraseRenderTransform(reinterpret_cast<WindowId>(window.get()));
+        g_thumbnails.erase(reinterpret_cast<WindowId>(window.get()));
+        g_thumbnailSurfaces.erase(reinterpret_cast<WindowId>(window.get()));
+        g_occlusionSlots.erase(reinterpret_cast<WindowId>(window.get()));
+        g_blurSlots.erase(reinterpret_cast<WindowId>(window.get()));
+        g_windowFilter.forget(reinterpret_cast<WindowId>(window.get()));
+        std::erase(g_searchSession.hidden, reinterpret_cast<WindowId>(window.get()));
+        std::erase(g_searchSession.parked, reinterpret_cast<WindowId>(window.get()));
+    }
+}
+
+// A title change re-runs the exclude patterns for that window only; its
+// stack is re-laid out if that let it in or threw it out
+void onWindowTitle(PHLWINDOW window) {
+    if (!window) {
+        return;
+    }
+    if (g_windowFilter.refresh(reinterpret_cast<WindowId>(window.get()), window->m_class, window->m_title)) {
+        if (const auto workspace = g_windowIndex.workspaceOf(window.get())) {
+            requestRelayout(*workspace);
+        }
+    }
+}
+
+void onWindowMove(PHLWINDOW window, PHLWORKSPACE workspace) {
+    if (window && workspace) {
+        if (const auto previous = g_windowIndex.workspaceOf(window.get())) {
+            requestRelayout(*previous);
+        }
+        g_windowIndex.move(window.get(), workspace->m_id);
+        traceWindowEvent(TraceEventType::WINDOW_MOVE, window.get(), workspace->m_id);
+        requestRelayout(workspace->m_id);
+    }
+}
+
+// Registers the index hooks and seeds the index from the current windows
+void initializeWindowIndex() {
+    g_windowHooks.push_back(HyprlandAPI::registerCallbackDynamic(PHANDLE, "openWindow",
+        [](void*, SCallbackInfo&, std::any data) {
+            onWindowOpen(std::any_cast<PHLWINDOW>(data));
+        }));
+    g_windowHooks.push_back(HyprlandAPI::registerCallbackDynamic(PHANDLE, "closeWindow",
+        [](void*, SCallbackInfo&, std::any data) {
+            onWindowClose(std::any_cast<PHLWINDOW>(data));
+        }));
+    g_windowHooks.push_back(HyprlandAPI::registerCallbackDynamic(PHANDLE, "moveWindow",
+        [](void*, SCallbackInfo&, std::any data) {
+            const auto args = std::any_cast<std::vector<std::any>>(data);
+            onWindowMove(std::any_cast<PHLWINDOW>(args[0]), std::any_cast<PHLWORKSPACE>(args[1]));
+        }));
+    g_windowHooks.push_back(HyprlandAPI::registerCallbackDynamic(PHANDLE, "windowTitle",
+        [](void*, SCallbackInfo&, std::any data) {
+            onWindowTitle(std::any_cast<PHLWINDOW>(data));
+        }));
+
+    for (auto& window : g_pCompositor->m_windows) {
+        if (window && window->m_isMapped) {
+            onWindowOpen(window);
+        }
+    }
+}
+
+// Logical rectangle of `monitor` in layout coordinates
+MonitorGeometry getMonitorGeometry(const PHLMONITOR& monitor) {
+    const float scale = monitor->m_scale > 0.0f ? monitor->m_scale : 1.0f;
+    MonitorGeometry geometry;
+    geometry.x = monitor->m_position.x;
+    geometry.y = monitor->m_position.y;
+    geometry.width = monitor->m_transformedSize.x / scale;
+    geometry.height = monitor->m_transformedSize.y / scale;
+    geometry.scale = scale;
+    return geometry;
+}
+
+// Toast colours
+namespace NotifyColors {
+    constexpr NotifyColor STATUS{0.0f, 1.0f, 0.0f, 1.0f};
+    constexpr NotifyColor CYCLE{0.0f, 1.0f, 1.0f, 1.0f};
+    constexpr NotifyColor DETAIL{0.0f, 0.5f, 1.0f, 1.0f};
+    constexpr NotifyColor WARNING{1.0f, 0.5f, 0.0f, 1.0f};
+}
+
+// Sink of g_notifications: forwards the toasts it keeps to the overlay
+void showNotification(const std::string& text, const NotifyColor& color, int durationMs) {
+    HyprlandAPI::addNotification(PHANDLE, text, CHyprColor{color.r, color.g, color.b, color.a}, durationMs);
+}
+
+static NotificationManager g_notifications(showNotification);
+static wl_event_source* g_notifyTimer = nullptr;
+
+// Wakes up when the next coalesced toast is due
+void armNotifyTimer() {
+    const double delay = g_notifications.nextFlushDelayMs(monotonicMs());
+    if (g_notifyTimer && delay >= 0.0) {
+        wl_event_source_timer_update(g_notifyTimer, std::max(1, static_cast<int>(std::ceil(delay))));
+    }
+}
+
+int onNotifyTimer(void*) {
+    g_notifications.flush(monotonicMs());
+    armNotifyTimer();
+    return 0;
+}
+
+// Queues a toast. `makeText` only runs if `level` is enabled, so quiet
+// verbosity builds no strings on the dispatch path.
+template <typename MakeText>
+void notify(NotifyLevel level, NotifyTopic topic, const NotifyColor& color, int durationMs, MakeText&& makeText) {
+    if (!g_notifications.enabled(level)) {
+        return;
+    }
+    g_notifications.post(level, topic, color, durationMs, monotonicMs(), std::forward<MakeText>(makeText));
+    armNotifyTimer();
+}
+
+void notify(NotifyLevel level, NotifyTopic topic, const NotifyColor& color, int durationMs, const char* text) {
+    notify(level, topic, color, durationMs, [text] { return text; });
+}
+
+// Current window rules. Traces record each window's verdict instead, so
+// these are not part of RawStack3DConfig.
+WindowRuleParams readWindowRules() {
+    const auto& h = g_configHandles;
+    WindowRuleParams rules;
+    rules.classPattern = *h.excludeClass ? *h.excludeClass : "";
+    rules.titlePattern = *h.excludeTitle ? *h.excludeTitle : "";
+    rules.excludeFloating = **h.excludeFloating != 0;
+    rules.excludePinned = **h.excludePinned != 0;
+    rules.minWidth = static_cast<float>(std::max<Hyprlang::INT>(0, **h.minWindowWidth));
+    rules.minHeight = static_cast<float>(std::max<Hyprlang::INT>(0, **h.minWindowHeight));
+    return rules;
+}
+
+// Rebuilds g_config from the current values behind the handles
+void reloadConfig() {
+    const RawStack3DConfig raw = readRawConfig();
+    traceConfig(raw);
+    g_config = buildStack3DConfig(raw);
+    g_notifications.configure(g_config.notify);
+    g_thumbnails.configure(g_config.thumbnails);
+    freeEvictedThumbnails();
+
+    g_windowFilter.configure(readWindowRules());
+    if (!g_windowFilter.error().empty()) {
+        notify(NotifyLevel::WARNING, NotifyTopic::WARNING, NotifyColors::WARNING, 5000, [&] {
+            return "[Stack3D] Invalid window rule, ignored: " + g_windowFilter.error();
+        });
+    }
+}
+
+bool motionActive(const WorkspaceStackState& state) {
+    return state.animation.active() || state.physics.active();
+}
+
+// What the dispatch core needs to know about each window; geometry is the
+// animation goal, so windows caught mid-animation report where they land
+void captureWindowStates(std::span<CWindow* const> windows, std::vector<WindowState>& out) {
+    out.clear();
+    for (auto* window : windows) {
+        const Vector2D position = window->m_realPosition->goal();
+        const Vector2D size = window->m_realSize->goal();
+        out.push_back(WindowState{
+            .id = reinterpret_cast<WindowId>(window),
+            .workspace = window->m_workspace ? window->m_workspace->m_id : 0,
+            .x = static_cast<float>(position.x),
+            .y = static_cast<float>(position.y),
+            .width = static_cast<float>(size.x),
+            .height = static_cast<float>(size.y),
+            .alpha = window->m_activeInactiveAlpha ? window->m_activeInactiveAlpha->goal() : 1.0f,
+            .floating = window->m_isFloating,
+            .fingerprint = sessionFingerprint(window->m_initialClass),
+        });
+    }
+}
+
+// Snapshot of the geometry windows currently show on screen; in transform
+// mode that is the render box of windows that have one
+void captureWindowGeometry(const WorkspaceStackState& state, std::span<CWindow* const> windows, LayoutBatch& out) {
+    out.resize(windows.size());
+    for (size_t i = 0; i < windows.size(); ++i) {
+        const Vector2D position = windows[i]->m_realPosition->value();
+        const Vector2D size = windows[i]->m_realSize->value();
+        const RenderBox* box =
+            state.renderTransform ? g_renderTransforms.find(reinterpret_cast<WindowId>(windows[i])) : nullptr;
+        out.x[i] = box ? box->x : position.x;
+        out.y[i] = box ? box->y : position.y;
+        out.width[i] = box ? box->width : size.x;
+        out.height[i] = box ? box->height : size.y;
+        out.alpha[i] = windows[i]->m_activeInactiveAlpha ? windows[i]->m_activeInactiveAlpha->value() : 1.0f;
+    }
+}
+
+// Damages what the window shows on screen: its render box if it has one,
+// otherwise the window itself
+void damageRenderedWindow(const PHLWINDOW& window) {
+    // Covered parts of a settled stack never show, so skip their damage
+    if (const OcclusionSlot* occlusion = findOcclusion(reinterpret_cast<WindowId>(window.get()))) {
+        for (const VisibleRect& rect : occlusion->rects()) {
+            g_pHyprRenderer->damageBox(CBox{rect.x, rect.y, rect.width, rect.height});
+        }
+        return;
+    }
+
+    if (const RenderBox* box = g_renderTransforms.find(reinterpret_cast<WindowId>(window.get()))) {
+        g_pHyprRenderer->damageBox(CBox{box->x, box->y, box->width, box->height});
+    } else {
+        g_pHyprRenderer->damageWindow(window);
+    }
+}
+
+// Writes slot `i` of `layout` to the window, damaging old and new area.
+// Transform-mode stacks only move the render box and leave the client's
+// logical geometry alone, so no configure is sent.
+void applyWindowLayout(const WorkspaceStackState& state, const PHLWINDOW& window, const LayoutBatch& layout, size_t i) {
+    if (state.renderTransform) {
+        damageRenderedWindow(window);
+        setRenderTransform(window.get(), RenderBox{layout.x[i], layout.y[i], layout.width[i], layout.height[i]});
+        if (window->m_activeInactiveAlpha) {
+            window->m_activeInactiveAlpha->setValueAndWarp(layout.alpha[i]);
+        }
+        damageRenderedWindow(window);
+        return;
+    }
+
+    g_pHyprRenderer->damageWindow(window);
+
+    window->m_realPosition->setValueAndWarp(Vector2D(layout.x[i], layout.y[i]));
+    window->m_realSize->setValueAndWarp(Vector2D(layout.width[i], layout.height[i]));
+    if (window->m_activeInactiveAlpha) {
+        window->m_activeInactiveAlpha->setValueAndWarp(layout.alpha[i]);
+    }
+
+    g_pHyprRenderer->damageWindow(window);
+}
+
+// Damages the area a blurred window's taps cover: its box stretched back
+// along the streak
+void damageStreak(const PHLWINDOW& window, const BlurStreak& streak) {
+    const RenderBox* box = g_renderTransforms.find(reinterpret_cast<WindowId>(window.get()));
+    const Vector2D position = window->m_realPosition->value();
+    const Vector2D size = window->m_realSize->value();
+    const double x = box ? box->x : position.x;
+    const double y = box ? box->y : position.y;
+    const double width = box ? box->width : size.x;
+    const double height = box ? box->height : size.y;
+    g_pHyprRenderer->damageBox(CBox{x + std::min(0.0f, streak.dx), y + std::min(0.0f, streak.dy),
+                                    width + std::abs(streak.dx), height + std::abs(streak.dy)});
+}
+
+// Drops the workspace's windows from g_blurSlots, damaging their last taps
+void clearMotionBlur(WorkspaceStackState& state) {
+    for (const auto& weak : state.blurredWindows) {
+        const auto window = weak.lock();
+        if (!window) {
+            continue;
+        }
+        const auto it = g_blurSlots.find(reinterpret_cast<WindowId>(window.get()));
+        if (it != g_blurSlots.end()) {
+            damageStreak(window, it->second.streak());
+            g_blurSlots.erase(it);
+        }
+    }
+    state.blurredWindows.clear();
+}
+
+// Velocity of the windows the frame moved; the fast ones are listed in
+// g_blurSlots for hkRenderWindow. Windows at rest are never visited.
+void updateMotionBlur(WorkspaceStackState& state, const LayoutBatch& current, std::span<const std::uint32_t> moved,
+                      double nowMs) {
+    clearMotionBlur(state);
+    if (!state.blurActive || !g_renderWindowHook) {
+        return;
+    }
+    state.blur.update(current, moved, nowMs);
+    for (const auto i : state.blur.blurred()) {
+        const auto window = state.animatedWindows[i].lock();
+        if (!window) {
+            continue;
+        }
+        g_blurSlots[reinterpret_cast<WindowId>(window.get())] = BlurSlot{&state.blur, i};
+        state.blurredWindows.push_back(window);
+        damageStreak(window, state.blur.streak(i));
+    }
+}
+
+// Stops both motion drivers
+void cancelMotion(WorkspaceStackState& state) {
+    state.animation.cancel();
+    state.physics.cancel();
+    clearMotionBlur(state);
+    state.blur.clear();
+    state.blurActive = false;
+}
+
+// Picks how a workspace leaving normal mode draws its stacks. A restore
+// still running keeps its mode so it lands where it started from.
+void selectRenderMode(WorkspaceStackState& state) {
+    if (state.mode == StackMode::NORMAL && !motionActive(state)) {
+        state.renderTransform = g_config.renderTransform && g_renderWindowHook;
+    }
+}
+
+// Once a transform-mode restore has landed, the windows are drawn from
+// their own geometry again
+void releaseRenderTransforms(WorkspaceStackState& state) {
+    if (!state.renderTransform || state.mode != StackMode::NORMAL) {
+        return;
+    }
+    for (const auto& weak : state.animatedWindows) {
+        if (auto window = weak.lock()) {
+            damageRenderedWindow(window);
+            eraseRenderTransform(reinterpret_cast<WindowId>(window.get()));
+            g_pHyprRenderer->damageWindow(window);
+        }
+    }
+    state.renderTransform = false;
+}
+
+// Forgets the visible regions of a workspace's stack; its geometry or
+// opacity is about to change
+void clearOcclusion(WorkspaceStackState& state) {
+    state.occluderBoxes.clear();
+    if (g_occlusionSlots.empty()) {
+        return;
+    }
+    for (const auto& weak : state.animatedWindows) {
+        g_occlusionSlots.erase(reinterpret_cast<WindowId>(weak.get()));
+    }
+}
+
+// Computes what each window of a settled stack shows. Only front layers
+// occlude: they are opaque and raised above the rest of their stack, the
+// translucent layers behind them cover nothing.
+void updateOcclusion(WorkspaceStackState& state) {
+    clearOcclusion(state);
+    if (state.mode != StackMode::STACKED || motionActive(state)) {
+        return;
+    }
+
+    const size_t count = state.animatedWindows.size();
+    const int perStack = std::max(1, state.layout.windowsPerStack);
+    g_occlusionRects.resize(count);
+    g_occlusionOpaque.assign(count, 0);
+    g_occlusionDepth.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        const auto window = state.animatedWindows[i].lock();
+        const int layer = static_cast<int>(i % perStack);
+        const bool front = layer == state.frontLayer;
+        g_occlusionDepth[i] = front ? 0 : 1 + layer;
+        if (!window) {
+            g_occlusionRects.x[i] = g_occlusionRects.y[i] = 0.0f;
+            g_occlusionRects.width[i] = g_occlusionRects.height[i] = 0.0f;
+            if (front) {
+                state.occluderBoxes.push_back(RenderBox{});
+            }
+            continue;
+        }
+
+        // What is drawn: the window's own box, or its fit inside the
+        // render box in transform mode
+        const Vector2D position = window->m_realPosition->value();
+        const Vector2D size = window->m_realSize->value();
+        const RenderBox real{static_cast<float>(position.x), static_cast<float>(position.y),
+                             static_cast<float>(size.x), static_cast<float>(size.y)};
+        const RenderBox* box = g_renderTransforms.find(reinterpret_cast<WindowId>(window.get()));
+        const RenderTransform drawn = fitRenderTransform(real, box ? *box : real);
+        g_occlusionRects.x[i] = drawn.x;
+        g_occlusionRects.y[i] = drawn.y;
+        g_occlusionRects.width[i] = real.width * drawn.scale;
+        g_occlusionRects.height[i] = real.height * drawn.scale;
+
+        const float alpha = window->m_activeInactiveAlpha ? window->m_activeInactiveAlpha->value() : 1.0f;
+        g_occlusionOpaque[i] = front && alpha >= 1.0f && window->opaque();
+        if (front) {
+            state.occluderBoxes.push_back(real);
+        }
+    }
+
+    state.occlusion.compute(g_occlusionRects, g_occlusionOpaque, g_occlusionDepth);
+    for (size_t i = 0; i < count; ++i) {
+        if (state.occlusion.visibility(i) != Visibility::VISIBLE) {
+            g_occlusionSlots[reinterpret_cast<WindowId>(state.animatedWindows[i].get())] =
+                OcclusionSlot{&state.occlusion, static_cast<std::uint32_t>(i)};
+        }
+    }
+
+    notify(NotifyLevel::DEBUG, NotifyTopic::OCCLUSION, NotifyColors::DETAIL, 3000, [&] {
+        const OcclusionStats& stats = state.occlusion.stats();
+        const double culled = stats.totalPixels > 0.0 ? 100.0 * stats.culledPixels / stats.totalPixels : 0.0;
+        return "[Stack3D] Occlusion: " + std::to_string(stats.hidden) + " hidden, " +
+            std::to_string(stats.partial) + " partial, " + std::to_string(static_cast<int>(culled)) +
+            "% of window pixels culled";
+    });
+}
+
+// A front window resized or moved since its stack settled (a floating
+// resize, a client refusing its slot) no longer covers what the visible
+// regions assume
+bool occludersMoved(const WorkspaceStackState& state) {
+    const size_t perStack = static_cast<size_t>(std::max(1, state.layout.windowsPerStack));
+    size_t front = 0;
+    for (size_t i = static_cast<size_t>(state.frontLayer);
+         i < state.animatedWindows.size() && front < state.occluderBoxes.size(); i += perStack, ++front) {
+        const auto window = state.animatedWindows[i].lock();
+        if (!window) {
+            continue;
+        }
+        const Vector2D position = window->m_realPosition->value();
+        const Vector2D size = window->m_realSize->value();
+        const RenderBox& box = state.occluderBoxes[front];
+        if (box.x != static_cast<float>(position.x) || box.y != static_cast<float>(position.y) ||
+            box.width != static_cast<float>(size.x) || box.height != static_cast<float>(size.y)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Jumps a running transition to its target geometry
+void finishTransition(WorkspaceStackState& state) {
+    if (!motionActive(state)) {
+        return;
+    }
+    const LayoutBatch& target = state.physics.active() ? state.physics.target() : state.animation.target();
+    for (size_t i = 0; i < state.animatedWindows.size(); ++i) {
+        if (auto window = state.animatedWindows[i].lock()) {
+            applyWindowLayout(state, window, target, i);
+        }
+    }
+    cancelMotion(state);
+    releaseRenderTransforms(state);
+    updateOcclusion(state);
+}
+
+// Advances a motion driver and applies only the windows it moved
+template <typename Driver>
+bool stepMotion(WorkspaceStackState& state, Driver& driver) {
+    const double now = monotonicMs();
+    const bool running = driver.tick(now);
+    const LayoutBatch& current = driver.current();
+    for (const auto i : driver.moved()) {
+        if (auto window = state.animatedWindows[i].lock()) {
+            applyWindowLayout(state, window, current, i);
+        }
+    }
+    if (running) {
+        updateMotionBlur(state, current, driver.moved(), now);
+    } else {
+        clearMotionBlur(state);
+        releaseRenderTransforms(state);
+        updateOcclusion(state);
+    }
+    return running;
+}
+
+// Moves windows to `target`: spring physics when animation_mode = 1,
+// otherwise eased when transition_duration > 0, otherwise warped. Windows
+// already at their target are not touched. Without `stagger` every window
+// starts at once.
+void transitionWindows(WorkspaceStackState& state, std::span<CWindow* const> windows, const LayoutBatch& target,
+                       bool stagger = true) {
+    const AnimationMode mode = g_config.animationMode;
+    TransitionParams params = g_config.transition;
+    if (!stagger) {
+        params.staggerMs = 0.0f;
+    }
+
+    clearOcclusion(state);
+    state.animatedWindows.clear();
+    for (auto* window : windows) {
+        state.animatedWindows.push_back(window->m_self);
+    }
+
+    cancelMotion(state);
+
+    // Start from what is on screen so retargeting mid-transition is smooth
+    captureWindowGeometry(state, windows, g_currentBatch);
+    const QualityTier tier = g_governor.tier();
+    if ((mode == AnimationMode::EASED && params.durationMs <= 0.0f) || tier == QualityTier::WARP) {
+        for (size_t i = 0; i < windows.size(); ++i) {
+            if (!g_currentBatch.sameSlot(target, i)) {
+                applyWindowLayout(state, windows[i]->m_self.lock(), target, i);
+            }
+        }
+        releaseRenderTransforms(state);
+        updateOcclusion(state);
+        return;
+    }
+
+    // Under load only the first windows that move are animated, in stacks
+    // the front layer first and then by depth; the rest warp and start the
+    // transition at their target
+    if (tier == QualityTier::CAPPED) {
+        g_cappedOrder.clear();
+        for (std::uint32_t i = 0; i < windows.size(); ++i) {
+            if (!g_currentBatch.sameSlot(target, i)) {
+                g_cappedOrder.push_back(i);
+            }
+        }
+        if (state.mode == StackMode::STACKED) {
+            const auto perStack = static_cast<std::uint32_t>(std::max(1, state.layout.windowsPerStack));
+            const auto front = static_cast<std::uint32_t>(state.frontLayer);
+            std::ranges::stable_sort(g_cappedOrder, {}, [&](std::uint32_t i) {
+                const std::uint32_t layer = i % perStack;
+                return layer == front ? 0u : layer + 1;
+            });
+        }
+        for (std::size_t k = FrameGovernor::CAPPED_WINDOWS; k < g_cappedOrder.size(); ++k) {
+            const std::uint32_t i = g_cappedOrder[k];
+            applyWindowLayout(state, windows[i]->m_self.lock(), target, i);
+            g_currentBatch.x[i] = target.x[i];
+            g_currentBatch.y[i] = target.y[i];
+            g_currentBatch.width[i] = target.width[i];
+            g_currentBatch.height[i] = target.height[i];
+            g_currentBatch.alpha[i] = target.alpha[i];
+        }
+    }
+
+    const double now = monotonicMs();
+    if (mode == AnimationMode::PHYSICS) {
+        state.physics.start(g_currentBatch, target, g_config.physics, now);
+    } else {
+        state.animation.start(g_currentBatch, target, params, now);
+    }
+    if (g_config.motionBlur && tier == QualityTier::FULL) {
+        state.blur.start(g_currentBatch, now);
+        state.blurActive = true;
+    }
+    if (const auto monitor = monitorOf(state)) {
+        g_pCompositor->scheduleFrameForMonitor(monitor);
+    }
+}
+
+using RenderWindowFn = void (*)(void*, PHLWINDOW, PHLMONITOR, const Time::steady_tp&, bool, eRenderPassMode, bool,
+                                bool);
+
+// Draws `window` from its snapshot (back layer) or live. Snapshots need
+// the renderWindow hook, both to capture and to draw them.
+void setThumbnailLayer(CWindow* window, bool back) {
+    if (!g_renderWindowHook || !g_thumbnails.enabled()) {
+        return;
+    }
+
+    const WindowId id = reinterpret_cast<WindowId>(window);
+    g_thumbnails.setBackLayer(id, back);
+    if (!back) {
+        return;
+    }
+
+    ThumbnailSurface& surface = g_thumbnailSurfaces[id];
+    if (!surface.commit && window->m_wlSurface && window->m_wlSurface->resource()) {
+        surface.commit = window->m_wlSurface->resource()->m_events.commit.registerListener(
+            [id](std::any) { g_thumbnails.markDirty(id); });
+    }
+}
+
+// Layer flags of a freshly built stack: everything but the front layer
+// is drawn from a snapshot
+void updateThumbnailLayers(std::span<CWindow* const> windows, const StackLayoutParams& params) {
+    const size_t perStack = static_cast<size_t>(std::max(1, params.windowsPerStack));
+    for (size_t i = 0; i < windows.size(); ++i) {
+        setThumbnailLayer(windows[i], static_cast<int>(i % perStack) != params.frontLayer);
+    }
+}
+
+// Puts the front layer of every stack above the windows behind it, so it
+// is drawn on top and occludes them. The first raise of a stack remembers
+// the order it replaces for restoreZOrder().
+void raiseFrontLayer(WorkspaceStackState& state, std::span<CWindow* const> windows, const StackLayoutParams& params) {
+    const auto workspace = state.workspace.lock();
+    if (state.zOrder.empty() && workspace) {
+        for (const auto& window : g_pCompositor->m_windows) {
+            if (window->m_workspace == workspace) {
+                state.zOrder.push_back(window);
+            }
+        }
+    }
+    const size_t perStack = static_cast<size_t>(std::max(1, params.windowsPerStack));
+    for (size_t i = static_cast<size_t>(params.frontLayer); i < windows.size(); i += perStack) {
+        g_pCompositor->changeWindowZOrder(windows[i]->m_self.lock(), true);
+    }
+}
+
+// Puts the workspace's windows back in the z-order they had before they
+// were stacked; windows opened since stay below them
+void restoreZOrder(WorkspaceStackState& state) {
+    const auto workspace = state.workspace.lock();
+    for (const auto& weak : state.zOrder) {
+        if (const auto window = weak.lock(); window && workspace && window->m_workspace == workspace) {
+            g_pCompositor->changeWindowZOrder(window, true);
+        }
+    }
+    state.zOrder.clear();
+}
+
+void releaseThumbnailLayers(std::span<CWindow* const> windows) {
+    for (auto* window : windows) {
+        setThumbnailLayer(window, false);
+    }
+}
+
+// Tells the trace what the plugin left the workspace's windows at, so
+// only later changes made by the compositor are written. Windows still
+// moving are expected at their target; in transform mode only their alpha
+// changes.
+void traceSettledWindows(const WorkspaceStackState& state, WORKSPACEID workspace) {
+    for (auto* window : g_windowIndex.windowsOn(workspace)) {
+        g_trace.expectWindow(reinterpret_cast<WindowId>(window), traceWindowState(window));
+    }
+    if (!motionActive(state)) {
+        return;
+    }
+    const LayoutBatch& target = state.physics.active() ? state.physics.target() : state.animation.target();
+    for (size_t i = 0; i < state.animatedWindows.size(); ++i) {
+        const auto window = state.animatedWindows[i].lock();
+        if (!window) {
+            continue;
+        }
+        TraceWindow expected = traceWindowState(window.get());
+        if (!state.renderTransform) {
+            expected.x = target.x[i];
+            expected.y = target.y[i];
+            expected.width = target.width[i];
+            expected.height = target.height[i];
+        }
+        expected.alpha = target.alpha[i];
+        g_trace.expectWindow(reinterpret_cast<WindowId>(window.get()), expected);
+    }
+}
+
+// Records a dispatch or re-layout of one workspace. The windows' state is
+// synced up front, as the handler reads it; the record itself is appended
+// once the handler returns, so a re-layout it runs first replays first.
+class TracedDispatch {
+  public:
+    TracedDispatch(TraceEventType type, const WorkspaceStackState& state, const PHLMONITOR& monitor,
+                   std::int32_t value = 0) {
+        const auto workspace = state.workspace.lock();
+        if (!g_trace.recording() || !workspace || !monitor) {
+            return;
+        }
+        m_state = &state;
+        m_event.type = type;
+        m_event.workspace = workspace->m_id;
+        m_event.monitor = getMonitorGeometry(monitor);
+        m_event.value = value;
+        m_event.flags = motionActive(state) ? TRACE_MOTION_ACTIVE : 0;
+        traceWorkspaceWindows(workspace->m_id);
+    }
+
+    ~TracedDispatch() {
+        if (!m_state || !g_trace.recording()) {
+            return;
+        }
+        if (m_state->renderTransform) {
+            m_event.flags |= TRACE_RENDER_TRANSFORM;
+        }
+        g_trace.append(m_event, monotonicMs());
+        traceSettledWindows(*m_state, m_event.workspace);
+    }
+
+    TracedDispatch(const TracedDispatch&) = delete;
+    TracedDispatch& operator=(const TracedDispatch&) = delete;
+
+  private:
+    const WorkspaceStackState* m_state = nullptr;
+    TraceEvent m_event;
+};
+
+// Scratch id lists of a re-layout, sorted for lookups
+static std::vector<WindowId> g_relayoutPrevious;
+
+// A window that left a stacked or spread workspace gets its own position,
+// size, opacity and floating state back. The saved position is on the
+// monitor it was stacked on; a window now on another monitor keeps its
+// offset from the monitor's origin.
+void releaseDepartedWindow(const PHLWINDOW& window) {
+    const WindowId id = reinterpret_cast<WindowId>(window.get());
+    damageRenderedWindow(window);
+    g_occlusionSlots.erase(id);
+    g_blurSlots.erase(id);
+    eraseRenderTransform(id);
+    setThumbnailLayer(window.get(), false);
+
+    if (const SavedGeometry* saved = g_controller.savedGeometry().find(id)) {
+        Vector2D position(saved->x, saved->y);
+        const auto stacked = g_pCompositor->getWorkspaceByID(saved->workspace);
+        const auto from = stacked ? stacked->m_monitor.lock() : nullptr;
+        const auto to = window->m_monitor.lock();
+        if (from && to && from != to) {
+            position = position - from->m_position + to->m_position;
+        }
+        window->m_realPosition->setValueAndWarp(position);
+        window->m_realSize->setValueAndWarp(Vector2D(saved->width, saved->height));
+        if (window->m_activeInactiveAlpha) {
+            window->m_activeInactiveAlpha->setValueAndWarp(saved->alpha);
+        }
+        if (window->m_isFloating != saved->floating) {
+            window->m_isFloating = saved->floating;
+            g_pLayoutManager->getCurrentLayout()->changeWindowFloatingMode(window);
+        }
+        g_controller.savedGeometry().erase(id);
+    }
+    g_pHyprRenderer->damageWindow(window);
+    if (g_trace.recording()) {
+        g_trace.expectWindow(id, traceWindowState(window.get()));
+    }
+}
+
+// Where parked windows wait, far outside any monitor layout, so they can
+// be neither clicked nor hovered
+static const Vector2D PARKED_POSITION{-65536.0, -65536.0};
+
+// Takes a window the search hides out of the layout without giving it its
+// own geometry back: it turns invisible, leaves the input region and focus,
+// and keeps its saved record for when it matches again
+void parkWindow(const PHLWINDOW& window) {
+    const WindowId id = reinterpret_cast<WindowId>(window.get());
+    damageRenderedWindow(window);
+    g_occlusionSlots.erase(id);
+    g_blurSlots.erase(id);
+    eraseRenderTransform(id);
+    setThumbnailLayer(window.get(), false);
+    if (window->m_activeInactiveAlpha) {
+        window->m_activeInactiveAlpha->setValueAndWarp(0.0f);
+    }
+    window->m_realPosition->setValueAndWarp(PARKED_POSITION);
+    g_pHyprRenderer->damageWindow(window);
+    if (g_pCompositor->m_lastWindow.lock() == window) {
+        g_pCompositor->focusWindow(nullptr);
+    }
+    g_searchSession.parked.insert(std::ranges::lower_bound(g_searchSession.parked, id), id);
+}
+
+// Brings a parked window matching again back to its saved position; the
+// re-layout then moves it into its slot like any other window
+void unparkWindow(CWindow* window) {
+    if (const SavedGeometry* saved = g_controller.savedGeometry().find(reinterpret_cast<WindowId>(window))) {
+        window->m_realPosition->setValueAndWarp(Vector2D(saved->x, saved->y));
+    }
+}
+
+// Parked windows that left `workspace` get their own geometry back
+void releaseDepartedParked(WORKSPACEID workspace) {
+    std::erase_if(g_searchSession.parked, [&](WindowId id) {
+        for (const auto& weak : g_searchSession.windows) {
+            const auto window = weak.lock();
+            if (window && reinterpret_cast<WindowId>(window.get()) == id) {
+                if (g_windowIndex.workspaceOf(window.get()) == workspace) {
+                    return false;
+                }
+                releaseDepartedWindow(window);
+                return true;
+            }
+        }
+        return true;
+    });
+}
+
+// Folds the window events of the last frame into the workspace's stack or
+// spread. Windows keep their index order: an opened window takes the next
+// slot, a closed one's slot is removed and the slots after it shift up.
+// The layout kernels recompute the batch, and only windows whose target
+// changed are animated, written and damaged. Hidden workspaces are warped
+// straight to the new layout.
+void relayoutWorkspace(WorkspaceStackState& state) {
+    state.relayoutPending = false;
+    const auto workspace = state.workspace.lock();
+    const auto monitor = monitorOf(state);
+    if (!workspace || !monitor || state.mode == StackMode::NORMAL) {
+        return;
+    }
+    ScopedLatency timer(g_latency, LatencyPhase::RELAYOUT);
+    SessionSync sync;
+    TracedDispatch traced(TraceEventType::RELAYOUT, state, monitor);
+
+    const auto& windows = getWorkspaceWindows(workspace->m_id);
+    captureWindowStates(windows, g_windowStates);
+    g_relayoutPrevious.clear();
+    for (const auto& weak : state.animatedWindows) {
+        g_relayoutPrevious.push_back(reinterpret_cast<WindowId>(weak.get()));
+    }
+    g_controller.diffMembers(g_relayoutPrevious, g_windowStates);
+
+    // Closed windows have expired and were cleaned up on close. Windows
+    // the search hides are parked instead of released.
+    for (const auto& weak : state.animatedWindows) {
+        const auto window = weak.lock();
+        if (!window || !g_controller.departed(reinterpret_cast<WindowId>(window.get()))) {
+            continue;
+        }
+        if (g_windowIndex.workspaceOf(window.get()) == workspace->m_id &&
+            searchHides(workspace->m_id, reinterpret_cast<WindowId>(window.get()))) {
+            parkWindow(window);
+        } else {
+            releaseDepartedWindow(window);
+        }
+    }
+    if (!g_searchSession.parked.empty() && g_searchSession.workspace == workspace->m_id) {
+        releaseDepartedParked(workspace->m_id);
+    }
+    // Newcomers save their current geometry, not a record left over from
+    // an earlier stack; parked windows coming back keep theirs
+    for (const std::uint32_t i : g_controller.arrivals()) {
+        const WindowId id = reinterpret_cast<WindowId>(windows[i]);
+        const auto parked = std::ranges::lower_bound(g_searchSession.parked, id);
+        if (parked != g_searchSession.parked.end() && *parked == id) {
+            g_searchSession.parked.erase(parked);
+            unparkWindow(windows[i]);
+        } else {
+            g_controller.savedGeometry().erase(id);
+        }
+    }
+
+    if (windows.empty()) {
+        cancelMotion(state);
+        clearOcclusion(state);
+        state.animatedWindows.clear();
+        // A search hiding every window leaves the mode alone
+        if (!g_searchSession.active || g_searchSession.workspace != workspace->m_id) {
+            state.mode = StackMode::NORMAL;
+            state.renderTransform = false;
+            state.zOrder.clear();
+        }
+        return;
+    }
+
+    const LayoutBatch& target =
+        g_controller.relayoutWorkspace(state, g_windowStates, getMonitorGeometry(monitor), g_config);
+    if (state.mode == StackMode::STACKED) {
+        const StackLayoutParams params = StackController::frontParams(state);
+        updateThumbnailLayers(windows, params);
+        raiseFrontLayer(state, windows, params);
+    }
+    transitionWindows(state, windows, target, false);
+
+    if (!isShown(state)) {
+        finishTransition(state);
+    }
+}
+
+// Runs the re-layouts requested since the last frame
+void runPendingRelayouts() {
+    for (const WORKSPACEID id : g_pendingRelayouts) {
+        WorkspaceStackState* state = findWorkspaceState(id);
+        if (state && state->relayoutPending) {
+            relayoutWorkspace(*state);
+        }
+    }
+    g_pendingRelayouts.clear();
+}
+
+// Drops the state of a destroyed workspace along with its saved geometry.
+// Windows still listed have moved away since the last frame and get their
+// own geometry back.
+void dropWorkspaceState(WORKSPACEID id) {
+    if (g_searchSession.active && g_searchSession.workspace == id) {
+        g_searchSession.hidden.clear();
+        releaseDepartedParked(WORKSPACE_INVALID);
+        g_searchSession = SearchSession{};
+        g_search.reset();
+    }
+    const auto it = g_workspaceStates.find(id);
+    if (it != g_workspaceStates.end()) {
+        WorkspaceStackState& state = it->second;
+        cancelMotion(state);
+        clearOcclusion(state);
+        for (const auto& weak : state.animatedWindows) {
+            if (auto window = weak.lock()) {
+                releaseDepartedWindow(window);
+            }
+        }
+        g_workspaceStates.erase(it);
+    }
+    g_controller.savedGeometry().eraseWorkspace(id);
+    persistSession();
+}
+
+// Re-captures the due snapshots of windows on `monitor`. Runs before the
+// monitor's own frame: each capture renders the window, undecorated, into
+// its downscaled framebuffer.
+void refreshThumbnails(const PHLMONITOR& monitor) {
+    if (!g_renderWindowHook || g_thumbnailSurfaces.empty()) {
+        return;
+    }
+
+    const auto original = reinterpret_cast<RenderWindowFn>(g_renderWindowHook->m_original);
+    const double now = monotonicMs();
+    const float monitorScale = monitor->m_scale;
+    for (const WindowId id : g_thumbnails.refreshes(now)) {
+        auto* window = reinterpret_cast<CWindow*>(id);
+        if (window->m_monitor.lock() != monitor) {
+            continue;
+        }
+        const OcclusionSlot* occlusion = findOcclusion(id);
+        if (occlusion && occlusion->visibility() == Visibility::HIDDEN) {
+            continue;
+        }
+
+        const Vector2D size = window->m_realSize->value() * monitorScale;
+        std::uint32_t width = 0;
+        std::uint32_t height = 0;
+        g_thumbnails.snapshotSize(size.x, size.y, width, height);
+
+        ThumbnailSurface& surface = g_thumbnailSurfaces[id];
+        if (surface.framebuffer.m_size != Vector2D(width, height)) {
+            surface.framebuffer.release();
+            surface.framebuffer.alloc(width, height, monitor->m_output->state->state().drmFormat);
+        }
+
+        SRenderModifData downscale;
+        downscale.modifs.emplace_back(SRenderModifData::RMOD_TYPE_SCALE, static_cast<float>(width / size.x));
+
+        // Not nested in the frame: preRender is emitted before renderMonitor
+        // begins the monitor's pass, so this is a standalone offscreen pass,
+        // the same FULL_FAKE begin/end pair makeWindowSnapshot uses. endRender
+        // flushes and clears the pass before the frame starts its own.
+        CRegion damage{0, 0, static_cast<int>(width), static_cast<int>(height)};
+        g_pHyprRenderer->beginRender(monitor, damage, RENDER_MODE_FULL_FAKE, nullptr, &surface.framebuffer);
+        g_pHyprOpenGL->clear(CHyprColor{0.0, 0.0, 0.0, 0.0});
+        g_pHyprRenderer->m_renderPass.add(
+            makeUnique<CRendererHintsPassElement>(CRendererHintsPassElement::SData{downscale}));
+        original(g_pHyprRenderer.get(), window->m_self.lock(), monitor, Time::steadyNow(), false, RENDER_PASS_MAIN,
+                 true, true);
+        g_pHyprRenderer->m_renderPass.add(
+            makeUnique<CRendererHintsPassElement>(CRendererHintsPassElement::SData{SRenderModifData{}}));
+        g_pHyprRenderer->endRender();
+
+        g_thumbnails.stored(id, width, height, now);
+        damageRenderedWindow(window->m_self.lock());
+    }
+    freeEvictedThumbnails();
+}
+
+// Where `window` is drawn on `monitor`, in monitor-local pixels: its real
+// box, fitted into its render box if it has one
+CBox drawnBox(const PHLWINDOW& window, const PHLMONITOR& monitor) {
+    const Vector2D position = window->m_realPosition->value();
+    const Vector2D size = window->m_realSize->value();
+    const RenderBox real{static_cast<float>(position.x), static_cast<float>(position.y),
+                         static_cast<float>(size.x), static_cast<float>(size.y)};
+    const RenderBox* box = g_renderTransforms.find(reinterpret_cast<WindowId>(window.get()));
+    const RenderTransform transform = fitRenderTransform(real, box ? *box : real);
+
+    const double scale = monitor->m_scale;
+    return CBox{(transform.x - monitor->m_position.x) * scale, (transform.y - monitor->m_position.y) * scale,
+                real.width * transform.scale * scale, real.height * transform.scale * scale};
 }
 
-// State tracking for 3D stack mode
-static bool g_isStackMode = false;
-static int g_currentFrontWindow = 0;
-static std::vector<Vector2D> g_originalPositions;
-static std::vector<Vector2D> g_originalSizes;
+// Trailing copies of a fast window's surface, faded and offset back along
+// its streak, drawn under the window itself. The taps use the surface
+// texture directly: render modifiers carry no alpha, so the window cannot
+// be re-rendered translucent through the original renderWindow.
+void drawMotionBlur(const PHLWINDOW& window, const PHLMONITOR& monitor, const BlurStreak& streak) {
+    const auto surface = window->m_wlSurface ? window->m_wlSurface->resource() : nullptr;
+    if (!surface || !surface->m_current.texture) {
+        return;
+    }
 
-// Helper function to get filtered workspace windows
-std::vector<CWindow*> getWorkspaceWindows() {
-    std::vector<CWindow*> workspaceWindows;
-    for (auto &window : g_pCompositor->m_windows) {
-        if (!window || !window->m_isMapped || window->isHidden() || window->isFullscreen()) {
-            continue;
+    const CBox box = drawnBox(window, monitor);
+    const double scale = monitor->m_scale;
+    const float alpha = window->m_activeInactiveAlpha ? window->m_activeInactiveAlpha->value() : 1.0f;
+    for (int k = MotionBlur::TAPS - 1; k >= 1; --k) {
+        const float fraction = MotionBlur::tapFraction(k);
+        CTexPassElement::SRenderData data;
+        data.tex = surface->m_current.texture;
+        data.box = CBox{box.x + streak.dx * fraction * scale, box.y + streak.dy * fraction * scale, box.w, box.h};
+        data.a = alpha * MotionBlur::tapAlpha(k);
+        g_pHyprRenderer->m_renderPass.add(makeUnique<CTexPassElement>(data));
+    }
+}
+
+// Draws a back-layer window's snapshot where the window shows: its render
+// box in transform mode, otherwise its own box, clipped to the bounds of
+// its visible regions. Popups of back layers are not drawn.
+void drawThumbnail(const PHLWINDOW& window, const PHLMONITOR& monitor, eRenderPassMode mode) {
+    if (mode == RENDER_PASS_POPUP) {
+        return;
+    }
+    const auto it = g_thumbnailSurfaces.find(reinterpret_cast<WindowId>(window.get()));
+    if (it == g_thumbnailSurfaces.end()) {
+        return;
+    }
+
+    const double scale = monitor->m_scale;
+    CTexPassElement::SRenderData data;
+    data.tex = it->second.framebuffer.getTexture();
+    data.box = drawnBox(window, monitor);
+    data.a = window->m_activeInactiveAlpha ? window->m_activeInactiveAlpha->value() : 1.0f;
+    if (const OcclusionSlot* occlusion = findOcclusion(reinterpret_cast<WindowId>(window.get()))) {
+        float left = std::numeric_limits<float>::max();
+        float top = std::numeric_limits<float>::max();
+        float right = std::numeric_limits<float>::lowest();
+        float bottom = std::numeric_limits<float>::lowest();
+        for (const VisibleRect& rect : occlusion->rects()) {
+            left = std::min(left, rect.x);
+            top = std::min(top, rect.y);
+            right = std::max(right, rect.x + rect.width);
+            bottom = std::max(bottom, rect.y + rect.height);
+        }
+        if (right > left && bottom > top) {
+            data.clipBox = CBox{(left - monitor->m_position.x) * scale, (top - monitor->m_position.y) * scale,
+                                (right - left) * scale, (bottom - top) * scale};
+        }
+    }
+    g_pHyprRenderer->m_renderPass.add(makeUnique<CTexPassElement>(data));
+}
+
+// Per-frame transition step of the stack on this monitor's active
+// workspace; only windows that moved are written and damaged. Due
+// thumbnails are re-captured and the last frame's window events re-laid
+// out first. Hidden workspaces are never ticked. False if no transition
+// step ran.
+bool stepFrame(const PHLMONITOR& monitor) {
+    if (monitor) {
+        refreshThumbnails(monitor);
+    }
+    if (!g_pendingRelayouts.empty()) {
+        runPendingRelayouts();
+    }
+
+    WorkspaceStackState* state = monitor && monitor->m_activeWorkspace
+        ? findWorkspaceState(monitor->m_activeWorkspace->m_id)
+        : nullptr;
+    if (!state) {
+        return false;
+    }
+    if (!motionActive(*state)) {
+        if (!state->occluderBoxes.empty() && occludersMoved(*state)) {
+            updateOcclusion(*state);
+        }
+        return false;
+    }
+
+    ScopedLatency timer(g_latency, LatencyPhase::FRAME);
+    const bool running = state->physics.active() ? stepMotion(*state, state->physics)
+                                                 : stepMotion(*state, state->animation);
+    if (running) {
+        g_pCompositor->scheduleFrameForMonitor(monitor);
+    }
+    return true;
+}
+
+// Times the frame's plugin work against the monitor's refresh interval
+// and lets the governor pick the effect tier for the next transitions
+void onPreRender(PHLMONITOR monitor) {
+    const LatencyClock::time_point start = LatencyClock::now();
+    const bool worked = stepFrame(monitor);
+    const double costMs = static_cast<double>(elapsedNs(start, LatencyClock::now())) / 1e6;
+    const double now = monotonicMs();
+    const bool changed = worked && monitor
+        ? g_governor.record(costMs, 1000.0 / std::max(1.0f, monitor->m_refreshRate), now)
+        : g_governor.idle(now);
+    if (changed) {
+        notify(NotifyLevel::DEBUG, NotifyTopic::GOVERNOR, NotifyColors::DETAIL, 2000, [&] {
+            return std::string("[Stack3D] Effect tier: ") + qualityTierName(g_governor.tier());
+        });
+    }
+}
+
+// CHyprRenderer::renderWindow hook. Fully occluded stack windows are
+// skipped. Partly occluded ones are drawn whole when live: the original
+// builds each surface's render data itself and sets its clip box (the
+// monitor box for floating windows), and the pass keeps its elements
+// private, so there is no point to narrow it from here. Their damage is
+// still limited to the visible regions and snapshots are clipped.
+// Fast-moving windows get their motion blur taps first.
+// Back-of-stack windows with a snapshot are drawn from it. Windows with a
+// render box get a scale / translate render modifier around the original
+// call, so their current texture is drawn into the box (monitor-local
+// pixels) and the modifier is reset right after.
+void hkRenderWindow(void* renderer, PHLWINDOW window, PHLMONITOR monitor, const Time::steady_tp& time, bool decorate,
+                    eRenderPassMode mode, bool ignorePosition, bool standalone) {
+    const auto original = reinterpret_cast<RenderWindowFn>(g_renderWindowHook->m_original);
+    if (window && !ignorePosition) {
+        const OcclusionSlot* occlusion = findOcclusion(reinterpret_cast<WindowId>(window.get()));
+        if (occlusion && occlusion->visibility() == Visibility::HIDDEN) {
+            return;
+        }
+    }
+    if (window && monitor && !ignorePosition && mode != RENDER_PASS_POPUP && !g_blurSlots.empty()) {
+        if (const BlurSlot* blur = findBlur(reinterpret_cast<WindowId>(window.get()))) {
+            drawMotionBlur(window, monitor, blur->streak());
         }
-        workspaceWindows.push_back(window.get());
     }
-    return workspaceWindows;
+    if (window && monitor && !ignorePosition && g_thumbnails.snapshots() > 0 &&
+        g_thumbnails.draw(reinterpret_cast<WindowId>(window.get()))) {
+        drawThumbnail(window, monitor, mode);
+        return;
+    }
+
+    const RenderBox* box = window && monitor && !g_renderTransforms.empty()
+        ? g_renderTransforms.find(reinterpret_cast<WindowId>(window.get()))
+        : nullptr;
+    if (!box) {
+        original(renderer, window, monitor, time, decorate, mode, ignorePosition, standalone);
+        return;
+    }
+
+    const Vector2D position = window->m_realPosition->value();
+    const Vector2D size = window->m_realSize->value();
+    const RenderTransform transform = fitRenderTransform(
+        RenderBox{static_cast<float>(position.x), static_cast<float>(position.y), static_cast<float>(size.x),
+                  static_cast<float>(size.y)},
+        *box);
+
+    const Vector2D origin = monitor->m_position;
+    const double scale = monitor->m_scale;
+    SRenderModifData modif;
+    modif.modifs.emplace_back(SRenderModifData::RMOD_TYPE_TRANSLATE, (origin - position) * scale);
+    modif.modifs.emplace_back(SRenderModifData::RMOD_TYPE_SCALE, transform.scale);
+    modif.modifs.emplace_back(SRenderModifData::RMOD_TYPE_TRANSLATE,
+                              (Vector2D(transform.x, transform.y) - origin) * scale);
+
+    g_pHyprRenderer->m_renderPass.add(makeUnique<CRendererHintsPassElement>(CRendererHintsPassElement::SData{modif}));
+    original(renderer, window, monitor, time, decorate, mode, ignorePosition, standalone);
+    g_pHyprRenderer->m_renderPass.add(
+        makeUnique<CRendererHintsPassElement>(CRendererHintsPassElement::SData{SRenderModifData{}}));
 }
 
-// Helper function to calculate screen center
-Vector2D getScreenCenter() {
-    if (g_pCompositor->m_lastMonitor) {
-        return Vector2D(
-            g_pCompositor->m_lastMonitor->m_transformedSize.x / 2.0f,
-            g_pCompositor->m_lastMonitor->m_transformedSize.y / 2.0f
-        );
+// Installs hkRenderWindow; transform-mode stacks are drawn as plain
+// resizes if the symbol cannot be found
+void hookRenderWindow() {
+    for (const auto& match : HyprlandAPI::findFunctionsByName(PHANDLE, "renderWindow")) {
+        if (match.demangled.find("CHyprRenderer::renderWindow") == std::string::npos) {
+            continue;
+        }
+        g_renderWindowHook = HyprlandAPI::createFunctionHook(PHANDLE, match.address, (void*)&hkRenderWindow);
+        if (g_renderWindowHook && g_renderWindowHook->hook()) {
+            return;
+        }
+        g_renderWindowHook = nullptr;
     }
-    return Vector2D(Stack3DConstants::FALLBACK_CENTER_X, Stack3DConstants::FALLBACK_CENTER_Y);
+    notify(NotifyLevel::WARNING, NotifyTopic::WARNING, NotifyColors::WARNING, 5000,
+           "[Stack3D] renderWindow hook unavailable, render_transform is ignored");
 }
 
-// Helper function to calculate transparency based on position
-float calculateAlpha(int positionInStack, int frontWindow) {
-    if (positionInStack == frontWindow) {
-        return 1.0f;
+// Moves every window saved for the workspace back to its saved geometry
+// by identity, so windows opened or closed meanwhile cannot scramble it.
+// The saved records are walked, not the stackable windows, so windows an
+// exclude rule rejects since they were stacked are restored as well.
+void restoreWindows(WorkspaceStackState& state, WORKSPACEID workspace) {
+    // Pending window events first, so windows moved away meanwhile are
+    // released with their own geometry rather than skipped by the restore
+    if (state.relayoutPending) {
+        relayoutWorkspace(state);
+    }
+    // Records are dropped when their window closes, so every id is live
+    g_restoreWindows.clear();
+    for (const WindowId id : g_controller.savedWindows(workspace)) {
+        g_restoreWindows.push_back(reinterpret_cast<CWindow*>(id));
+    }
+    captureWindowStates(g_restoreWindows, g_windowStates);
+    const LayoutBatch& restore = g_controller.restoreWorkspace(state, g_windowStates);
+    releaseThumbnailLayers(g_restoreWindows);
+
+    for (const RestoreSlot& slot : g_controller.restoreSlots()) {
+        auto* window = g_restoreWindows[slot.index];
+
+        // Undo a floating toggle made while stacked
+        if (window->m_isFloating != slot.floating) {
+            window->m_isFloating = slot.floating;
+            g_pLayoutManager->getCurrentLayout()->changeWindowFloatingMode(window->m_self.lock());
+        }
     }
-    return std::max(Stack3DConstants::MIN_ALPHA, 
-                   1.0f - (positionInStack * Stack3DConstants::TRANSPARENCY_STEP));
+    restoreZOrder(state);
+    transitionWindows(state, g_restoreWindows, restore);
+
+    notify(NotifyLevel::INFO, NotifyTopic::TOGGLE, NotifyColors::STATUS, 2000,
+           "Normal Mode: Windows restored to original positions");
 }
 
+// Defined with the search commands below
+void endSearch(bool relayout);
+
 // Function to handle toggle command
 SDispatchResult handleToggleCommand() {
-    auto workspaceWindows = getWorkspaceWindows();
+    ScopedLatency timer(g_latency, LatencyPhase::TOGGLE);
+    LatencyLap lap(g_latency);
+    const auto monitor = g_pCompositor->m_lastMonitor.lock();
+    if (!monitor || !monitor->m_activeWorkspace) {
+        notify(NotifyLevel::WARNING, NotifyTopic::WARNING, NotifyColors::WARNING, 2000, "No focused monitor");
+        return SDispatchResult{.success = true, .error = ""};
+    }
+
+    // Only the focused workspace's stack is touched. Its search ends, and
+    // the windows it hid are restored or stacked with the rest.
+    if (g_searchSession.active && g_searchSession.workspace == monitor->m_activeWorkspace->m_id) {
+        endSearch(false);
+    }
+    WorkspaceStackState& state = getWorkspaceState(monitor->m_activeWorkspace);
+    SessionSync sync;
+    TracedDispatch traced(TraceEventType::TOGGLE, state, monitor);
+    const auto& workspaceWindows = getWorkspaceWindows(monitor->m_activeWorkspace->m_id);
+    lap.mark(LatencyPhase::COLLECT);
     
-    HyprlandAPI::addNotification(PHANDLE, 
-        "Found " + std::to_string(workspaceWindows.size()) + " windows", 
-        CHyprColor{0.0, 0.5, 1.0, 1.0}, 2000);
+    notify(NotifyLevel::DEBUG, NotifyTopic::COMMAND, NotifyColors::DETAIL, 2000, [&] {
+        return "Found " + std::to_string(workspaceWindows.size()) + " windows";
+    });
     
+    // Toggling out of stack or spread mode goes back to normal, even when
+    // every window has been excluded since
+    if (StackController::toggleRestores(state)) {
+        restoreWindows(state, monitor->m_activeWorkspace->m_id);
+        lap.mark(LatencyPhase::APPLY);
+        return SDispatchResult{.success = true, .error = ""};
+    }
+
     if (workspaceWindows.empty()) {
-        HyprlandAPI::addNotification(PHANDLE, "No windows to stack", 
-                                     CHyprColor{1.0, 0.5, 0.0, 1.0}, 2000);
+        notify(NotifyLevel::WARNING, NotifyTopic::WARNING, NotifyColors::WARNING, 2000, "No windows to stack");
         return SDispatchResult{.success = true, .error = ""};
     }
+
+    // ENTERING 3D STACK MODE - Save original geometry and calculate the
+    // whole stack layout in one batched pass. A transition back to normal
+    // still running has not reached the saved geometry yet, so its records
+    // must not be overwritten.
+    const bool wasTransitioning = motionActive(state);
+    selectRenderMode(state);
+    state.relayoutPending = false;
+    captureWindowStates(workspaceWindows, g_windowStates);
+    const LayoutBatch& layout = g_controller.stackWorkspace(state, g_windowStates, getMonitorGeometry(monitor),
+                                                            g_config, wasTransitioning);
+    const StackLayoutParams& params = state.layout;
+    const int numStacks = stackCount(workspaceWindows.size(), params.windowsPerStack);
+    lap.mark(LatencyPhase::LAYOUT);
+    updateThumbnailLayers(workspaceWindows, params);
+    raiseFrontLayer(state, workspaceWindows, params);
+
+    // Apply transformations and transparency, staggered over frames
+    transitionWindows(state, workspaceWindows, layout);
+    lap.mark(LatencyPhase::APPLY);
     
-    Vector2D screenCenter = getScreenCenter();
-    g_isStackMode = !g_isStackMode;
+    notify(NotifyLevel::INFO, NotifyTopic::TOGGLE, NotifyColors::STATUS, 3000, [&] {
+        return "3D Stack Mode: " + std::to_string(workspaceWindows.size()) + " windows in " +
+            std::to_string(numStacks) + " stacks";
+    });
+    lap.mark(LatencyPhase::NOTIFY);
     
-    if (g_isStackMode) {
-        // ENTERING 3D STACK MODE
-        g_originalPositions.clear();
-        g_originalSizes.clear();
-        
-        // Store original positions and sizes
-        for (auto* window : workspaceWindows) {
-            g_originalPositions.push_back(window->m_realPosition->goal());
-            g_originalSizes.push_back(window->m_realSize->goal());
+    return SDispatchResult{.success = true, .error = ""};
+}
+
+// Function to handle spread command. Lays the focused workspace's windows
+// out side by side with `layout` (default_layout when not given); a bare
+// "spread" while already spread goes back to normal.
+SDispatchResult handleSpreadCommand(std::optional<SpreadLayout> layout) {
+    ScopedLatency timer(g_latency, LatencyPhase::SPREAD);
+    LatencyLap lap(g_latency);
+    const auto monitor = g_pCompositor->m_lastMonitor.lock();
+    if (!monitor || !monitor->m_activeWorkspace) {
+        notify(NotifyLevel::WARNING, NotifyTopic::WARNING, NotifyColors::WARNING, 2000, "No focused monitor");
+        return SDispatchResult{.success = true, .error = ""};
+    }
+
+    if (g_searchSession.active && g_searchSession.workspace == monitor->m_activeWorkspace->m_id) {
+        endSearch(false);
+    }
+    WorkspaceStackState& state = getWorkspaceState(monitor->m_activeWorkspace);
+    SessionSync sync;
+    TracedDispatch traced(TraceEventType::SPREAD, state, monitor,
+                          layout ? static_cast<std::int32_t>(*layout) : TRACE_DEFAULT_LAYOUT);
+    const auto& workspaceWindows = getWorkspaceWindows(monitor->m_activeWorkspace->m_id);
+    lap.mark(LatencyPhase::COLLECT);
+
+    if (StackController::spreadRestores(state, layout)) {
+        restoreWindows(state, monitor->m_activeWorkspace->m_id);
+        lap.mark(LatencyPhase::APPLY);
+        return SDispatchResult{.success = true, .error = ""};
+    }
+
+    if (workspaceWindows.empty()) {
+        notify(NotifyLevel::WARNING, NotifyTopic::WARNING, NotifyColors::WARNING, 2000, "No windows to spread");
+        return SDispatchResult{.success = true, .error = ""};
+    }
+
+    const bool wasTransitioning = motionActive(state);
+    selectRenderMode(state);
+    state.relayoutPending = false;
+    captureWindowStates(workspaceWindows, g_windowStates);
+    const LayoutBatch& target = g_controller.spreadWorkspace(state, g_windowStates, getMonitorGeometry(monitor),
+                                                             g_config, layout, wasTransitioning);
+    lap.mark(LatencyPhase::LAYOUT);
+    releaseThumbnailLayers(workspaceWindows);
+    transitionWindows(state, workspaceWindows, target);
+    lap.mark(LatencyPhase::APPLY);
+
+    notify(NotifyLevel::INFO, NotifyTopic::TOGGLE, NotifyColors::STATUS, 2000, [&] {
+        return std::string("Spread Mode: ") + spreadLayoutName(state.spreadLayout) + " layout";
+    });
+    lap.mark(LatencyPhase::NOTIFY);
+
+    return SDispatchResult{.success = true, .error = ""};
+}
+
+// Function to handle cycle command. Moves the front layer of the focused
+// workspace's stacks by `step`, or straight to `layer` when given, and only
+// rewrites and damages the windows whose alpha changes.
+SDispatchResult handleCycleCommand(int step, std::optional<int> layer = std::nullopt) {
+    ScopedLatency timer(g_latency, LatencyPhase::CYCLE);
+    LatencyLap lap(g_latency);
+    const auto monitor = g_pCompositor->m_lastMonitor.lock();
+    if (!monitor || !monitor->m_activeWorkspace) {
+        notify(NotifyLevel::WARNING, NotifyTopic::WARNING, NotifyColors::WARNING, 2000, "No focused monitor");
+        return SDispatchResult{.success = true, .error = ""};
+    }
+
+    // Only the focused workspace's stack is touched
+    WorkspaceStackState& state = getWorkspaceState(monitor->m_activeWorkspace);
+    SessionSync sync;
+    TracedDispatch traced(layer ? TraceEventType::LAYER : TraceEventType::CYCLE, state, monitor, layer.value_or(step));
+    const auto& workspaceWindows = getWorkspaceWindows(monitor->m_activeWorkspace->m_id);
+    lap.mark(LatencyPhase::COLLECT);
+    
+    if (workspaceWindows.empty()) {
+        notify(NotifyLevel::WARNING, NotifyTopic::WARNING, NotifyColors::WARNING, 2000, "No windows to cycle");
+        return SDispatchResult{.success = true, .error = ""};
+    }
+
+    // Pending window events first, so the slots match the window list and
+    // the layer check sees the current layout
+    if (state.relayoutPending) {
+        relayoutWorkspace(state);
+    }
+    
+    if (state.mode != StackMode::STACKED) {
+        notify(NotifyLevel::WARNING, NotifyTopic::WARNING, NotifyColors::WARNING, 2000, "Must be in 3D stack mode to cycle windows");
+        return SDispatchResult{.success = true, .error = ""};
+    }
+
+    if (layer && !StackController::layerInRange(state, *layer)) {
+        notify(NotifyLevel::WARNING, NotifyTopic::WARNING, NotifyColors::WARNING, 2000, [&] {
+            return "Layer must be between 0 and " + std::to_string(state.layout.windowsPerStack - 1);
+        });
+        return SDispatchResult{.success = true, .error = ""};
+    }
+
+    // Settle any running transition so it cannot overwrite the new alphas.
+    // The visible regions go with the old front layer.
+    finishTransition(state);
+    clearOcclusion(state);
+
+    // Only the old and new front layer of each stack change transparency
+    const auto& cycled = g_controller.cycleWorkspace(state, workspaceWindows.size(), step, layer);
+    const StackLayoutParams params = StackController::frontParams(state);
+    const int perStack = std::max(1, params.windowsPerStack);
+    if (g_config.animationMode == AnimationMode::PHYSICS) {
+        // The springs carry the opacity change like any other transition
+        captureWindowGeometry(state, workspaceWindows, g_cycleTarget);
+        for (const auto i : cycled) {
+            setThumbnailLayer(workspaceWindows[i], static_cast<int>(i) % perStack != params.frontLayer);
+            g_cycleTarget.alpha[i] = StackController::alphaFor(i, params);
         }
-        
-        // Calculate stack layout
-        const int numStacks = (workspaceWindows.size() + Stack3DConstants::WINDOWS_PER_STACK - 1) / 
-                             Stack3DConstants::WINDOWS_PER_STACK;
-        
-        for (size_t i = 0; i < workspaceWindows.size(); ++i) {
-            auto* window = workspaceWindows[i];
-            const int stackIndex = i / Stack3DConstants::WINDOWS_PER_STACK;
-            const int positionInStack = i % Stack3DConstants::WINDOWS_PER_STACK;
-            
-            // Calculate stack center position
-            Vector2D stackCenter = Vector2D(
-                screenCenter.x + (stackIndex - (numStacks - 1) / 2.0f) * Stack3DConstants::STACK_SPACING,
-                screenCenter.y
-            );
-            
-            // Calculate window position with 3D depth effect
-            Vector2D windowSize = Vector2D(Stack3DConstants::STANDARD_WINDOW_WIDTH, 
-                                          Stack3DConstants::STANDARD_WINDOW_HEIGHT);
-            Vector2D stackPos = Vector2D(
-                stackCenter.x - windowSize.x / 2.0f - (positionInStack * Stack3DConstants::DEPTH_OFFSET_X),
-                stackCenter.y - windowSize.y / 2.0f - (positionInStack * Stack3DConstants::DEPTH_OFFSET_Y)
-            );
-            
-            // Apply transformations
-            window->m_realPosition->setValueAndWarp(stackPos);
-            window->m_realSize->setValueAndWarp(windowSize);
-            
-            // Apply transparency effect
-            float alpha = calculateAlpha(positionInStack, 0);
-            if (window->m_activeInactiveAlpha) {
-                window->m_activeInactiveAlpha->setValueAndWarp(alpha);
-            }
+        raiseFrontLayer(state, workspaceWindows, params);
+        transitionWindows(state, workspaceWindows, g_cycleTarget, false);
+        if (!motionActive(state)) {
+            updateOcclusion(state);
         }
-        
-        HyprlandAPI::addNotification(PHANDLE, 
-            "3D Stack Mode: " + std::to_string(workspaceWindows.size()) + " windows in " + 
-            std::to_string(numStacks) + " stacks", 
-            CHyprColor{0.0, 1.0, 0.0, 1.0}, 3000);
-            
     } else {
-        // EXITING 3D STACK MODE - Restore original positions
-        for (size_t i = 0; i < workspaceWindows.size() && i < g_originalPositions.size(); ++i) {
+        for (const auto i : cycled) {
             auto* window = workspaceWindows[i];
-            
-            // Restore original position and size
-            window->m_realPosition->setValueAndWarp(g_originalPositions[i]);
-            if (i < g_originalSizes.size()) {
-                window->m_realSize->setValueAndWarp(g_originalSizes[i]);
-            }
-            
-            // Restore full opacity
-            if (window->m_activeInactiveAlpha) {
-                window->m_activeInactiveAlpha->setValueAndWarp(1.0f);
+            setThumbnailLayer(window, static_cast<int>(i) % perStack != params.frontLayer);
+            if (!window->m_activeInactiveAlpha) {
+                continue;
             }
+            window->m_activeInactiveAlpha->setValueAndWarp(StackController::alphaFor(i, params));
+            damageRenderedWindow(window->m_self.lock());
         }
-        
-        HyprlandAPI::addNotification(PHANDLE, 
-            "Normal Mode: Windows restored to original positions", 
-            CHyprColor{0.0, 1.0, 0.0, 1.0}, 2000);
+        raiseFrontLayer(state, workspaceWindows, params);
+        updateOcclusion(state);
     }
+    lap.mark(LatencyPhase::APPLY);
+    
+    // Key-repeat cycling coalesces into one toast showing the final layer
+    notify(NotifyLevel::INFO, NotifyTopic::CYCLE, NotifyColors::CYCLE, 1500, [&] {
+        return "Cycled to window layer " + std::to_string(state.frontLayer);
+    });
+    lap.mark(LatencyPhase::NOTIFY);
     
     return SDispatchResult{.success = true, .error = ""};
 }
 
-// Function to handle cycle command
-SDispatchResult handleCycleCommand() {
-    auto workspaceWindows = getWorkspaceWindows();
-    
-    if (workspaceWindows.empty()) {
-        HyprlandAPI::addNotification(PHANDLE, "No windows to cycle", 
-                                     CHyprColor{1.0, 0.5, 0.0, 1.0}, 2000);
+// "stats" reports the dispatch and frame timings, "stats reset" clears
+// them. Shared by the dispatcher and hyprctl; nullopt for an unknown
+// argument.
+std::optional<std::string> runStatsCommand(const std::string& argument) {
+    if (argument == "reset") {
+        g_latency.reset();
+        return "Stats reset";
+    }
+    if (!argument.empty()) {
+        return std::nullopt;
+    }
+    return "Latency\n" + g_latency.report();
+}
+
+// Function to handle stats command; the text goes to a toast, the full
+// report is also available as "hyprctl stack3d stats"
+SDispatchResult handleStatsCommand(const std::string& argument) {
+    const auto text = runStatsCommand(argument);
+    if (!text) {
+        notify(NotifyLevel::WARNING, NotifyTopic::WARNING, NotifyColors::WARNING, 2000, [&] {
+            return "Unknown stats argument: " + argument;
+        });
         return SDispatchResult{.success = true, .error = ""};
     }
-    
-    if (!g_isStackMode) {
-        HyprlandAPI::addNotification(PHANDLE, "Must be in 3D stack mode to cycle windows", 
-                                     CHyprColor{1.0, 0.5, 0.0, 1.0}, 2000);
+    notify(NotifyLevel::INFO, NotifyTopic::STATS, NotifyColors::DETAIL, argument.empty() ? 8000 : 2000,
+           [&] { return "[Stack3D] " + *text; });
+    return SDispatchResult{.success = true, .error = ""};
+}
+
+// "governor" reports the effect tier and the frame cost it was picked
+// for, "governor reset" goes back to full effects. Shared by the
+// dispatcher and hyprctl; nullopt for an unknown argument.
+std::optional<std::string> runGovernorCommand(const std::string& argument) {
+    if (argument == "reset") {
+        g_governor.reset();
+        return "Effect tier reset";
+    }
+    if (!argument.empty()) {
+        return std::nullopt;
+    }
+    return "Governor\n" + g_governor.report();
+}
+
+// Function to handle governor command; the text goes to a toast, the
+// report is also available as "hyprctl stack3d governor"
+SDispatchResult handleGovernorCommand(const std::string& argument) {
+    const auto text = runGovernorCommand(argument);
+    if (!text) {
+        notify(NotifyLevel::WARNING, NotifyTopic::WARNING, NotifyColors::WARNING, 2000, [&] {
+            return "Unknown governor argument: " + argument;
+        });
         return SDispatchResult{.success = true, .error = ""};
     }
-    
-    // Advance to next front window
-    g_currentFrontWindow = (g_currentFrontWindow + 1) % Stack3DConstants::WINDOWS_PER_STACK;
-    
-    // Update window transparencies
-    for (size_t i = 0; i < workspaceWindows.size(); ++i) {
-        auto* window = workspaceWindows[i];
-        const int positionInStack = i % Stack3DConstants::WINDOWS_PER_STACK;
-        
-        float alpha = calculateAlpha(positionInStack, g_currentFrontWindow);
-        if (window->m_activeInactiveAlpha) {
-            window->m_activeInactiveAlpha->setValueAndWarp(alpha);
+    notify(NotifyLevel::INFO, NotifyTopic::GOVERNOR, NotifyColors::DETAIL, argument.empty() ? 5000 : 2000,
+           [&] { return "[Stack3D] " + *text; });
+    return SDispatchResult{.success = true, .error = ""};
+}
+
+// Brings every window the search hid back into the layout, or with
+// `relayout` false gives the parked ones their own geometry back and
+// leaves the layout to the dispatch that ends the search
+void endSearch(bool relayout) {
+    SearchSession& session = g_searchSession;
+    if (!session.active) {
+        return;
+    }
+    session.active = false;
+    session.typing = false;
+    session.hidden.clear();
+    WorkspaceStackState* state = findWorkspaceState(session.workspace);
+    if (relayout && state && state->mode != StackMode::NORMAL) {
+        relayoutWorkspace(*state);
+    }
+    releaseDepartedParked(WORKSPACE_INVALID);
+    session.windows.clear();
+    g_search.reset();
+}
+
+// Folds the slots the last keystroke flipped into the hidden list and
+// re-lays out the workspace if any of them changed
+void applySearch() {
+    SearchSession& session = g_searchSession;
+    bool changed = false;
+    for (const auto slot : g_search.changed()) {
+        const auto window = session.windows[slot].lock();
+        if (!window) {
+            continue;
+        }
+        const WindowId id = reinterpret_cast<WindowId>(window.get());
+        const auto it = std::ranges::lower_bound(session.hidden, id);
+        const bool hidden = it != session.hidden.end() && *it == id;
+        if (g_search.matches(slot) != hidden) {
+            continue;
+        }
+        if (hidden) {
+            session.hidden.erase(it);
+        } else {
+            session.hidden.insert(it, id);
         }
+        changed = true;
+    }
+    if (WorkspaceStackState* state = findWorkspaceState(session.workspace); changed && state) {
+        relayoutWorkspace(*state);
+    }
+
+    notify(NotifyLevel::INFO, NotifyTopic::SEARCH, NotifyColors::STATUS, 2000, [&] {
+        return "Search: " + g_search.query() + " (" + std::to_string(g_search.matchCount()) + " of " +
+            std::to_string(g_search.size()) + ")";
+    });
+}
+
+// Indexes the focused workspace's stacked or spread windows for a search,
+// ending one running elsewhere; false with a toast if it cannot start
+bool beginSearch() {
+    const auto monitor = g_pCompositor->m_lastMonitor.lock();
+    if (!monitor || !monitor->m_activeWorkspace) {
+        notify(NotifyLevel::WARNING, NotifyTopic::WARNING, NotifyColors::WARNING, 2000, "No focused monitor");
+        return false;
+    }
+    const WORKSPACEID workspace = monitor->m_activeWorkspace->m_id;
+    WorkspaceStackState* state = findWorkspaceState(workspace);
+    if (!state || state->mode == StackMode::NORMAL) {
+        notify(NotifyLevel::WARNING, NotifyTopic::WARNING, NotifyColors::WARNING, 2000,
+               "Must be in 3D stack or spread mode to search");
+        return false;
+    }
+    // Hidden windows are parked, which a replay could not reproduce
+    if (g_trace.recording()) {
+        notify(NotifyLevel::WARNING, NotifyTopic::WARNING, NotifyColors::WARNING, 2000,
+               "Stop the dispatch trace before searching");
+        return false;
+    }
+    if (g_searchSession.active && g_searchSession.workspace == workspace) {
+        return true;
+    }
+    endSearch(true);
+
+    if (state->relayoutPending) {
+        relayoutWorkspace(*state);
+    }
+    g_search.reset();
+    for (auto* window : getWorkspaceWindows(workspace)) {
+        g_search.add(window->m_title, window->m_class);
+        g_searchSession.windows.push_back(window->m_self);
+    }
+    g_searchSession.active = true;
+    g_searchSession.workspace = workspace;
+    return true;
+}
+
+// Function to handle search command. A bare "search" takes the keyboard:
+// typed characters narrow the focused workspace's windows to those whose
+// title or class contains every typed word, BackSpace widens again,
+// Return keeps the filter and gives the keys back, Escape ends the search.
+// "search query <text>" sets the query directly, "search end" ends it.
+SDispatchResult handleSearchCommand(const std::string& argument) {
+    if (argument == "end") {
+        endSearch(true);
+        return SDispatchResult{.success = true, .error = ""};
+    }
+    const bool query = argument.starts_with("query ");
+    if (!argument.empty() && !query) {
+        notify(NotifyLevel::WARNING, NotifyTopic::WARNING, NotifyColors::WARNING, 2000, [&] {
+            return "Unknown search argument: " + argument;
+        });
+        return SDispatchResult{.success = true, .error = ""};
+    }
+    if (!beginSearch()) {
+        return SDispatchResult{.success = true, .error = ""};
+    }
+
+    if (query) {
+        g_search.setQuery(std::string_view(argument).substr(6));
+        applySearch();
+    } else {
+        g_searchSession.typing = true;
+        notify(NotifyLevel::INFO, NotifyTopic::SEARCH, NotifyColors::STATUS, 3000,
+               "Search: type to filter, Return keeps, Escape ends");
+    }
+    return SDispatchResult{.success = true, .error = ""};
+}
+
+// keyPress hook of a typing search. Keys held with Super, Ctrl or Alt
+// still reach the bindings; everything the search takes is cancelled,
+// releases included. Switching away from the searched workspace ends the
+// search.
+void onSearchKey(SCallbackInfo& info, std::any data) {
+    SearchSession& session = g_searchSession;
+    if (!session.typing && session.swallowedKeys.empty()) {
+        return;
+    }
+    auto& keyData = std::any_cast<std::unordered_map<std::string, std::any>&>(data);
+    const auto event = std::any_cast<IKeyboard::SKeyEvent>(keyData["event"]);
+    if (event.state == WL_KEYBOARD_KEY_STATE_RELEASED) {
+        if (std::erase(session.swallowedKeys, event.keycode) > 0) {
+            info.cancelled = true;
+        }
+        return;
+    }
+    if (!session.typing) {
+        return;
+    }
+
+    const auto monitor = g_pCompositor->m_lastMonitor.lock();
+    if (!monitor || !monitor->m_activeWorkspace || monitor->m_activeWorkspace->m_id != session.workspace) {
+        endSearch(true);
+        return;
+    }
+    const auto keyboard = std::any_cast<SP<IKeyboard>>(keyData["keyboard"]);
+    xkb_state* xkb = keyboard ? keyboard->m_xkbState : nullptr;
+    if (!xkb || xkb_state_mod_name_is_active(xkb, XKB_MOD_NAME_LOGO, XKB_STATE_MODS_EFFECTIVE) > 0 ||
+        xkb_state_mod_name_is_active(xkb, XKB_MOD_NAME_CTRL, XKB_STATE_MODS_EFFECTIVE) > 0 ||
+        xkb_state_mod_name_is_active(xkb, XKB_MOD_NAME_ALT, XKB_STATE_MODS_EFFECTIVE) > 0) {
+        return;
+    }
+
+    // Wayland keycodes are evdev codes, xkb's are offset by 8
+    const xkb_keycode_t code = event.keycode + 8;
+    const xkb_keysym_t sym = xkb_state_key_get_one_sym(xkb, code);
+    if (sym == XKB_KEY_Escape) {
+        endSearch(true);
+    } else if (sym == XKB_KEY_Return || sym == XKB_KEY_KP_Enter) {
+        session.typing = false;
+    } else if (sym == XKB_KEY_BackSpace) {
+        g_search.erase();
+        applySearch();
+    } else {
+        char text[8];
+        const int length = xkb_state_key_get_utf8(xkb, code, text, sizeof(text));
+        if (length <= 0 || static_cast<unsigned char>(text[0]) < 0x20 || text[0] == 0x7F) {
+            return;
+        }
+        g_search.type(std::string_view(text, static_cast<std::size_t>(length)));
+        applySearch();
+    }
+    session.swallowedKeys.push_back(event.keycode);
+    info.cancelled = true;
+}
+
+// Where the session is kept: in the compositor instance's own directory
+// next to its sockets, so two instances never share the file. That
+// directory lives in $XDG_RUNTIME_DIR, which is cleared with the login
+// session, so a reboot never restores stale stacks.
+std::string sessionPath() {
+    const char* runtimeDir = std::getenv("XDG_RUNTIME_DIR");
+    const char* signature = std::getenv("HYPRLAND_INSTANCE_SIGNATURE");
+    return std::string(runtimeDir && *runtimeDir ? runtimeDir : "/tmp") + "/hypr/" + (signature ? signature : "") +
+        "/stack3d-session.bin";
+}
+
+// Maps the session file and takes back what the previous plugin instance
+// left stacked or spread, in one pass over the mapped records: saved
+// geometry goes back into the store for windows still alive, and each
+// workspace gets its mode, layout, front layer and slot order back and is
+// re-laid out in the next frame, which also rebuilds render boxes and
+// snapshots. A file written under another compositor instance is reset on
+// open.
+void restoreSession() {
+    const char* signature = std::getenv("HYPRLAND_INSTANCE_SIGNATURE");
+    if (!g_session.open(sessionPath(), sessionFingerprint(signature ? signature : ""))) {
+        notify(NotifyLevel::WARNING, NotifyTopic::WARNING, NotifyColors::WARNING, 3000, [&] {
+            return "[Stack3D] Cannot map " + sessionPath() + ", stacks will not survive a reload";
+        });
+        return;
+    }
+
+    std::unordered_map<WindowId, const CWindow*> live;
+    for (const auto& window : g_pCompositor->m_windows) {
+        if (window) {
+            live.emplace(reinterpret_cast<WindowId>(window.get()), window.get());
+        }
+    }
+    for (const SessionWindow& record : g_session.windows()) {
+        const auto it = record.id != 0 ? live.find(record.id) : live.end();
+        if (it == live.end() || sessionFingerprint(it->second->m_initialClass) != record.fingerprint) {
+            continue;
+        }
+        g_controller.savedGeometry().save(SavedGeometry{.id = record.id,
+                                                        .workspace = record.workspace,
+                                                        .x = record.x,
+                                                        .y = record.y,
+                                                        .width = record.width,
+                                                        .height = record.height,
+                                                        .alpha = record.alpha,
+                                                        .floating = record.floating != 0,
+                                                        .fingerprint = record.fingerprint});
+        g_sessionSlots.insert_or_assign(record.id, record.slot);
+    }
+
+    int restored = 0;
+    for (const SessionWorkspace& record : g_session.workspaces()) {
+        const auto mode = static_cast<StackMode>(record.mode);
+        if (mode != StackMode::STACKED && mode != StackMode::SPREAD) {
+            continue;
+        }
+        const auto workspace = g_pCompositor->getWorkspaceByID(record.workspace);
+        if (!workspace) {
+            continue;
+        }
+        WorkspaceStackState& state = getWorkspaceState(workspace);
+        state.mode = mode;
+        state.layout = record.layout;
+        state.frontLayer = record.frontLayer;
+        state.spreadLayout = record.spreadLayout >= 0 && record.spreadLayout < SPREAD_LAYOUT_COUNT
+            ? static_cast<SpreadLayout>(record.spreadLayout)
+            : SpreadLayout::GRID;
+        state.renderTransform = record.renderTransform != 0 && g_renderWindowHook;
+        // The index was seeded in compositor order; re-filing the windows
+        // by their saved slot gives the stack its order back, with windows
+        // that have none (opened since) after them
+        g_restoreWindows.assign(g_windowIndex.windowsOn(record.workspace).begin(),
+                                g_windowIndex.windowsOn(record.workspace).end());
+        std::ranges::stable_sort(g_restoreWindows, {}, [&](CWindow* window) {
+            const WindowId id = reinterpret_cast<WindowId>(window);
+            const SavedGeometry* saved = g_controller.savedGeometry().find(id);
+            const auto slot = g_sessionSlots.find(id);
+            return saved && saved->workspace == record.workspace && slot != g_sessionSlots.end()
+                ? slot->second
+                : std::numeric_limits<std::uint32_t>::max();
+        });
+        for (auto* window : g_restoreWindows) {
+            g_windowIndex.erase(window);
+            g_windowIndex.insert(window, record.workspace);
+        }
+        // Listed as already laid out, so the re-layout keeps their saved
+        // geometry instead of treating them as newcomers
+        for (auto* window : getWorkspaceWindows(record.workspace)) {
+            state.animatedWindows.push_back(window->m_self);
+        }
+        requestRelayout(record.workspace);
+        ++restored;
+    }
+
+    // Drops the records nothing matched
+    persistSession();
+    if (restored > 0) {
+        notify(NotifyLevel::INFO, NotifyTopic::PLUGIN, NotifyColors::STATUS, 3000, [&] {
+            return "[Stack3D] Restored " + std::to_string(restored) + " stacked workspace(s)";
+        });
+    }
+}
+
+// Workspaces holding indexed windows, in compositor window order
+const std::vector<WORKSPACEID>& indexedWorkspaces() {
+    static std::vector<WORKSPACEID> workspaces;
+    workspaces.clear();
+    for (auto& window : g_pCompositor->m_windows) {
+        const auto workspace = window ? g_windowIndex.workspaceOf(window.get()) : std::nullopt;
+        if (workspace && std::ranges::find(workspaces, *workspace) == workspaces.end()) {
+            workspaces.push_back(*workspace);
+        }
+    }
+    return workspaces;
+}
+
+// Where dispatch traces go unless "trace stop" names a path
+std::string defaultTracePath() {
+    const char* runtimeDir = std::getenv("XDG_RUNTIME_DIR");
+    return std::string(runtimeDir && *runtimeDir ? runtimeDir : "/tmp") + "/stack3d-trace.bin";
+}
+
+// Starts a trace: the config and every indexed window are written first,
+// so a replay begins from the same state
+void startTrace() {
+    for (const auto& [id, state] : g_workspaceStates) {
+        if (state.mode != StackMode::NORMAL || motionActive(state)) {
+            notify(NotifyLevel::WARNING, NotifyTopic::WARNING, NotifyColors::WARNING, 3000,
+                   "Restore every stacked or spread workspace before starting a trace");
+            return;
+        }
+    }
+
+    g_trace.start(monotonicMs());
+    traceConfig(readRawConfig());
+    for (const WORKSPACEID workspace : indexedWorkspaces()) {
+        for (auto* window : g_windowIndex.windowsOn(workspace)) {
+            traceWindowEvent(TraceEventType::WINDOW_OPEN, window, workspace);
+        }
+        traceWorkspaceWindows(workspace);
+    }
+    notify(NotifyLevel::WARNING, NotifyTopic::TRACE, NotifyColors::DETAIL, 2000, "[Stack3D] Recording dispatch trace");
+}
+
+// Stops the trace and writes it to `path`. Running transitions are
+// finished first, so the final geometry is where every window lands.
+void stopTrace(const std::string& path) {
+    for (auto& [id, state] : g_workspaceStates) {
+        finishTransition(state);
+    }
+
+    // Changes the compositor made since the last dispatch are replayed
+    // too, so only the plugin's own results are checked
+    const double now = monotonicMs();
+    for (const WORKSPACEID workspace : indexedWorkspaces()) {
+        traceWorkspaceWindows(workspace);
+        for (auto* window : g_windowIndex.windowsOn(workspace)) {
+            const WindowId id = reinterpret_cast<WindowId>(window);
+            const TraceWindow goal = traceWindowState(window);
+            const RenderBox* box = g_renderTransforms.find(id);
+            TraceEvent event;
+            event.type = TraceEventType::FINAL;
+            event.window = g_trace.windowNumber(id);
+            event.x = box ? box->x : goal.x;
+            event.y = box ? box->y : goal.y;
+            event.width = box ? box->width : goal.width;
+            event.height = box ? box->height : goal.height;
+            event.alpha = goal.alpha;
+            g_trace.append(event, now);
+        }
+    }
+    g_trace.stop();
+
+    if (!writeTraceFile(path, g_trace.bytes())) {
+        notify(NotifyLevel::WARNING, NotifyTopic::WARNING, NotifyColors::WARNING, 3000, [&] {
+            return "Could not write trace to " + path;
+        });
+        return;
+    }
+    notify(NotifyLevel::WARNING, NotifyTopic::TRACE, NotifyColors::DETAIL, 5000, [&] {
+        return "[Stack3D] Trace: " + std::to_string(g_trace.events()) + " events, " +
+            std::to_string(g_trace.bytes().size() / 1024) + " KiB" + (g_trace.truncated() ? " (truncated)" : "") +
+            " written to " + path;
+    });
+}
+
+// Function to handle trace command. "trace start" records dispatches and
+// window events, "trace stop [path]" writes them out for replay_trace.
+SDispatchResult handleTraceCommand(const std::string& argument) {
+    const size_t split = argument.find(' ');
+    const std::string action = argument.substr(0, split);
+    const std::string path = split == std::string::npos ? defaultTracePath() : argument.substr(split + 1);
+
+    if (action == "start" && split == std::string::npos) {
+        if (g_trace.recording()) {
+            notify(NotifyLevel::WARNING, NotifyTopic::WARNING, NotifyColors::WARNING, 2000, "A trace is already recording");
+        } else {
+            startTrace();
+        }
+    } else if (action == "stop") {
+        if (!g_trace.recording()) {
+            notify(NotifyLevel::WARNING, NotifyTopic::WARNING, NotifyColors::WARNING, 2000, "No trace is recording");
+        } else {
+            stopTrace(path);
+        }
+    } else {
+        notify(NotifyLevel::WARNING, NotifyTopic::WARNING, NotifyColors::WARNING, 2000, [&] {
+            return "Unknown trace argument: " + argument;
+        });
     }
-    
-    HyprlandAPI::addNotification(PHANDLE, 
-        "Cycled to window layer " + std::to_string(g_currentFrontWindow), 
-        CHyprColor{0.0, 1.0, 1.0, 1.0}, 1500);
-    
     return SDispatchResult{.success = true, .error = ""};
 }
 
+// Layer number argument of "stack3d layer <n>"
+std::optional<int> parseLayer(const std::string& argument) {
+    int layer = 0;
+    const auto [end, error] = std::from_chars(argument.data(), argument.data() + argument.size(), layer);
+    if (error != std::errc() || end != argument.data() + argument.size()) {
+        return std::nullopt;
+    }
+    return layer;
+}
+
+// "hyprctl stack3d <command> [argument]": the reports of the read-only
+// commands as command output, untruncated and independent of
+// notify_level
+std::string handleHyprCtlRequest(eHyprCtlOutputFormat, std::string request) {
+    // The request still starts with the command name
+    const size_t start = request.find(' ');
+    const std::string rest = start == std::string::npos ? "" : request.substr(start + 1);
+    const size_t split = rest.find(' ');
+    const std::string command = rest.substr(0, split);
+    const std::string argument = split == std::string::npos ? "" : rest.substr(split + 1);
+
+    std::optional<std::string> text;
+    if (command == "stats") {
+        text = runStatsCommand(argument);
+    } else if (command == "governor") {
+        text = runGovernorCommand(argument);
+    }
+    if (!text) {
+        return "usage: hyprctl stack3d stats [reset] | governor [reset]\n";
+    }
+    return *text + "\n";
+}
+
 // Use C linkage for plugin functions to ensure correct symbol names
 extern "C" {
 
@@ -219,28 +2472,165 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO pluginInit(HANDLE handle) {
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:stack3d:default_layout", Hyprlang::INT{0});
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:stack3d:spring_strength", Hyprlang::FLOAT{0.8});
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:stack3d:damping", Hyprlang::FLOAT{0.92});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:stack3d:animation_mode", Hyprlang::INT{0});
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:stack3d:motion_blur", Hyprlang::INT{1});
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:stack3d:perspective", Hyprlang::FLOAT{800.0});
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:stack3d:eye_distance", Hyprlang::FLOAT{1000.0});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:stack3d:projection", Hyprlang::INT{0});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:stack3d:windows_per_stack", Hyprlang::INT{6});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:stack3d:stack_spacing", Hyprlang::FLOAT{400.0});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:stack3d:window_width", Hyprlang::FLOAT{800.0});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:stack3d:window_height", Hyprlang::FLOAT{600.0});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:stack3d:depth_offset_x", Hyprlang::FLOAT{20.0});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:stack3d:depth_offset_y", Hyprlang::FLOAT{15.0});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:stack3d:transparency_step", Hyprlang::FLOAT{0.15});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:stack3d:min_alpha", Hyprlang::FLOAT{0.4});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:stack3d:adaptive", Hyprlang::INT{0});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:stack3d:render_transform", Hyprlang::INT{0});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:stack3d:thumbnail_budget_mb", Hyprlang::INT{64});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:stack3d:thumbnail_scale", Hyprlang::FLOAT{0.5});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:stack3d:thumbnail_refresh_ms", Hyprlang::INT{100});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:stack3d:notify_level", Hyprlang::INT{2});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:stack3d:notify_interval_ms", Hyprlang::INT{250});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:stack3d:exclude_class", Hyprlang::STRING{""});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:stack3d:exclude_title", Hyprlang::STRING{""});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:stack3d:exclude_floating", Hyprlang::INT{0});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:stack3d:exclude_pinned", Hyprlang::INT{0});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:stack3d:min_window_width", Hyprlang::INT{0});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:stack3d:min_window_height", Hyprlang::INT{0});
+
+    // Resolve every value once; dispatches only read the snapshot
+    resolveConfigHandles();
+    reloadConfig();
+    g_configReloadedHook = HyprlandAPI::registerCallbackDynamic(PHANDLE, "configReloaded",
+        [](void*, SCallbackInfo&, std::any) {
+            reloadConfig();
+        });
+
+    // Flushes coalesced toasts once their topic's interval has passed
+    g_notifyTimer = wl_event_loop_add_timer(g_pCompositor->m_wlEventLoop, onNotifyTimer, nullptr);
+    armNotifyTimer(); // config warnings posted above
+
+    // Track windows per workspace instead of rescanning on every dispatch
+    initializeWindowIndex();
+
+    // Drive stack transitions from the monitor frame loop
+    g_preRenderHook = HyprlandAPI::registerCallbackDynamic(PHANDLE, "preRender",
+        [](void*, SCallbackInfo&, std::any data) {
+            onPreRender(std::any_cast<PHLMONITOR>(data));
+        });
+
+    // Draw transform-mode stacks without touching client geometry
+    hookRenderWindow();
+
+    // Typed characters of "stack3d search"
+    g_keyPressHook = HyprlandAPI::registerCallbackDynamic(PHANDLE, "keyPress",
+        [](void*, SCallbackInfo& info, std::any data) {
+            onSearchKey(info, data);
+        });
+
+    // Transitions on an unplugged monitor's workspaces jump to their
+    // target, and render boxes and snapshots made for that monitor are
+    // dropped; the stacks are re-laid out once the workspaces move to
+    // another monitor
+    g_monitorRemovedHook = HyprlandAPI::registerCallbackDynamic(PHANDLE, "monitorRemoved",
+        [](void*, SCallbackInfo&, std::any data) {
+            if (const auto monitor = std::any_cast<PHLMONITOR>(data)) {
+                for (auto& [id, state] : g_workspaceStates) {
+                    if (monitorOf(state) != monitor) {
+                        continue;
+                    }
+                    finishTransition(state);
+                    clearOcclusion(state);
+                    for (const auto& weak : state.animatedWindows) {
+                        eraseRenderTransform(reinterpret_cast<WindowId>(weak.get()));
+                        if (const auto window = weak.lock()) {
+                            setThumbnailLayer(window.get(), false);
+                        }
+                    }
+                }
+            }
+        });
+    g_workspaceHooks.push_back(HyprlandAPI::registerCallbackDynamic(PHANDLE, "moveWorkspace",
+        [](void*, SCallbackInfo&, std::any data) {
+            const auto args = std::any_cast<std::vector<std::any>>(data);
+            if (const auto workspace = std::any_cast<PHLWORKSPACE>(args[0])) {
+                requestRelayout(workspace->m_id);
+            }
+        }));
+    g_workspaceHooks.push_back(HyprlandAPI::registerCallbackDynamic(PHANDLE, "destroyWorkspace",
+        [](void*, SCallbackInfo&, std::any data) {
+            if (auto* workspace = std::any_cast<CWorkspace*>(data)) {
+                if (g_trace.recording()) {
+                    TraceEvent event;
+                    event.type = TraceEventType::WORKSPACE_DESTROY;
+                    event.workspace = workspace->m_id;
+                    g_trace.append(event, monotonicMs());
+                }
+                g_windowIndex.eraseWorkspace(workspace->m_id);
+                dropWorkspaceState(workspace->m_id);
+            }
+        }));
+
+    // Take back the stacks the previous plugin instance left
+    restoreSession();
 
     // Register 3D stack dispatcher
     HyprlandAPI::addDispatcherV2(PHANDLE, "stack3d", [](std::string arg) -> SDispatchResult {
-        HyprlandAPI::addNotification(PHANDLE, "[3DStack] Command: " + arg, 
-                                     CHyprColor{0.0, 1.0, 0.0, 1.0}, 2000);
+        notify(NotifyLevel::DEBUG, NotifyTopic::COMMAND, NotifyColors::STATUS, 2000, [&] {
+            return "[3DStack] Command: " + arg;
+        });
         
-        if (arg == "toggle") {
+        // "<command> [argument]"
+        const size_t split = arg.find(' ');
+        const std::string command = arg.substr(0, split);
+        const std::string argument = split == std::string::npos ? "" : arg.substr(split + 1);
+
+        // Statistics, traces and the effect tier stay available while the plugin is disabled
+        if (command == "stats") {
+            return handleStatsCommand(argument);
+        }
+        if (command == "trace") {
+            return handleTraceCommand(argument);
+        }
+        if (command == "governor") {
+            return handleGovernorCommand(argument);
+        }
+
+        if (!g_config.enabled) {
+            notify(NotifyLevel::WARNING, NotifyTopic::WARNING, NotifyColors::WARNING, 2000,
+                   "Stack3D is disabled (plugin:stack3d:enabled = 0)");
+            return SDispatchResult{.success = true, .error = ""};
+        }
+
+        if (command == "toggle") {
             return handleToggleCommand();
-        } else if (arg == "cycle") {
-            return handleCycleCommand();
+        } else if (command == "search") {
+            return handleSearchCommand(argument);
+        } else if (command == "cycle" && (argument.empty() || argument == "next")) {
+            return handleCycleCommand(1);
+        } else if (command == "cycle" && (argument == "reverse" || argument == "prev")) {
+            return handleCycleCommand(-1);
+        } else if (const auto layer = parseLayer(argument); command == "layer" && layer) {
+            return handleCycleCommand(0, layer);
+        } else if (command == "spread" && argument.empty()) {
+            return handleSpreadCommand(std::nullopt);
+        } else if (const auto layout = parseSpreadLayout(argument); command == "spread" && layout) {
+            return handleSpreadCommand(layout);
         } else {
-            HyprlandAPI::addNotification(PHANDLE, "Unknown command: " + arg, 
-                                         CHyprColor{1.0, 0.5, 0.0, 1.0}, 2000);
+            notify(NotifyLevel::WARNING, NotifyTopic::WARNING, NotifyColors::WARNING, 2000, [&] {
+                return "Unknown command: " + arg;
+            });
             return SDispatchResult{.success = true, .error = ""};
         }
     });
 
-    HyprlandAPI::addNotification(PHANDLE, "[Stack3D] Plugin loaded successfully!", 
-                                 CHyprColor{0.2, 1.0, 0.2, 1.0}, 3000);
+    // Read-only reports as hyprctl output
+    g_hyprCtlCommand = HyprlandAPI::registerHyprCtlCommand(
+        PHANDLE, SHyprCtlCommand{.name = "stack3d", .exact = false, .fn = handleHyprCtlRequest});
+
+    notify(NotifyLevel::INFO, NotifyTopic::PLUGIN, NotifyColor{0.2f, 1.0f, 0.2f, 1.0f}, 3000,
+           "[Stack3D] Plugin loaded successfully!");
 
     return {"Hyprland 3D Stack", 
             "3D window stacking plugin", 
@@ -249,7 +2639,46 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO pluginInit(HANDLE handle) {
 }
 
 APICALL EXPORT void pluginExit() {
-    // Plugin cleanup handled automatically by Hyprland
+    // Parked windows get their own geometry back while the state they are
+    // released through is still intact
+    endSearch(false);
+    for (auto& [id, state] : g_workspaceStates) {
+        cancelMotion(state);
+    }
+    g_occlusionSlots.clear();
+    g_blurSlots.clear();
+    g_windowFilter.clear();
+    g_workspaceStates.clear();
+    g_pendingRelayouts.clear();
+    if (g_renderWindowHook) {
+        HyprlandAPI::removeFunctionHook(PHANDLE, g_renderWindowHook);
+        g_renderWindowHook = nullptr;
+    }
+    g_renderTransforms.clear();
+    g_transformCommits.clear();
+    g_thumbnails.clear();
+    g_thumbnailSurfaces.clear();
+    g_preRenderHook.reset();
+    g_monitorRemovedHook.reset();
+    g_workspaceHooks.clear();
+    if (g_hyprCtlCommand) {
+        HyprlandAPI::unregisterHyprCtlCommand(PHANDLE, g_hyprCtlCommand);
+        g_hyprCtlCommand.reset();
+    }
+    g_configReloadedHook.reset();
+    g_windowHooks.clear();
+    g_keyPressHook.reset();
+    g_searchSession = SearchSession{};
+    g_search.reset();
+    g_windowIndex.clear();
+    g_controller.clear();
+    if (g_notifyTimer) {
+        wl_event_source_remove(g_notifyTimer);
+        g_notifyTimer = nullptr;
+    }
+    g_notifications.clear();
+    // The session file stays for the next pluginInit
+    g_session.close();
 }
 
 } // extern "C"
\ No newline at end of file
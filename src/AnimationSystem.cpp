@@ -0,0 +1,102 @@
+#include "AnimationSystem.hpp"
+
+#include <algorithm>
+
+namespace {
+
+void lerpInto(const std::vector<float>& from, const std::vector<float>& to,
+              const std::vector<float>& progress, std::vector<float>& out) {
+    const std::size_t count = out.size();
+    const float* __restrict a = from.data();
+    const float* __restrict b = to.data();
+    const float* __restrict t = progress.data();
+    float* __restrict result = out.data();
+    for (std::size_t i = 0; i < count; ++i) {
+        result[i] = a[i] + (b[i] - a[i]) * t[i];
+    }
+}
+
+// Overshooting easings (elastic, bounce) carry opacity past its endpoints
+void clampUnit(std::vector<float>& values) {
+    float* __restrict value = values.data();
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        value[i] = std::clamp(value[i], 0.0f, 1.0f);
+    }
+}
+
+} // namespace
+
+void AnimationSystem::start(const LayoutBatch& from, const LayoutBatch& to,
+                            const TransitionParams& params, double nowMs) {
+    const std::size_t count = std::min(from.size(), to.size());
+
+    m_from = from;
+    m_to = to;
+    m_from.resize(count);
+    m_to.resize(count);
+    m_current = m_from;
+
+    m_progress.assign(count, 0.0f);
+    m_done.assign(count, 0);
+    m_moved.clear();
+    m_moved.reserve(count);
+
+    m_easing = easingForStyle(params.style);
+    m_startMs = nowMs;
+    m_durationMs = std::max(params.durationMs, 1.0f);
+    m_staggerMs = std::max(params.staggerMs, 0.0f);
+    m_running = count;
+
+    // Slots already at their target are never reported as moved
+    for (std::size_t i = 0; i < count; ++i) {
+        if (m_from.sameSlot(m_to, i)) {
+            m_progress[i] = 1.0f;
+            m_done[i] = 1;
+            --m_running;
+        }
+    }
+}
+
+bool AnimationSystem::tick(double nowMs) {
+    m_moved.clear();
+    if (m_running == 0) {
+        return false;
+    }
+
+    const std::size_t count = m_to.size();
+    const float elapsed = static_cast<float>(nowMs - m_startMs);
+
+    // Pass 1: per-slot progress and the list of slots that move this frame
+    for (std::size_t i = 0; i < count; ++i) {
+        if (m_done[i]) {
+            continue;
+        }
+        const float local = (elapsed - i * m_staggerMs) / m_durationMs;
+        if (local <= 0.0f) {
+            continue; // still waiting for its stagger slot
+        }
+        if (local >= 1.0f) {
+            m_progress[i] = 1.0f;
+            m_done[i] = 1;
+            --m_running;
+        } else {
+            m_progress[i] = m_easing(local);
+        }
+        m_moved.push_back(static_cast<std::uint32_t>(i));
+    }
+
+    // Pass 2: branch-free interpolation of every property
+    lerpInto(m_from.x, m_to.x, m_progress, m_current.x);
+    lerpInto(m_from.y, m_to.y, m_progress, m_current.y);
+    lerpInto(m_from.width, m_to.width, m_progress, m_current.width);
+    lerpInto(m_from.height, m_to.height, m_progress, m_current.height);
+    lerpInto(m_from.alpha, m_to.alpha, m_progress, m_current.alpha);
+    clampUnit(m_current.alpha);
+
+    return m_running > 0;
+}
+
+void AnimationSystem::cancel() {
+    m_running = 0;
+    m_moved.clear();
+}
@@ -0,0 +1,117 @@
+#include "BezierCurve.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+namespace {
+
+// B(t) = 3(1-t)^2 t p1 + 3(1-t) t^2 p2 + t^3
+float cubicBezier(float t, float p1, float p2) {
+    const float u = 1.0f - t;
+    return 3.0f * u * u * t * p1 + 3.0f * u * t * t * p2 + t * t * t;
+}
+
+const BezierCurve& easeInOutCurve() {
+    static const BezierCurve curve(0.42f, 0.0f, 0.58f, 1.0f);
+    return curve;
+}
+
+const BezierCurve& liquidCurve() {
+    static const BezierCurve curve(0.65f, 0.0f, 0.35f, 1.0f);
+    return curve;
+}
+
+float smoothSlide(float t) {
+    return easeInOutCurve().evaluate(t);
+}
+
+float easeOutBounce(float t) {
+    constexpr float n1 = 7.5625f;
+    constexpr float d1 = 2.75f;
+    if (t < 1.0f / d1) {
+        return n1 * t * t;
+    }
+    if (t < 2.0f / d1) {
+        t -= 1.5f / d1;
+        return n1 * t * t + 0.75f;
+    }
+    if (t < 2.5f / d1) {
+        t -= 2.25f / d1;
+        return n1 * t * t + 0.9375f;
+    }
+    t -= 2.625f / d1;
+    return n1 * t * t + 0.984375f;
+}
+
+float easeOutElastic(float t) {
+    if (t <= 0.0f || t >= 1.0f) {
+        return std::clamp(t, 0.0f, 1.0f);
+    }
+    constexpr float c4 = (2.0f * std::numbers::pi_v<float>) / 3.0f;
+    return std::pow(2.0f, -10.0f * t) * std::sin((t * 10.0f - 0.75f) * c4) + 1.0f;
+}
+
+float easeOutQuad(float t) {
+    return 1.0f - (1.0f - t) * (1.0f - t);
+}
+
+float easeInOutSine(float t) {
+    return -(std::cos(std::numbers::pi_v<float> * t) - 1.0f) / 2.0f;
+}
+
+float easeOutExpo(float t) {
+    return t >= 1.0f ? 1.0f : 1.0f - std::pow(2.0f, -10.0f * t);
+}
+
+float liquidFlow(float t) {
+    return liquidCurve().evaluate(t);
+}
+
+} // namespace
+
+BezierCurve::BezierCurve(float x1, float y1, float x2, float y2) {
+    // Invert x(s) by bisection for each table sample; done once per curve
+    for (int i = 0; i <= SAMPLES; ++i) {
+        const float x = static_cast<float>(i) / SAMPLES;
+        float lo = 0.0f;
+        float hi = 1.0f;
+        for (int iteration = 0; iteration < 24; ++iteration) {
+            const float mid = (lo + hi) / 2.0f;
+            if (cubicBezier(mid, x1, x2) < x) {
+                lo = mid;
+            } else {
+                hi = mid;
+            }
+        }
+        m_table[i] = cubicBezier((lo + hi) / 2.0f, y1, y2);
+    }
+}
+
+float BezierCurve::evaluate(float t) const {
+    const float position = std::clamp(t, 0.0f, 1.0f) * SAMPLES;
+    const int index = std::min(static_cast<int>(position), SAMPLES - 1);
+    const float fraction = position - index;
+    return m_table[index] + (m_table[index + 1] - m_table[index]) * fraction;
+}
+
+EasingFn easingForStyle(TransitionStyle style) {
+    switch (style) {
+        case TransitionStyle::BOUNCE_OUT: return easeOutBounce;
+        case TransitionStyle::ELASTIC_OUT: return easeOutElastic;
+        case TransitionStyle::CASCADE_WAVE: return easeOutQuad;
+        case TransitionStyle::SPIRAL_MOTION: return easeInOutSine;
+        case TransitionStyle::MAGNETIC_ATTRACT: return easeOutExpo;
+        case TransitionStyle::LIQUID_FLOW: return liquidFlow;
+        case TransitionStyle::SMOOTH_SLIDE:
+        default: return smoothSlide;
+    }
+}
+
+TransitionStyle transitionStyleFromConfig(std::int64_t value) {
+    if (value < static_cast<std::int64_t>(TransitionStyle::SMOOTH_SLIDE) ||
+        value > static_cast<std::int64_t>(TransitionStyle::LIQUID_FLOW)) {
+        return TransitionStyle::SMOOTH_SLIDE;
+    }
+    return static_cast<TransitionStyle>(value);
+}
@@ -0,0 +1,367 @@
+#include "DispatchTrace.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+constexpr std::uint8_t MAGIC[8] = {'S', '3', 'D', 'T', 'R', 'A', 'C', 'E'};
+// Bump when a record layout or the config field list changes
+constexpr std::uint16_t VERSION = 1;
+constexpr std::size_t HEADER_SIZE = sizeof(MAGIC) + sizeof(VERSION);
+
+// Appends fields to a byte buffer
+class Encoder {
+  public:
+    explicit Encoder(std::vector<std::uint8_t>& out) : m_out(out) {}
+
+    void byte(std::uint8_t& value) { m_out.push_back(value); }
+
+    void varint(std::uint64_t value) {
+        while (value >= 0x80) {
+            m_out.push_back(static_cast<std::uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        m_out.push_back(static_cast<std::uint8_t>(value));
+    }
+
+    void unsignedValue(std::uint32_t& value) { varint(value); }
+    void signedValue(std::int64_t& value) { varint((static_cast<std::uint64_t>(value) << 1) ^ (value >> 63)); }
+    void signedValue(std::int32_t& value) {
+        std::int64_t wide = value;
+        signedValue(wide);
+    }
+
+    void f32(float& value) { little(std::bit_cast<std::uint32_t>(value)); }
+    void f64(double& value) { little(std::bit_cast<std::uint64_t>(value)); }
+
+  private:
+    template <typename Bits>
+    void little(Bits bits) {
+        for (std::size_t i = 0; i < sizeof(Bits); ++i) {
+            m_out.push_back(static_cast<std::uint8_t>(bits >> (8 * i)));
+        }
+    }
+
+    std::vector<std::uint8_t>& m_out;
+};
+
+// Reads fields back; once a read runs past the end every later read
+// yields zero and ok() stays false
+class Decoder {
+  public:
+    Decoder(std::span<const std::uint8_t> bytes, std::size_t& offset) : m_bytes(bytes), m_offset(offset) {}
+
+    bool ok() const { return m_ok; }
+
+    void byte(std::uint8_t& value) { value = take(); }
+
+    std::uint64_t varint() {
+        std::uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            const std::uint8_t part = take();
+            value |= static_cast<std::uint64_t>(part & 0x7f) << shift;
+            if (!(part & 0x80)) {
+                return value;
+            }
+        }
+        m_ok = false;
+        return 0;
+    }
+
+    void unsignedValue(std::uint32_t& value) { value = static_cast<std::uint32_t>(varint()); }
+    void signedValue(std::int64_t& value) {
+        const std::uint64_t raw = varint();
+        value = static_cast<std::int64_t>(raw >> 1) ^ -static_cast<std::int64_t>(raw & 1);
+    }
+    void signedValue(std::int32_t& value) {
+        std::int64_t wide = 0;
+        signedValue(wide);
+        value = static_cast<std::int32_t>(wide);
+    }
+
+    void f32(float& value) { value = std::bit_cast<float>(little<std::uint32_t>()); }
+    void f64(double& value) { value = std::bit_cast<double>(little<std::uint64_t>()); }
+
+  private:
+    std::uint8_t take() {
+        if (m_offset >= m_bytes.size()) {
+            m_ok = false;
+            return 0;
+        }
+        return m_bytes[m_offset++];
+    }
+
+    template <typename Bits>
+    Bits little() {
+        Bits bits = 0;
+        for (std::size_t i = 0; i < sizeof(Bits); ++i) {
+            bits |= static_cast<Bits>(take()) << (8 * i);
+        }
+        return bits;
+    }
+
+    std::span<const std::uint8_t> m_bytes;
+    std::size_t& m_offset;
+    bool m_ok = true;
+};
+
+// Every RawStack3DConfig field, in trace order. New keys go at the end
+// together with a VERSION bump.
+template <typename Archive>
+void configFields(Archive& archive, RawStack3DConfig& raw) {
+    archive.signedValue(raw.enabled);
+    archive.f64(raw.transitionDuration);
+    archive.f64(raw.staggerDelay);
+    archive.signedValue(raw.transitionStyle);
+    archive.f64(raw.stackDepthStep);
+    archive.f64(raw.spreadPadding);
+    archive.signedValue(raw.defaultLayout);
+    archive.f64(raw.springStrength);
+    archive.f64(raw.damping);
+    archive.signedValue(raw.animationMode);
+    archive.signedValue(raw.motionBlur);
+    archive.f64(raw.perspective);
+    archive.f64(raw.eyeDistance);
+    archive.signedValue(raw.projection);
+    archive.signedValue(raw.windowsPerStack);
+    archive.f64(raw.stackSpacing);
+    archive.f64(raw.windowWidth);
+    archive.f64(raw.windowHeight);
+    archive.f64(raw.depthOffsetX);
+    archive.f64(raw.depthOffsetY);
+    archive.f64(raw.transparencyStep);
+    archive.f64(raw.minAlpha);
+    archive.signedValue(raw.adaptive);
+    archive.signedValue(raw.renderTransform);
+    archive.signedValue(raw.thumbnailBudgetMb);
+    archive.f64(raw.thumbnailScale);
+    archive.signedValue(raw.thumbnailRefreshMs);
+    archive.signedValue(raw.notifyLevel);
+    archive.signedValue(raw.notifyIntervalMs);
+}
+
+template <typename Archive>
+void monitorFields(Archive& archive, MonitorGeometry& monitor) {
+    archive.f32(monitor.x);
+    archive.f32(monitor.y);
+    archive.f32(monitor.width);
+    archive.f32(monitor.height);
+    archive.f32(monitor.scale);
+}
+
+template <typename Archive>
+void geometryFields(Archive& archive, TraceEvent& event) {
+    archive.f32(event.x);
+    archive.f32(event.y);
+    archive.f32(event.width);
+    archive.f32(event.height);
+    archive.f32(event.alpha);
+}
+
+// Payload of one record; the same code writes and reads it
+template <typename Archive>
+void eventFields(Archive& archive, TraceEvent& event) {
+    switch (event.type) {
+        case TraceEventType::CONFIG:
+            configFields(archive, event.config);
+            break;
+        case TraceEventType::TOGGLE:
+        case TraceEventType::CYCLE:
+        case TraceEventType::LAYER:
+        case TraceEventType::SPREAD:
+            archive.signedValue(event.workspace);
+            monitorFields(archive, event.monitor);
+            archive.byte(event.flags);
+            archive.signedValue(event.value);
+            break;
+        case TraceEventType::WINDOW_OPEN:
+        case TraceEventType::WINDOW_MOVE:
+            archive.unsignedValue(event.window);
+            archive.signedValue(event.workspace);
+            break;
+        case TraceEventType::WINDOW_CLOSE:
+            archive.unsignedValue(event.window);
+            break;
+        case TraceEventType::WINDOW_STATE:
+            archive.unsignedValue(event.window);
+            geometryFields(archive, event);
+            archive.byte(event.flags);
+            break;
+        case TraceEventType::RELAYOUT:
+            archive.signedValue(event.workspace);
+            monitorFields(archive, event.monitor);
+            break;
+        case TraceEventType::WORKSPACE_DESTROY:
+            archive.signedValue(event.workspace);
+            break;
+        case TraceEventType::FINAL:
+            archive.unsignedValue(event.window);
+            geometryFields(archive, event);
+            break;
+        case TraceEventType::COUNT:
+            break;
+    }
+}
+
+} // namespace
+
+const char* traceEventName(TraceEventType type) {
+    switch (type) {
+        case TraceEventType::CONFIG: return "config";
+        case TraceEventType::TOGGLE: return "toggle";
+        case TraceEventType::CYCLE: return "cycle";
+        case TraceEventType::LAYER: return "layer";
+        case TraceEventType::SPREAD: return "spread";
+        case TraceEventType::WINDOW_OPEN: return "open";
+        case TraceEventType::WINDOW_CLOSE: return "close";
+        case TraceEventType::WINDOW_MOVE: return "move";
+        case TraceEventType::WINDOW_STATE: return "state";
+        case TraceEventType::RELAYOUT: return "relayout";
+        case TraceEventType::WORKSPACE_DESTROY: return "destroy";
+        case TraceEventType::FINAL: return "final";
+        case TraceEventType::COUNT: break;
+    }
+    return "unknown";
+}
+
+void TraceWriter::start(double nowMs) {
+    m_bytes.assign(std::begin(MAGIC), std::end(MAGIC));
+    m_bytes.push_back(static_cast<std::uint8_t>(VERSION));
+    m_bytes.push_back(static_cast<std::uint8_t>(VERSION >> 8));
+    m_windowNumbers.clear();
+    m_windowStates.clear();
+    m_nextWindow = 0;
+    m_startMs = nowMs;
+    m_lastUs = 0;
+    m_events = 0;
+    m_recording = true;
+    m_truncated = false;
+}
+
+void TraceWriter::stop() {
+    m_recording = false;
+}
+
+std::uint32_t TraceWriter::windowNumber(WindowId id) {
+    const auto [it, inserted] = m_windowNumbers.try_emplace(id, m_nextWindow);
+    if (inserted) {
+        ++m_nextWindow;
+    }
+    return it->second;
+}
+
+void TraceWriter::forgetWindow(WindowId id) {
+    m_windowNumbers.erase(id);
+    m_windowStates.erase(id);
+}
+
+void TraceWriter::expectWindow(WindowId id, const TraceWindow& window) {
+    if (m_recording) {
+        m_windowStates.insert_or_assign(id, window);
+    }
+}
+
+void TraceWriter::syncWindow(WindowId id, const TraceWindow& window, double nowMs) {
+    if (!m_recording) {
+        return;
+    }
+    const auto [it, inserted] = m_windowStates.try_emplace(id, window);
+    if (!inserted && it->second == window) {
+        return;
+    }
+    it->second = window;
+
+    TraceEvent event;
+    event.type = TraceEventType::WINDOW_STATE;
+    event.window = windowNumber(id);
+    event.x = window.x;
+    event.y = window.y;
+    event.width = window.width;
+    event.height = window.height;
+    event.alpha = window.alpha;
+    event.flags = window.flags;
+    append(event, nowMs);
+}
+
+void TraceWriter::append(const TraceEvent& event, double nowMs) {
+    if (!m_recording || m_truncated) {
+        return;
+    }
+    if (m_bytes.size() >= MAX_BYTES) {
+        m_truncated = true;
+        return;
+    }
+
+    // Clamped so a clock step back cannot underflow the delta
+    const std::uint64_t timeUs =
+        std::max(m_lastUs, static_cast<std::uint64_t>(std::max(0.0, (nowMs - m_startMs) * 1000.0)));
+    Encoder encoder(m_bytes);
+    std::uint8_t type = static_cast<std::uint8_t>(event.type);
+    encoder.byte(type);
+    encoder.varint(timeUs - m_lastUs);
+    TraceEvent fields = event;
+    eventFields(encoder, fields);
+    m_lastUs = timeUs;
+    ++m_events;
+}
+
+TraceReader::TraceReader(std::span<const std::uint8_t> bytes) : m_bytes(bytes) {
+    m_valid = bytes.size() >= HEADER_SIZE && std::memcmp(bytes.data(), MAGIC, sizeof(MAGIC)) == 0 &&
+        (bytes[sizeof(MAGIC)] | bytes[sizeof(MAGIC) + 1] << 8) == VERSION;
+    m_offset = m_valid ? HEADER_SIZE : bytes.size();
+}
+
+bool TraceReader::next(TraceEvent& event) {
+    if (m_corrupt || m_offset >= m_bytes.size()) {
+        return false;
+    }
+
+    Decoder decoder(m_bytes, m_offset);
+    std::uint8_t type = 0;
+    decoder.byte(type);
+    if (type >= static_cast<std::uint8_t>(TraceEventType::COUNT)) {
+        m_corrupt = true;
+        return false;
+    }
+    event = TraceEvent{};
+    event.type = static_cast<TraceEventType>(type);
+    m_timeUs += decoder.varint();
+    event.timeUs = m_timeUs;
+    eventFields(decoder, event);
+    if (!decoder.ok()) {
+        m_corrupt = true;
+        return false;
+    }
+    return true;
+}
+
+bool writeTraceFile(const std::string& path, std::span<const std::uint8_t> bytes) {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    const bool written = std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    return std::fclose(file) == 0 && written;
+}
+
+std::optional<std::vector<std::uint8_t>> readTraceFile(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return std::nullopt;
+    }
+    std::vector<std::uint8_t> bytes;
+    std::uint8_t buffer[65536];
+    std::size_t read = 0;
+    while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        bytes.insert(bytes.end(), buffer, buffer + read);
+    }
+    const bool failed = std::ferror(file) != 0;
+    std::fclose(file);
+    if (failed) {
+        return std::nullopt;
+    }
+    return bytes;
+}
@@ -0,0 +1,64 @@
+#include "FrameGovernor.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+const char* qualityTierName(QualityTier tier) {
+    switch (tier) {
+        case QualityTier::FULL: return "full";
+        case QualityTier::NO_BLUR: return "no blur";
+        case QualityTier::CAPPED: return "capped";
+        case QualityTier::WARP: return "warp";
+    }
+    return "unknown";
+}
+
+bool FrameGovernor::record(double costMs, double refreshIntervalMs, double nowMs) {
+    const double budget = refreshIntervalMs * BUDGET_SHARE;
+    m_lastCostMs = costMs;
+    m_lastBudgetMs = budget;
+
+    if (costMs > budget * HEADROOM) {
+        m_lastTightMs = nowMs;
+    }
+    if (costMs <= budget) {
+        m_overruns = 0;
+        return recover(nowMs);
+    }
+
+    // Only consecutive overruns count, a single hitch does not
+    if (++m_overruns < OVERRUN_FRAMES || m_tier == QualityTier::WARP) {
+        return false;
+    }
+    m_tier = static_cast<QualityTier>(static_cast<std::uint8_t>(m_tier) + 1);
+    m_overruns = 0;
+    m_lastChangeMs = nowMs;
+    ++m_stepsDown;
+    return true;
+}
+
+bool FrameGovernor::idle(double nowMs) {
+    return m_tier != QualityTier::FULL && recover(nowMs);
+}
+
+bool FrameGovernor::recover(double nowMs) {
+    if (m_tier == QualityTier::FULL || nowMs - std::max(m_lastChangeMs, m_lastTightMs) < RECOVER_MS) {
+        return false;
+    }
+    m_tier = static_cast<QualityTier>(static_cast<std::uint8_t>(m_tier) - 1);
+    m_lastChangeMs = nowMs;
+    ++m_stepsUp;
+    return true;
+}
+
+void FrameGovernor::reset() {
+    *this = FrameGovernor{};
+}
+
+std::string FrameGovernor::report() const {
+    char buffer[160];
+    std::snprintf(buffer, sizeof(buffer), "tier: %s\nlast frame: %.2fms of %.2fms budget\nsteps down: %llu, up: %llu",
+                  qualityTierName(m_tier), m_lastCostMs, m_lastBudgetMs,
+                  static_cast<unsigned long long>(m_stepsDown), static_cast<unsigned long long>(m_stepsUp));
+    return buffer;
+}
@@ -0,0 +1,131 @@
+#include "GeometryStore.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace {
+
+// Window ids are pointers, so the low bits carry little entropy
+std::uint64_t mixId(WindowId id) {
+    id ^= id >> 33;
+    id *= 0xff51afd7ed558ccdULL;
+    id ^= id >> 33;
+    return id;
+}
+
+} // namespace
+
+std::size_t GeometryStore::bucketFor(WindowId id) const {
+    return mixId(id) & (m_buckets.size() - 1);
+}
+
+std::size_t GeometryStore::findBucket(WindowId id) const {
+    if (m_buckets.empty()) {
+        return m_buckets.size();
+    }
+    const std::size_t mask = m_buckets.size() - 1;
+    for (std::size_t bucket = bucketFor(id);; bucket = (bucket + 1) & mask) {
+        const std::uint32_t slot = m_buckets[bucket];
+        if (slot == EMPTY_SLOT) {
+            return m_buckets.size();
+        }
+        if (m_records[slot].id == id) {
+            return bucket;
+        }
+    }
+}
+
+void GeometryStore::save(const SavedGeometry& geometry) {
+    // Keep the load factor at or below one half
+    if ((m_records.size() + 1) * 2 > m_buckets.size()) {
+        rehash(std::max(MIN_BUCKETS, m_buckets.size() * 2));
+    }
+
+    const std::size_t mask = m_buckets.size() - 1;
+    for (std::size_t bucket = bucketFor(geometry.id);; bucket = (bucket + 1) & mask) {
+        std::uint32_t& slot = m_buckets[bucket];
+        if (slot == EMPTY_SLOT) {
+            slot = static_cast<std::uint32_t>(m_records.size());
+            m_records.push_back(geometry);
+            return;
+        }
+        if (m_records[slot].id == geometry.id) {
+            m_records[slot] = geometry;
+            return;
+        }
+    }
+}
+
+const SavedGeometry* GeometryStore::find(WindowId id) const {
+    const std::size_t bucket = findBucket(id);
+    return bucket < m_buckets.size() ? &m_records[m_buckets[bucket]] : nullptr;
+}
+
+bool GeometryStore::erase(WindowId id) {
+    const std::size_t bucket = findBucket(id);
+    if (bucket >= m_buckets.size()) {
+        return false;
+    }
+    removeBucket(bucket);
+    return true;
+}
+
+void GeometryStore::eraseWorkspace(std::int64_t workspace) {
+    for (std::size_t i = 0; i < m_records.size();) {
+        if (m_records[i].workspace == workspace) {
+            // Removal moves the last record into slot i, so re-check it
+            removeBucket(findBucket(m_records[i].id));
+        } else {
+            ++i;
+        }
+    }
+}
+
+void GeometryStore::removeBucket(std::size_t bucket) {
+    const std::uint32_t slot = m_buckets[bucket];
+    const std::uint32_t last = static_cast<std::uint32_t>(m_records.size() - 1);
+
+    // Keep the pool dense: move the last record into the freed slot
+    if (slot != last) {
+        m_buckets[findBucket(m_records[last].id)] = slot;
+        m_records[slot] = m_records[last];
+    }
+    m_records.pop_back();
+
+    // Backward-shift deletion keeps probe chains intact without tombstones
+    const std::size_t mask = m_buckets.size() - 1;
+    std::size_t hole = bucket;
+    for (std::size_t next = (hole + 1) & mask; m_buckets[next] != EMPTY_SLOT; next = (next + 1) & mask) {
+        const std::size_t home = bucketFor(m_records[m_buckets[next]].id);
+        // Move the entry back if the hole lies on its probe path
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            m_buckets[hole] = m_buckets[next];
+            hole = next;
+        }
+    }
+    m_buckets[hole] = EMPTY_SLOT;
+}
+
+void GeometryStore::rehash(std::size_t bucketCount) {
+    m_buckets.assign(std::bit_ceil(bucketCount), EMPTY_SLOT);
+    const std::size_t mask = m_buckets.size() - 1;
+    for (std::uint32_t slot = 0; slot < m_records.size(); ++slot) {
+        std::size_t bucket = bucketFor(m_records[slot].id);
+        while (m_buckets[bucket] != EMPTY_SLOT) {
+            bucket = (bucket + 1) & mask;
+        }
+        m_buckets[bucket] = slot;
+    }
+}
+
+void GeometryStore::clear() {
+    m_records.clear();
+    std::fill(m_buckets.begin(), m_buckets.end(), EMPTY_SLOT);
+}
+
+void GeometryStore::reserve(std::size_t count) {
+    m_records.reserve(count);
+    if (count * 2 > m_buckets.size()) {
+        rehash(std::max(MIN_BUCKETS, count * 2));
+    }
+}
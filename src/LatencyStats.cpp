@@ -0,0 +1,131 @@
+#include "LatencyStats.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+
+namespace {
+
+// "850ns", "42.1us", "3.20ms"
+std::string formatNs(double ns) {
+    char buffer[32];
+    if (ns < 1000.0) {
+        std::snprintf(buffer, sizeof(buffer), "%.0fns", ns);
+    } else if (ns < 1000000.0) {
+        std::snprintf(buffer, sizeof(buffer), "%.1fus", ns / 1000.0);
+    } else {
+        std::snprintf(buffer, sizeof(buffer), "%.2fms", ns / 1000000.0);
+    }
+    return buffer;
+}
+
+} // namespace
+
+const char* latencyPhaseName(LatencyPhase phase) {
+    switch (phase) {
+        case LatencyPhase::TOGGLE: return "toggle";
+        case LatencyPhase::CYCLE: return "cycle";
+        case LatencyPhase::SPREAD: return "spread";
+        case LatencyPhase::COLLECT: return "collect";
+        case LatencyPhase::LAYOUT: return "layout";
+        case LatencyPhase::APPLY: return "apply";
+        case LatencyPhase::NOTIFY: return "notify";
+        case LatencyPhase::FRAME: return "frame";
+        case LatencyPhase::RELAYOUT: return "relayout";
+        case LatencyPhase::COUNT: break;
+    }
+    return "unknown";
+}
+
+std::size_t LatencyHistogram::bucketOf(std::uint64_t ns) {
+    if (ns < LINEAR_BUCKETS) {
+        return static_cast<std::size_t>(ns);
+    }
+    // Top bit selects the power of two, the next SUB_BUCKET_BITS its slice
+    const unsigned exponent = static_cast<unsigned>(std::bit_width(ns)) - 1;
+    const unsigned shift = exponent - SUB_BUCKET_BITS;
+    const std::size_t sub = static_cast<std::size_t>(ns >> shift) & ((1u << SUB_BUCKET_BITS) - 1);
+    return LINEAR_BUCKETS + ((exponent - SUB_BUCKET_BITS - 1) << SUB_BUCKET_BITS) + sub;
+}
+
+std::uint64_t LatencyHistogram::bucketUpperBound(std::size_t bucket) {
+    if (bucket < LINEAR_BUCKETS) {
+        return bucket;
+    }
+    const std::size_t offset = bucket - LINEAR_BUCKETS;
+    const unsigned shift = static_cast<unsigned>(offset >> SUB_BUCKET_BITS) + 1;
+    const std::uint64_t sub = offset & ((1u << SUB_BUCKET_BITS) - 1);
+    const std::uint64_t lower = ((std::uint64_t{1} << SUB_BUCKET_BITS) + sub) << shift;
+    return lower + ((std::uint64_t{1} << shift) - 1);
+}
+
+LatencySummary LatencyHistogram::summary() const {
+    LatencySummary summary;
+    summary.count = m_count.load(std::memory_order_relaxed);
+    summary.maxNs = m_max.load(std::memory_order_relaxed);
+    if (summary.count == 0) {
+        return summary;
+    }
+    summary.meanNs = static_cast<double>(m_sum.load(std::memory_order_relaxed)) / summary.count;
+
+    // Ranks of the percentiles, 1-based
+    const std::uint64_t p50Rank = (summary.count + 1) / 2;
+    const std::uint64_t p99Rank = std::max<std::uint64_t>(1, (summary.count * 99 + 99) / 100);
+    std::uint64_t seen = 0;
+    for (std::size_t bucket = 0; bucket < BUCKETS && seen < p99Rank; ++bucket) {
+        const std::uint64_t count = m_buckets[bucket].load(std::memory_order_relaxed);
+        if (count == 0) {
+            continue;
+        }
+        const std::uint64_t before = seen;
+        seen += count;
+        // A bucket bound can overshoot the largest sample seen
+        const std::uint64_t bound = std::min(bucketUpperBound(bucket), summary.maxNs);
+        if (before < p50Rank && seen >= p50Rank) {
+            summary.p50Ns = bound;
+        }
+        if (seen >= p99Rank) {
+            summary.p99Ns = bound;
+        }
+    }
+    // Samples recorded while scanning can leave the ranks unreached
+    if (seen < p99Rank) {
+        summary.p99Ns = summary.maxNs;
+        summary.p50Ns = summary.p50Ns ? summary.p50Ns : summary.maxNs;
+    }
+    return summary;
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+void LatencyStats::reset() {
+    for (auto& phase : m_phases) {
+        phase.reset();
+    }
+}
+
+std::string LatencyStats::report() const {
+    std::string text;
+    for (std::size_t i = 0; i < m_phases.size(); ++i) {
+        const LatencySummary summary = m_phases[i].summary();
+        if (summary.count == 0) {
+            continue;
+        }
+        if (!text.empty()) {
+            text += '\n';
+        }
+        text += latencyPhaseName(static_cast<LatencyPhase>(i));
+        text += ": n=" + std::to_string(summary.count) + " mean=" + formatNs(summary.meanNs) +
+            " p50=" + formatNs(static_cast<double>(summary.p50Ns)) +
+            " p99=" + formatNs(static_cast<double>(summary.p99Ns)) +
+            " max=" + formatNs(static_cast<double>(summary.maxNs));
+    }
+    return text.empty() ? "no samples" : text;
+}
@@ -0,0 +1,171 @@
+#include "LayoutCalculator.hpp"
+
+#include <cmath>
+
+void computeStackLayout(const WindowBatch& windows, const MonitorGeometry& monitor,
+                        const StackLayoutParams& params, LayoutBatch& out) {
+    const std::size_t count = windows.size();
+    out.resize(count);
+    if (count == 0) {
+        return;
+    }
+
+    const int perStack = std::max(1, params.windowsPerStack);
+    const int numStacks = stackCount(count, perStack);
+    const StackGrid grid = stackGrid(numStacks, params.stacksPerRow);
+
+    // Hoisted so the stores below cannot alias the parameters
+    const float windowWidth = params.windowWidth;
+    const float windowHeight = params.windowHeight;
+    const float depthOffsetX = params.depthOffsetX;
+    const float depthOffsetY = params.depthOffsetY;
+    const float transparencyStep = params.transparencyStep;
+    const float minAlpha = params.minAlpha;
+    const float front = static_cast<float>(params.frontLayer);
+    const bool keepAspect = params.keepAspect;
+
+    const float* __restrict inW = windows.widths.data();
+    const float* __restrict inH = windows.heights.data();
+
+    float* __restrict outX = out.x.data();
+    float* __restrict outY = out.y.data();
+    float* __restrict outW = out.width.data();
+    float* __restrict outH = out.height.data();
+    float* __restrict outAlpha = out.alpha.data();
+
+    for (int stack = 0; stack < numStacks; ++stack) {
+        const std::size_t begin = static_cast<std::size_t>(stack) * perStack;
+        const int layers = static_cast<int>(std::min<std::size_t>(perStack, count - begin));
+
+        // Calculate stack center position
+        const float centerX = monitor.centerX() + grid.columnOffset(stack) * params.stackSpacing;
+        const float centerY = monitor.centerY() + grid.rowOffset(stack) * params.rowSpacing;
+
+        const float* __restrict sourceW = inW + begin;
+        const float* __restrict sourceH = inH + begin;
+        float* __restrict x = outX + begin;
+        float* __restrict y = outY + begin;
+        float* __restrict w = outW + begin;
+        float* __restrict h = outH + begin;
+        float* __restrict alpha = outAlpha + begin;
+
+        for (int layer = 0; layer < layers; ++layer) {
+            const float depth = static_cast<float>(layer);
+
+            const float fit = fitScale(sourceW[layer], sourceH[layer], windowWidth, windowHeight);
+            const float width = keepAspect ? sourceW[layer] * fit : windowWidth;
+            const float height = keepAspect ? sourceH[layer] * fit : windowHeight;
+
+            // Window position with 3D depth effect
+            x[layer] = centerX - width / 2.0f - depth * depthOffsetX;
+            y[layer] = centerY - height / 2.0f - depth * depthOffsetY;
+            w[layer] = width;
+            h[layer] = height;
+
+            // Same ramp as calculateAlpha(), written as a select
+            const float ramp = std::max(minAlpha, 1.0f - depth * transparencyStep);
+            alpha[layer] = depth == front ? 1.0f : ramp;
+        }
+    }
+}
+
+StackLayoutParams fitStackLayout(std::size_t windowCount, const MonitorGeometry& monitor,
+                                 const StackLayoutParams& base, float padding) {
+    StackLayoutParams fitted = base;
+    fitted.keepAspect = true;
+    if (windowCount == 0) {
+        return fitted;
+    }
+
+    const float availableW = std::max(1.0f, monitor.width - 2.0f * padding);
+    const float availableH = std::max(1.0f, monitor.height - 2.0f * padding);
+    const float offsetX = std::abs(base.depthOffsetX);
+    const float offsetY = std::abs(base.depthOffsetY);
+    const float aspectW = std::max(base.windowWidth, 1.0f);
+    const float aspectH = std::max(base.windowHeight, 1.0f);
+    const float minScale = ADAPTIVE_MIN_BOX / std::min(aspectW, aspectH);
+    const float minBoxW = aspectW * minScale;
+    const float minBoxH = aspectH * minScale;
+
+    // Stacks that fit side by side at the minimum box. Past that, stacks
+    // get deeper than windowsPerStack instead of more numerous.
+    const int fitColumns = std::max(1, static_cast<int>((availableW + padding) / (minBoxW + padding)));
+    const int fitRows = std::max(1, static_cast<int>((availableH + padding) / (minBoxH + padding)));
+    const int stackCap = static_cast<int>(std::min<std::size_t>(
+        windowCount, static_cast<std::size_t>(fitColumns) * static_cast<std::size_t>(fitRows)));
+
+    const int maxLayers = std::max(1, base.windowsPerStack);
+    const int minStacks = std::min(stackCount(windowCount, maxLayers), stackCap);
+    const int maxStacks = std::min(stackCap, minStacks + ADAPTIVE_STACK_SEARCH);
+
+    float bestScale = -1.0f;
+    const auto consider = [&](int stacks, int columns, bool force) {
+        const int rows = (stacks + columns - 1) / columns;
+        const int layers = stackCount(windowCount, stacks);
+        const float freeW = availableW - (columns - 1) * padding;
+        const float freeH = availableH - (rows - 1) * padding;
+        if (!force && (freeW < columns * minBoxW || freeH < rows * minBoxH)) {
+            return;
+        }
+        // Back layers reach `depth` further out on one side of the front
+        // window; stack centres are symmetric about the monitor centre.
+        // Deep stacks have their per-layer offset shrunk rather than
+        // squeezing the box below the minimum.
+        const float depthX =
+            std::clamp((freeW - columns * minBoxW) / (columns + 1), 0.0f, (layers - 1) * offsetX);
+        const float depthY = std::clamp((freeH - rows * minBoxH) / (rows + 1), 0.0f, (layers - 1) * offsetY);
+        const float boxW = (freeW - (columns + 1) * depthX) / columns;
+        const float boxH = (freeH - (rows + 1) * depthY) / rows;
+        const float scale = std::min(boxW / aspectW, boxH / aspectH);
+        if (scale <= bestScale) {
+            return;
+        }
+        bestScale = scale;
+        fitted.windowsPerStack = layers;
+        fitted.stacksPerRow = columns;
+        fitted.windowWidth = std::max(1.0f, aspectW * scale);
+        fitted.windowHeight = std::max(1.0f, aspectH * scale);
+        fitted.depthOffsetX = layers > 1 ? std::copysign(depthX / (layers - 1), base.depthOffsetX) : base.depthOffsetX;
+        fitted.depthOffsetY = layers > 1 ? std::copysign(depthY / (layers - 1), base.depthOffsetY) : base.depthOffsetY;
+        fitted.stackSpacing = fitted.windowWidth + depthX + padding;
+        fitted.rowSpacing = fitted.windowHeight + depthY + padding;
+    };
+
+    for (int stacks = minStacks; stacks <= maxStacks; ++stacks) {
+        // Square-ish cells give the largest box: columns / rows close to
+        // the ratio of the available area to the box aspect
+        const float ideal = std::sqrt(stacks * (availableW * aspectH) / (availableH * aspectW));
+        const int low = std::clamp(static_cast<int>(ideal), 1, stacks);
+        for (int columns = low; columns <= std::min(low + 1, stacks); ++columns) {
+            consider(stacks, columns, false);
+        }
+    }
+    // The capped grid always fits the minimum box, unless the monitor is
+    // smaller than one box
+    if (bestScale < minScale) {
+        consider(stackCap, std::min(fitColumns, stackCap), true);
+    }
+    return fitted;
+}
+
+void collectFrontLayerChanges(std::size_t windowCount, int windowsPerStack, int oldFront, int newFront,
+                              std::vector<std::uint32_t>& dirty) {
+    dirty.clear();
+    if (oldFront == newFront) {
+        return;
+    }
+
+    const std::size_t perStack = static_cast<std::size_t>(std::max(1, windowsPerStack));
+    const std::size_t first = static_cast<std::size_t>(std::min(oldFront, newFront));
+    const std::size_t second = static_cast<std::size_t>(std::max(oldFront, newFront));
+
+    for (std::size_t begin = 0; begin < windowCount; begin += perStack) {
+        const std::size_t layers = std::min(perStack, windowCount - begin);
+        if (first < layers) {
+            dirty.push_back(static_cast<std::uint32_t>(begin + first));
+        }
+        if (second < layers) {
+            dirty.push_back(static_cast<std::uint32_t>(begin + second));
+        }
+    }
+}
@@ -0,0 +1,83 @@
+#include "MotionBlur.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Frames closer together than this are not used for velocity, so two
+// ticks in the same millisecond cannot report a huge speed
+constexpr double MIN_FRAME_MS = 1.0;
+
+} // namespace
+
+void MotionBlur::start(const LayoutBatch& from, double nowMs) {
+    const std::size_t count = from.size();
+    m_centerX.resize(count);
+    m_centerY.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        m_centerX[i] = from.x[i] + from.width[i] * 0.5f;
+        m_centerY[i] = from.y[i] + from.height[i] * 0.5f;
+    }
+    m_velocityX.assign(count, 0.0f);
+    m_velocityY.assign(count, 0.0f);
+    m_streakX.assign(count, 0.0f);
+    m_streakY.assign(count, 0.0f);
+    m_blurred.clear();
+    m_moving.clear();
+    m_lastMs = nowMs;
+}
+
+void MotionBlur::update(const LayoutBatch& current, std::span<const std::uint32_t> moved, double nowMs) {
+    const double elapsedMs = nowMs - m_lastMs;
+    if (elapsedMs < MIN_FRAME_MS) {
+        return;
+    }
+    m_lastMs = nowMs;
+    const float seconds = static_cast<float>(elapsedMs / 1000.0);
+
+    // Slots that moved last frame but not in this one are at rest now
+    for (const auto i : m_moving) {
+        m_velocityX[i] = 0.0f;
+        m_velocityY[i] = 0.0f;
+    }
+    m_moving.clear();
+    m_blurred.clear();
+
+    const float minDistance = MIN_SPEED * seconds;
+    for (const auto i : moved) {
+        // Slots past the batch start() saw have no centre to move from
+        if (i >= m_centerX.size()) {
+            continue;
+        }
+        const float centerX = current.x[i] + current.width[i] * 0.5f;
+        const float centerY = current.y[i] + current.height[i] * 0.5f;
+        const float dx = centerX - m_centerX[i];
+        const float dy = centerY - m_centerY[i];
+        m_centerX[i] = centerX;
+        m_centerY[i] = centerY;
+        m_velocityX[i] = dx / seconds;
+        m_velocityY[i] = dy / seconds;
+        m_moving.push_back(i);
+
+        // Compared as distances to keep the square root off slow windows
+        const float distanceSquared = dx * dx + dy * dy;
+        if (distanceSquared <= minDistance * minDistance) {
+            continue;
+        }
+        const float distance = std::sqrt(distanceSquared);
+        const float length = std::min(distance, MAX_STREAK);
+        m_streakX[i] = -dx / distance * length;
+        m_streakY[i] = -dy / distance * length;
+        m_blurred.push_back(i);
+    }
+}
+
+void MotionBlur::clear() {
+    for (const auto i : m_moving) {
+        m_velocityX[i] = 0.0f;
+        m_velocityY[i] = 0.0f;
+    }
+    m_moving.clear();
+    m_blurred.clear();
+}
@@ -0,0 +1,61 @@
+#include "NotificationManager.hpp"
+
+#include <algorithm>
+
+void NotificationManager::submit(NotifyTopic topic, const NotifyColor& color, int durationMs, double nowMs,
+                                 std::string text) {
+    TopicState& state = m_topics[static_cast<std::size_t>(topic)];
+    ++m_posted;
+    if (state.pending) {
+        ++m_coalesced;
+    }
+
+    state.text = std::move(text);
+    state.color = color;
+    state.durationMs = durationMs;
+
+    // The first message of a burst opens its window; later ones only
+    // replace the text shown when it closes
+    if (!state.pending) {
+        state.pending = true;
+        state.dueMs = std::max(nowMs + m_params.intervalMs, state.lastShownMs + m_params.intervalMs);
+    }
+    if (m_params.intervalMs <= 0.0) {
+        show(state, nowMs);
+    }
+}
+
+void NotificationManager::show(TopicState& state, double nowMs) {
+    state.pending = false;
+    state.lastShownMs = nowMs;
+    ++m_shown;
+    if (m_sink) {
+        m_sink(state.text, state.color, state.durationMs);
+    }
+}
+
+void NotificationManager::flush(double nowMs) {
+    for (TopicState& state : m_topics) {
+        if (state.pending && nowMs >= state.dueMs) {
+            show(state, nowMs);
+        }
+    }
+}
+
+double NotificationManager::nextFlushDelayMs(double nowMs) const {
+    double delay = -1.0;
+    for (const TopicState& state : m_topics) {
+        if (!state.pending) {
+            continue;
+        }
+        const double due = std::max(0.0, state.dueMs - nowMs);
+        delay = delay < 0.0 ? due : std::min(delay, due);
+    }
+    return delay;
+}
+
+void NotificationManager::clear() {
+    for (TopicState& state : m_topics) {
+        state = TopicState{};
+    }
+}
@@ -0,0 +1,177 @@
+#include "OcclusionCuller.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+bool overlaps(const VisibleRect& a, const VisibleRect& b) {
+    return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+// Appends `rect` minus `hole` to `out`: up to four bands around the hole
+void subtract(const VisibleRect& rect, const VisibleRect& hole, std::vector<VisibleRect>& out) {
+    const float left = std::max(rect.x, hole.x);
+    const float right = std::min(rect.x + rect.width, hole.x + hole.width);
+    const float top = std::max(rect.y, hole.y);
+    const float bottom = std::min(rect.y + rect.height, hole.y + hole.height);
+
+    if (top > rect.y) {
+        out.push_back(VisibleRect{rect.x, rect.y, rect.width, top - rect.y});
+    }
+    if (bottom < rect.y + rect.height) {
+        out.push_back(VisibleRect{rect.x, bottom, rect.width, rect.y + rect.height - bottom});
+    }
+    if (left > rect.x) {
+        out.push_back(VisibleRect{rect.x, top, left - rect.x, bottom - top});
+    }
+    if (right < rect.x + rect.width) {
+        out.push_back(VisibleRect{right, top, rect.x + rect.width - right, bottom - top});
+    }
+}
+
+} // namespace
+
+void OcclusionCuller::cellRange(float x, float y, float width, float height, int& x0, int& y0, int& x1,
+                                int& y1) const {
+    x0 = std::clamp(static_cast<int>((x - m_originX) / m_cellW), 0, m_columns - 1);
+    y0 = std::clamp(static_cast<int>((y - m_originY) / m_cellH), 0, m_rows - 1);
+    x1 = std::clamp(static_cast<int>((x + width - m_originX) / m_cellW), 0, m_columns - 1);
+    y1 = std::clamp(static_cast<int>((y + height - m_originY) / m_cellH), 0, m_rows - 1);
+}
+
+void OcclusionCuller::buildGrid(const LayoutBatch& rects, std::span<const std::uint8_t> opaque) {
+    const std::size_t count = rects.size();
+    float minX = 0.0f;
+    float minY = 0.0f;
+    float maxX = 0.0f;
+    float maxY = 0.0f;
+    std::size_t occluders = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (!opaque[i]) {
+            continue;
+        }
+        minX = occluders ? std::min(minX, rects.x[i]) : rects.x[i];
+        minY = occluders ? std::min(minY, rects.y[i]) : rects.y[i];
+        maxX = occluders ? std::max(maxX, rects.x[i] + rects.width[i]) : rects.x[i] + rects.width[i];
+        maxY = occluders ? std::max(maxY, rects.y[i] + rects.height[i]) : rects.y[i] + rects.height[i];
+        ++occluders;
+    }
+
+    const int side = std::clamp(static_cast<int>(std::ceil(std::sqrt(static_cast<float>(occluders)))), 1, MAX_GRID);
+    m_columns = side;
+    m_rows = side;
+    m_originX = minX;
+    m_originY = minY;
+    m_cellW = std::max(1.0f, (maxX - minX) / side);
+    m_cellH = std::max(1.0f, (maxY - minY) / side);
+
+    // Counting pass, prefix sum, fill pass
+    m_cellStart.assign(static_cast<std::size_t>(m_columns) * m_rows + 1, 0);
+    for (int pass = 0; pass < 2; ++pass) {
+        for (std::size_t i = 0; i < count; ++i) {
+            if (!opaque[i]) {
+                continue;
+            }
+            int x0, y0, x1, y1;
+            cellRange(rects.x[i], rects.y[i], rects.width[i], rects.height[i], x0, y0, x1, y1);
+            for (int cy = y0; cy <= y1; ++cy) {
+                for (int cx = x0; cx <= x1; ++cx) {
+                    const std::size_t cell = static_cast<std::size_t>(cy) * m_columns + cx;
+                    if (pass == 0) {
+                        ++m_cellStart[cell + 1];
+                    } else {
+                        m_cellSlots[m_stamp[cell]++] = static_cast<std::uint32_t>(i);
+                    }
+                }
+            }
+        }
+        if (pass == 0) {
+            for (std::size_t cell = 1; cell < m_cellStart.size(); ++cell) {
+                m_cellStart[cell] += m_cellStart[cell - 1];
+            }
+            m_cellSlots.resize(m_cellStart.back());
+            // Fill cursors per cell, reusing the stamp buffer
+            m_stamp.assign(m_cellStart.begin(), m_cellStart.end() - 1);
+        }
+    }
+}
+
+void OcclusionCuller::compute(const LayoutBatch& rects, std::span<const std::uint8_t> opaque,
+                              std::span<const int> depth) {
+    const std::size_t count = rects.size();
+    m_visibility.assign(count, Visibility::VISIBLE);
+    m_offsets.assign(count + 1, 0);
+    m_rects.clear();
+    m_stats = OcclusionStats{};
+    if (count == 0) {
+        return;
+    }
+
+    buildGrid(rects, opaque);
+    // Per-slot stamp of the last window that tested it, so an occluder
+    // spanning several cells is subtracted once
+    m_stamp.assign(count, 0xFFFFFFFFu);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        const VisibleRect self{rects.x[i], rects.y[i], rects.width[i], rects.height[i]};
+        const double area = static_cast<double>(self.width) * self.height;
+        m_stats.totalPixels += area;
+
+        m_region.clear();
+        m_region.push_back(self);
+
+        int x0, y0, x1, y1;
+        cellRange(self.x, self.y, self.width, self.height, x0, y0, x1, y1);
+        bool capped = false;
+        for (int cy = y0; cy <= y1 && !m_region.empty() && !capped; ++cy) {
+            for (int cx = x0; cx <= x1 && !m_region.empty() && !capped; ++cx) {
+                const std::size_t cell = static_cast<std::size_t>(cy) * m_columns + cx;
+                for (std::uint32_t k = m_cellStart[cell]; k < m_cellStart[cell + 1]; ++k) {
+                    const std::uint32_t j = m_cellSlots[k];
+                    if (j == i || m_stamp[j] == i || depth[j] >= depth[i]) {
+                        continue;
+                    }
+                    m_stamp[j] = static_cast<std::uint32_t>(i);
+
+                    const VisibleRect hole{rects.x[j], rects.y[j], rects.width[j], rects.height[j]};
+                    if (!overlaps(self, hole)) {
+                        continue;
+                    }
+                    m_pieces.clear();
+                    for (const VisibleRect& piece : m_region) {
+                        if (overlaps(piece, hole)) {
+                            subtract(piece, hole, m_pieces);
+                        } else {
+                            m_pieces.push_back(piece);
+                        }
+                    }
+                    if (m_pieces.size() > MAX_RECTS) {
+                        capped = true;
+                        break;
+                    }
+                    m_region.swap(m_pieces);
+                    if (m_region.empty()) {
+                        break;
+                    }
+                }
+            }
+        }
+
+        double visible = 0.0;
+        for (const VisibleRect& piece : m_region) {
+            visible += static_cast<double>(piece.width) * piece.height;
+        }
+        m_stats.culledPixels += area - visible;
+
+        if (m_region.empty()) {
+            m_visibility[i] = Visibility::HIDDEN;
+            ++m_stats.hidden;
+        } else if (visible < area) {
+            m_visibility[i] = Visibility::PARTIAL;
+            ++m_stats.partial;
+        }
+        m_rects.insert(m_rects.end(), m_region.begin(), m_region.end());
+        m_offsets[i + 1] = static_cast<std::uint32_t>(m_rects.size());
+    }
+}
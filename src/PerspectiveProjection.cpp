@@ -0,0 +1,86 @@
+#include "PerspectiveProjection.hpp"
+
+#include <algorithm>
+
+bool PerspectiveProjection::update(const ProjectionParams& params) {
+    if (m_valid && params == m_params) {
+        return false;
+    }
+
+    m_params = params;
+    m_valid = true;
+
+    const int layers = std::max(1, params.layers);
+    const float eye = std::max(params.eyeDistance, 1.0f);
+    const float depthStep = std::max(params.depthStep, 0.0f);
+
+    // Keep the vanishing point on screen
+    const float horizon = params.monitorHeight > 0.0f
+        ? std::clamp(params.perspective, 0.0f, params.monitorHeight / 2.0f)
+        : std::max(params.perspective, 0.0f);
+
+    m_scale.resize(layers);
+    m_lift.resize(layers);
+    for (int layer = 0; layer < layers; ++layer) {
+        const float depth = layer * depthStep;
+        const float scale = eye / (eye + depth);
+        m_scale[layer] = scale;
+        m_lift[layer] = -horizon * (1.0f - scale);
+    }
+    return true;
+}
+
+void computePerspectiveStackLayout(const WindowBatch& windows, const MonitorGeometry& monitor,
+                                   const StackLayoutParams& params, const PerspectiveProjection& projection,
+                                   LayoutBatch& out) {
+    const std::size_t count = windows.size();
+    out.resize(count);
+    if (count == 0) {
+        return;
+    }
+
+    const int perStack = std::max(1, std::min(params.windowsPerStack, projection.layers()));
+    const int numStacks = stackCount(count, perStack);
+    const StackGrid grid = stackGrid(numStacks, params.stacksPerRow);
+
+    const float windowWidth = params.windowWidth;
+    const float windowHeight = params.windowHeight;
+    const float transparencyStep = params.transparencyStep;
+    const float minAlpha = params.minAlpha;
+    const float front = static_cast<float>(params.frontLayer);
+    const bool keepAspect = params.keepAspect;
+
+    const float* __restrict scales = projection.scales();
+    const float* __restrict lifts = projection.lifts();
+
+    for (int stack = 0; stack < numStacks; ++stack) {
+        const std::size_t begin = static_cast<std::size_t>(stack) * perStack;
+        const int layers = static_cast<int>(std::min<std::size_t>(perStack, count - begin));
+
+        const float centerX = monitor.centerX() + grid.columnOffset(stack) * params.stackSpacing;
+        const float centerY = monitor.centerY() + grid.rowOffset(stack) * params.rowSpacing;
+
+        const float* __restrict sourceW = windows.widths.data() + begin;
+        const float* __restrict sourceH = windows.heights.data() + begin;
+        float* __restrict x = out.x.data() + begin;
+        float* __restrict y = out.y.data() + begin;
+        float* __restrict w = out.width.data() + begin;
+        float* __restrict h = out.height.data() + begin;
+        float* __restrict alpha = out.alpha.data() + begin;
+
+        for (int layer = 0; layer < layers; ++layer) {
+            const float depth = static_cast<float>(layer);
+            const float fit = fitScale(sourceW[layer], sourceH[layer], windowWidth, windowHeight);
+            const float width = (keepAspect ? sourceW[layer] * fit : windowWidth) * scales[layer];
+            const float height = (keepAspect ? sourceH[layer] * fit : windowHeight) * scales[layer];
+
+            x[layer] = centerX - width / 2.0f;
+            y[layer] = centerY + lifts[layer] - height / 2.0f;
+            w[layer] = width;
+            h[layer] = height;
+
+            const float ramp = std::max(minAlpha, 1.0f - depth * transparencyStep);
+            alpha[layer] = depth == front ? 1.0f : ramp;
+        }
+    }
+}
@@ -0,0 +1,151 @@
+#include "PhysicsMotion.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Semi-implicit Euler for one channel of every body:
+//   v += (k * (target - p) - c * v) * dt;  p += v * dt
+// Sleeping bodies sit exactly on target with zero velocity, so they pass
+// through unchanged and need no mask.
+void integrateChannel(std::vector<float>& position, std::vector<float>& velocity,
+                      const std::vector<float>& target, float stiffness, float friction, float dt) {
+    const std::size_t count = position.size();
+    float* __restrict p = position.data();
+    float* __restrict v = velocity.data();
+    const float* __restrict t = target.data();
+    for (std::size_t i = 0; i < count; ++i) {
+        const float accel = stiffness * (t[i] - p[i]) - friction * v[i];
+        const float vel = v[i] + accel * dt;
+        v[i] = vel;
+        p[i] += vel * dt;
+    }
+}
+
+} // namespace
+
+void PhysicsMotion::start(const LayoutBatch& from, const LayoutBatch& to, const PhysicsParams& params,
+                          double nowMs) {
+    const std::size_t count = std::min(from.size(), to.size());
+
+    m_position = from;
+    m_target = to;
+    m_position.resize(count);
+    m_target.resize(count);
+
+    m_velocity.resize(count);
+    std::fill(m_velocity.x.begin(), m_velocity.x.end(), 0.0f);
+    std::fill(m_velocity.y.begin(), m_velocity.y.end(), 0.0f);
+    std::fill(m_velocity.width.begin(), m_velocity.width.end(), 0.0f);
+    std::fill(m_velocity.height.begin(), m_velocity.height.end(), 0.0f);
+    std::fill(m_velocity.alpha.begin(), m_velocity.alpha.end(), 0.0f);
+
+    m_asleep.assign(count, 0);
+    m_moved.clear();
+    m_moved.reserve(count);
+
+    // c = 2 * zeta * sqrt(k) for a unit-mass body
+    m_stiffness = std::max(params.springStrength, 0.01f) * STIFFNESS_SCALE;
+    m_friction = 2.0f * std::clamp(params.damping, 0.05f, 2.0f) * std::sqrt(m_stiffness);
+    m_lastMs = nowMs;
+    m_accumulatorSeconds = 0.0;
+    m_awake = count;
+
+    for (std::size_t i = 0; i < count; ++i) {
+        if (m_position.sameSlot(m_target, i)) {
+            m_asleep[i] = 1;
+            --m_awake;
+        }
+    }
+}
+
+bool PhysicsMotion::tick(double nowMs) {
+    m_moved.clear();
+    if (m_awake == 0) {
+        return false;
+    }
+
+    m_accumulatorSeconds += std::max(0.0, nowMs - m_lastMs) / 1000.0;
+    m_lastMs = nowMs;
+
+    // Drop time we cannot catch up on rather than spiralling after a stall
+    const double maxBacklog = TIMESTEP_SECONDS * MAX_STEPS_PER_TICK;
+    m_accumulatorSeconds = std::min(m_accumulatorSeconds, maxBacklog);
+
+    // A frame shorter than the timestep moves nothing
+    if (m_accumulatorSeconds < TIMESTEP_SECONDS) {
+        return true;
+    }
+
+    // Everything awake before this frame's steps is written this frame
+    for (std::size_t i = 0; i < m_asleep.size(); ++i) {
+        if (!m_asleep[i]) {
+            m_moved.push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+
+    while (m_accumulatorSeconds >= TIMESTEP_SECONDS && m_awake > 0) {
+        step();
+        m_accumulatorSeconds -= TIMESTEP_SECONDS;
+    }
+
+    return m_awake > 0;
+}
+
+void PhysicsMotion::step() {
+    if (m_awake == 0) {
+        return;
+    }
+
+    const float dt = TIMESTEP_SECONDS;
+    integrateChannel(m_position.x, m_velocity.x, m_target.x, m_stiffness, m_friction, dt);
+    integrateChannel(m_position.y, m_velocity.y, m_target.y, m_stiffness, m_friction, dt);
+    integrateChannel(m_position.width, m_velocity.width, m_target.width, m_stiffness, m_friction, dt);
+    integrateChannel(m_position.height, m_velocity.height, m_target.height, m_stiffness, m_friction, dt);
+    integrateChannel(m_position.alpha, m_velocity.alpha, m_target.alpha, m_stiffness, m_friction, dt);
+
+    settle();
+}
+
+void PhysicsMotion::settle() {
+    const std::size_t count = m_asleep.size();
+    for (std::size_t i = 0; i < count; ++i) {
+        if (m_asleep[i]) {
+            continue;
+        }
+
+        const bool resting =
+            std::abs(m_target.x[i] - m_position.x[i]) < POSITION_EPSILON &&
+            std::abs(m_target.y[i] - m_position.y[i]) < POSITION_EPSILON &&
+            std::abs(m_target.width[i] - m_position.width[i]) < POSITION_EPSILON &&
+            std::abs(m_target.height[i] - m_position.height[i]) < POSITION_EPSILON &&
+            std::abs(m_target.alpha[i] - m_position.alpha[i]) < ALPHA_EPSILON &&
+            std::abs(m_velocity.x[i]) < VELOCITY_EPSILON && std::abs(m_velocity.y[i]) < VELOCITY_EPSILON &&
+            std::abs(m_velocity.width[i]) < VELOCITY_EPSILON &&
+            std::abs(m_velocity.height[i]) < VELOCITY_EPSILON &&
+            std::abs(m_velocity.alpha[i]) < ALPHA_VELOCITY_EPSILON;
+        if (!resting) {
+            continue;
+        }
+
+        // Snap onto the target so the body is an exact fixed point
+        m_position.x[i] = m_target.x[i];
+        m_position.y[i] = m_target.y[i];
+        m_position.width[i] = m_target.width[i];
+        m_position.height[i] = m_target.height[i];
+        m_position.alpha[i] = m_target.alpha[i];
+        m_velocity.x[i] = 0.0f;
+        m_velocity.y[i] = 0.0f;
+        m_velocity.width[i] = 0.0f;
+        m_velocity.height[i] = 0.0f;
+        m_velocity.alpha[i] = 0.0f;
+        m_asleep[i] = 1;
+        --m_awake;
+    }
+}
+
+void PhysicsMotion::cancel() {
+    m_awake = 0;
+    m_moved.clear();
+}
@@ -0,0 +1,13 @@
+#include "RenderTransform.hpp"
+
+#include <algorithm>
+
+RenderTransform fitRenderTransform(const RenderBox& real, const RenderBox& target) {
+    const float scale = std::min(target.width / std::max(real.width, 1.0f),
+                                 target.height / std::max(real.height, 1.0f));
+    return RenderTransform{
+        .x = target.x + (target.width - real.width * scale) / 2.0f,
+        .y = target.y + (target.height - real.height * scale) / 2.0f,
+        .scale = scale,
+    };
+}
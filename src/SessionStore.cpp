@@ -0,0 +1,199 @@
+#include "SessionStore.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr char MAGIC[8] = {'S', '3', 'D', 'S', 'E', 'S', 'S', 0};
+
+// Overwrites `slot` unless it already holds `value`, so unchanged records
+// never dirty their page
+template <typename Record>
+void store(Record& slot, const Record& value) {
+    if (std::memcmp(&slot, &value, sizeof(Record)) != 0) {
+        std::memcpy(&slot, &value, sizeof(Record));
+    }
+}
+
+template <typename Record>
+void clearSlot(Record& slot) {
+    std::memset(static_cast<void*>(&slot), 0, sizeof(Record));
+}
+
+} // namespace
+
+std::uint64_t sessionFingerprint(std::string_view text) {
+    std::uint64_t hash = 0xcbf29ce484222325ull;
+    for (const char c : text) {
+        hash = (hash ^ static_cast<std::uint8_t>(c)) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+std::size_t SessionStore::fileSize(std::uint32_t windowCapacity) {
+    return sizeof(Header) + MAX_WORKSPACES * sizeof(SessionWorkspace) + windowCapacity * sizeof(SessionWindow);
+}
+
+SessionWorkspace* SessionStore::workspaceSlots() const {
+    return reinterpret_cast<SessionWorkspace*>(static_cast<char*>(m_base) + sizeof(Header));
+}
+
+SessionWindow* SessionStore::windowSlots() const {
+    return reinterpret_cast<SessionWindow*>(reinterpret_cast<char*>(workspaceSlots()) +
+                                            MAX_WORKSPACES * sizeof(SessionWorkspace));
+}
+
+// Replaces the mapping; the old one stays if the new one fails
+bool SessionStore::map(std::size_t size) {
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (base == MAP_FAILED) {
+        return false;
+    }
+    if (m_base) {
+        munmap(m_base, m_size);
+    }
+    m_base = base;
+    m_size = size;
+    return true;
+}
+
+bool SessionStore::open(const std::string& path, std::uint64_t instance) {
+    close();
+    // A symlink planted at the path is refused rather than followed
+    m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC | O_NOFOLLOW, 0600);
+    if (m_fd < 0) {
+        return false;
+    }
+
+    // Keep the file only if its header describes exactly these records
+    const off_t existing = lseek(m_fd, 0, SEEK_END);
+    bool valid = false;
+    if (existing >= static_cast<off_t>(sizeof(Header))) {
+        Header stored{};
+        valid = pread(m_fd, &stored, sizeof(stored), 0) == static_cast<ssize_t>(sizeof(stored)) &&
+            std::memcmp(stored.magic, MAGIC, sizeof(MAGIC)) == 0 && stored.version == VERSION &&
+            stored.windowSize == sizeof(SessionWindow) && stored.workspaceSize == sizeof(SessionWorkspace) &&
+            stored.instance == instance && stored.windowCapacity > 0 &&
+            static_cast<std::size_t>(existing) == fileSize(stored.windowCapacity);
+        if (valid && !map(fileSize(stored.windowCapacity))) {
+            close();
+            return false;
+        }
+    }
+
+    if (!valid) {
+        const std::size_t size = fileSize(INITIAL_WINDOWS);
+        if (ftruncate(m_fd, 0) != 0 || ftruncate(m_fd, static_cast<off_t>(size)) != 0 || !map(size)) {
+            close();
+            return false;
+        }
+        Header& fresh = *header();
+        std::memcpy(fresh.magic, MAGIC, sizeof(MAGIC));
+        fresh.version = VERSION;
+        fresh.windowSize = sizeof(SessionWindow);
+        fresh.workspaceSize = sizeof(SessionWorkspace);
+        fresh.windowCapacity = INITIAL_WINDOWS;
+        fresh.instance = instance;
+    }
+
+    // Index the stored windows so the next sync() rewrites them in place
+    const std::uint32_t capacity = header()->windowCapacity;
+    SessionWindow* slots = windowSlots();
+    for (std::uint32_t slot = capacity; slot-- > 0;) {
+        if (slots[slot].id != 0 && m_slots.emplace(slots[slot].id, slot).second) {
+            continue;
+        }
+        if (slots[slot].id != 0) {
+            clearSlot(slots[slot]);
+        }
+        m_free.push_back(slot);
+    }
+    m_touched.assign(capacity, 0);
+    return true;
+}
+
+void SessionStore::close() {
+    if (m_base) {
+        munmap(m_base, m_size);
+        m_base = nullptr;
+        m_size = 0;
+    }
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+    m_slots.clear();
+    m_free.clear();
+    m_touched.clear();
+}
+
+std::span<const SessionWindow> SessionStore::windows() const {
+    return m_base ? std::span<const SessionWindow>(windowSlots(), header()->windowCapacity)
+                  : std::span<const SessionWindow>();
+}
+
+std::span<const SessionWorkspace> SessionStore::workspaces() const {
+    return m_base ? std::span<const SessionWorkspace>(workspaceSlots(), MAX_WORKSPACES)
+                  : std::span<const SessionWorkspace>();
+}
+
+bool SessionStore::grow() {
+    const std::uint32_t capacity = header()->windowCapacity;
+    const std::uint32_t grown = capacity * 2;
+    if (ftruncate(m_fd, static_cast<off_t>(fileSize(grown))) != 0 || !map(fileSize(grown))) {
+        return false;
+    }
+    header()->windowCapacity = grown;
+    m_touched.resize(grown, 0);
+    // Lowest slots are handed out first
+    for (std::uint32_t slot = grown; slot-- > capacity;) {
+        m_free.push_back(slot);
+    }
+    return true;
+}
+
+void SessionStore::sync(std::span<const SessionWindow> windows, std::span<const SessionWorkspace> workspaces) {
+    if (!m_base) {
+        return;
+    }
+
+    // Windows keep their slot while they stay saved; slots not written
+    // this time are freed
+    for (const SessionWindow& window : windows) {
+        auto it = m_slots.find(window.id);
+        if (it == m_slots.end()) {
+            if (m_free.empty() && !grow()) {
+                break;
+            }
+            it = m_slots.emplace(window.id, m_free.back()).first;
+            m_free.pop_back();
+        }
+        store(windowSlots()[it->second], window);
+        m_touched[it->second] = 1;
+    }
+    std::erase_if(m_slots, [&](const auto& entry) {
+        const std::uint32_t slot = entry.second;
+        if (m_touched[slot]) {
+            m_touched[slot] = 0;
+            return false;
+        }
+        clearSlot(windowSlots()[slot]);
+        m_free.push_back(slot);
+        return true;
+    });
+
+    const std::size_t count = std::min<std::size_t>(workspaces.size(), MAX_WORKSPACES);
+    SessionWorkspace* slots = workspaceSlots();
+    for (std::size_t i = 0; i < MAX_WORKSPACES; ++i) {
+        if (i < count) {
+            store(slots[i], workspaces[i]);
+        } else if (slots[i].mode != 0) {
+            clearSlot(slots[i]);
+        }
+    }
+}
@@ -0,0 +1,248 @@
+#include "SpreadLayout.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <numbers>
+
+namespace {
+
+// Vogel spiral: minimum Chebyshev distance between points, in units of the
+// spiral constant (measured ~1.19 for every n; rounded down for margin)
+constexpr float SPIRAL_SPACING = 1.15f;
+constexpr float GOLDEN_ANGLE = std::numbers::pi_v<float> * (3.0f - 2.236068f);
+constexpr float INV_PHI = 0.618034f;
+
+// Output pointers of one kernel run
+struct Output {
+    float* __restrict x;
+    float* __restrict y;
+    float* __restrict w;
+    float* __restrict h;
+    float* __restrict alpha;
+};
+
+Output prepare(const WindowBatch& windows, LayoutBatch& out) {
+    out.resize(windows.size());
+    return Output{out.x.data(), out.y.data(), out.width.data(), out.height.data(), out.alpha.data()};
+}
+
+// Scales slot i down into a cellW x cellH cell centred on (cx, cy),
+// keeping its aspect ratio
+inline void fitInCell(const Output& out, std::size_t i, float width, float height, float cx, float cy, float cellW,
+                      float cellH) {
+    const float scale = fitScale(width, height, cellW, cellH);
+    const float w = width * scale;
+    const float h = height * scale;
+    out.x[i] = cx - w / 2.0f;
+    out.y[i] = cy - h / 2.0f;
+    out.w[i] = w;
+    out.h[i] = h;
+    out.alpha[i] = 1.0f;
+}
+
+// Stretch of a unit-circle arrangement onto the monitor's aspect ratio;
+// stretching by >= 1 on one axis only moves cells further apart
+struct EllipseFit {
+    float radius;
+    float stretchX;
+    float stretchY;
+};
+
+EllipseFit ellipseFit(float width, float height, float padding) {
+    const float rx = std::max(1.0f, width / 2.0f - padding);
+    const float ry = std::max(1.0f, height / 2.0f - padding);
+    const float radius = std::min(rx, ry);
+    return EllipseFit{radius, rx / radius, ry / radius};
+}
+
+} // namespace
+
+// Rows and columns of equal cells, column count chosen for the largest cells
+template <>
+void computeSpreadLayout<SpreadLayout::GRID>(const WindowBatch& windows, const MonitorGeometry& monitor,
+                                              const SpreadParams& params, LayoutBatch& out) {
+    const std::size_t count = windows.size();
+    const Output o = prepare(windows, out);
+    if (count == 0) {
+        return;
+    }
+
+    const float padding = params.padding;
+    float sumW = 0.0f;
+    float sumH = 0.0f;
+    for (std::size_t i = 0; i < count; ++i) {
+        sumW += windows.widths[i];
+        sumH += windows.heights[i];
+    }
+    const float refW = std::max(sumW / count, 1.0f);
+    const float refH = std::max(sumH / count, 1.0f);
+
+    std::size_t cols = 1;
+    float bestScale = -1.0f;
+    for (std::size_t candidate = 1; candidate <= count; ++candidate) {
+        const std::size_t rows = (count + candidate - 1) / candidate;
+        const float cellW = (monitor.width - padding * (candidate + 1)) / candidate;
+        const float cellH = (monitor.height - padding * (rows + 1)) / rows;
+        const float scale = std::min(cellW / refW, cellH / refH);
+        if (scale > bestScale) {
+            bestScale = scale;
+            cols = candidate;
+        }
+    }
+    const std::size_t rows = (count + cols - 1) / cols;
+    const float cellW = std::max(1.0f, (monitor.width - padding * (cols + 1)) / cols);
+    const float cellH = std::max(1.0f, (monitor.height - padding * (rows + 1)) / rows);
+    const float originX = monitor.x + padding + cellW / 2.0f;
+    const float originY = monitor.y + padding + cellH / 2.0f;
+
+    for (std::size_t i = 0; i < count; ++i) {
+        const float col = static_cast<float>(i % cols);
+        const float row = static_cast<float>(i / cols);
+        fitInCell(o, i, windows.widths[i], windows.heights[i], originX + col * (cellW + padding),
+                  originY + row * (cellH + padding), cellW, cellH);
+    }
+}
+
+// Evenly spaced ring around the monitor centre
+template <>
+void computeSpreadLayout<SpreadLayout::CIRCULAR>(const WindowBatch& windows, const MonitorGeometry& monitor,
+                                                  const SpreadParams& params, LayoutBatch& out) {
+    const std::size_t count = windows.size();
+    const Output o = prepare(windows, out);
+    if (count == 0) {
+        return;
+    }
+
+    const EllipseFit fit = ellipseFit(monitor.width, monitor.height, params.padding);
+    float ring = 0.0f;
+    float spacing = 2.0f * fit.radius;
+    if (count > 1) {
+        // Neighbours are a chord apart, so at least chord / sqrt(2) on one
+        // axis; solve ring + spacing / 2 = radius for the ring
+        const float chordFactor = 2.0f * std::sin(std::numbers::pi_v<float> / count) / std::numbers::sqrt2_v<float>;
+        ring = fit.radius / (1.0f + chordFactor / 2.0f);
+        spacing = ring * chordFactor;
+    }
+    const float cellW = std::max(1.0f, spacing * fit.stretchX - params.padding);
+    const float cellH = std::max(1.0f, spacing * fit.stretchY - params.padding);
+    const float step = 2.0f * std::numbers::pi_v<float> / count;
+
+    for (std::size_t i = 0; i < count; ++i) {
+        const float angle = i * step - std::numbers::pi_v<float> / 2.0f;
+        fitInCell(o, i, windows.widths[i], windows.heights[i],
+                  monitor.centerX() + fit.stretchX * ring * std::cos(angle),
+                  monitor.centerY() + fit.stretchY * ring * std::sin(angle), cellW, cellH);
+    }
+}
+
+// Vogel (sunflower) spiral out from the centre, first window in the middle
+template <>
+void computeSpreadLayout<SpreadLayout::SPIRAL>(const WindowBatch& windows, const MonitorGeometry& monitor,
+                                                const SpreadParams& params, LayoutBatch& out) {
+    const std::size_t count = windows.size();
+    const Output o = prepare(windows, out);
+    if (count == 0) {
+        return;
+    }
+
+    const EllipseFit fit = ellipseFit(monitor.width, monitor.height, params.padding);
+    // Outermost centre plus half a cell must stay inside the radius
+    const float constant = fit.radius / (std::sqrt(count - 0.5f) + SPIRAL_SPACING / 2.0f);
+    const float spacing = count > 1 ? constant * SPIRAL_SPACING : 2.0f * fit.radius;
+    const float cellW = std::max(1.0f, spacing * fit.stretchX - params.padding);
+    const float cellH = std::max(1.0f, spacing * fit.stretchY - params.padding);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        const float radius = count > 1 ? constant * std::sqrt(i + 0.5f) : 0.0f;
+        const float angle = i * GOLDEN_ANGLE;
+        fitInCell(o, i, windows.widths[i], windows.heights[i],
+                  monitor.centerX() + fit.stretchX * radius * std::cos(angle),
+                  monitor.centerY() + fit.stretchY * radius * std::sin(angle), cellW, cellH);
+    }
+}
+
+// Golden-ratio splits: each window takes 1/phi of the remaining rectangle,
+// rotating left, top, right, bottom; the last window takes what is left
+template <>
+void computeSpreadLayout<SpreadLayout::FIBONACCI>(const WindowBatch& windows, const MonitorGeometry& monitor,
+                                                   const SpreadParams& params, LayoutBatch& out) {
+    const std::size_t count = windows.size();
+    const Output o = prepare(windows, out);
+    if (count == 0) {
+        return;
+    }
+
+    const float padding = params.padding;
+    float x = monitor.x + padding / 2.0f;
+    float y = monitor.y + padding / 2.0f;
+    float w = std::max(1.0f, monitor.width - padding);
+    float h = std::max(1.0f, monitor.height - padding);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        const unsigned direction = i % 4;
+        // 1 when splitting the width (left / right), 0 for height
+        const float horizontal = static_cast<float>((direction & 1u) ^ 1u);
+        // 1 when the cell sits at the far end (right / bottom)
+        const float far = static_cast<float>(direction >> 1);
+        const float share = i + 1 == count ? 1.0f : INV_PHI;
+
+        const float cellW = w * (horizontal * share + (1.0f - horizontal));
+        const float cellH = h * ((1.0f - horizontal) * share + horizontal);
+        const float cellX = x + far * horizontal * (w - cellW);
+        const float cellY = y + far * (1.0f - horizontal) * (h - cellH);
+
+        // Cells tile the rectangle and are inset by half the padding on each
+        // side; deep splits get smaller than the padding, so cap the inset
+        // to keep every window inside its own cell
+        fitInCell(o, i, windows.widths[i], windows.heights[i], cellX + cellW / 2.0f, cellY + cellH / 2.0f,
+                  cellW - std::min(padding, cellW * 0.2f), cellH - std::min(padding, cellH * 0.2f));
+
+        // The rest of the rectangle is on the opposite side of the cell
+        x += (1.0f - far) * horizontal * cellW;
+        y += (1.0f - far) * (1.0f - horizontal) * cellH;
+        w -= horizontal * cellW;
+        h -= (1.0f - horizontal) * cellH;
+    }
+}
+
+SpreadLayoutFn spreadLayoutKernel(SpreadLayout layout) {
+    static constexpr SpreadLayoutFn KERNELS[SPREAD_LAYOUT_COUNT] = {
+        &computeSpreadLayout<SpreadLayout::GRID>,
+        &computeSpreadLayout<SpreadLayout::CIRCULAR>,
+        &computeSpreadLayout<SpreadLayout::SPIRAL>,
+        &computeSpreadLayout<SpreadLayout::FIBONACCI>,
+    };
+    return KERNELS[static_cast<int>(spreadLayoutFromConfig(static_cast<std::int64_t>(layout)))];
+}
+
+SpreadLayout spreadLayoutFromConfig(std::int64_t value) {
+    if (value < 0 || value >= SPREAD_LAYOUT_COUNT) {
+        return SpreadLayout::GRID;
+    }
+    return static_cast<SpreadLayout>(value);
+}
+
+std::optional<SpreadLayout> parseSpreadLayout(std::string_view name) {
+    for (int i = 0; i < SPREAD_LAYOUT_COUNT; ++i) {
+        if (name == spreadLayoutName(static_cast<SpreadLayout>(i))) {
+            return static_cast<SpreadLayout>(i);
+        }
+    }
+
+    int value = -1;
+    const auto [end, error] = std::from_chars(name.data(), name.data() + name.size(), value);
+    if (error != std::errc() || end != name.data() + name.size() || value < 0 || value >= SPREAD_LAYOUT_COUNT) {
+        return std::nullopt;
+    }
+    return static_cast<SpreadLayout>(value);
+}
+
+const char* spreadLayoutName(SpreadLayout layout) {
+    switch (layout) {
+        case SpreadLayout::GRID: return "grid";
+        case SpreadLayout::CIRCULAR: return "circular";
+        case SpreadLayout::SPIRAL: return "spiral";
+        case SpreadLayout::FIBONACCI: return "fibonacci";
+    }
+    return "grid";
+}
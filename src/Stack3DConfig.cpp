@@ -0,0 +1,63 @@
+#include "Stack3DConfig.hpp"
+
+#include <algorithm>
+
+namespace {
+
+float nonNegative(double value) {
+    return static_cast<float>(std::max(value, 0.0));
+}
+
+float unitInterval(double value) {
+    return static_cast<float>(std::clamp(value, 0.0, 1.0));
+}
+
+} // namespace
+
+Stack3DConfig buildStack3DConfig(const RawStack3DConfig& raw) {
+    Stack3DConfig config;
+    config.enabled = raw.enabled != 0;
+
+    StackLayoutParams& layout = config.layout;
+    layout.windowsPerStack = static_cast<int>(std::clamp<std::int64_t>(raw.windowsPerStack, 1, MAX_WINDOWS_PER_STACK));
+    layout.stackSpacing = nonNegative(raw.stackSpacing);
+    layout.windowWidth = static_cast<float>(std::max(raw.windowWidth, 1.0));
+    layout.windowHeight = static_cast<float>(std::max(raw.windowHeight, 1.0));
+    layout.depthOffsetX = static_cast<float>(raw.depthOffsetX);
+    layout.depthOffsetY = static_cast<float>(raw.depthOffsetY);
+    layout.transparencyStep = unitInterval(raw.transparencyStep);
+    layout.minAlpha = unitInterval(raw.minAlpha);
+    layout.frontLayer = 0;
+    config.adaptive = raw.adaptive != 0;
+
+    config.transition.durationMs = nonNegative(raw.transitionDuration * 1000.0);
+    config.transition.staggerMs = nonNegative(raw.staggerDelay * 1000.0);
+    config.transition.style = transitionStyleFromConfig(raw.transitionStyle);
+
+    config.physics.springStrength =
+        static_cast<float>(std::clamp(raw.springStrength, MIN_SPRING_STRENGTH, MAX_SPRING_STRENGTH));
+    config.physics.damping = static_cast<float>(std::clamp(raw.damping, MIN_DAMPING, MAX_DAMPING));
+    config.animationMode = raw.animationMode == static_cast<std::int64_t>(AnimationMode::PHYSICS)
+        ? AnimationMode::PHYSICS
+        : AnimationMode::EASED;
+
+    config.projection = raw.projection == static_cast<std::int64_t>(ProjectionMode::PERSPECTIVE)
+        ? ProjectionMode::PERSPECTIVE
+        : ProjectionMode::FLAT;
+    config.perspective = nonNegative(raw.perspective);
+    config.eyeDistance = static_cast<float>(std::max(raw.eyeDistance, 1.0));
+    config.stackDepthStep = nonNegative(raw.stackDepthStep);
+
+    config.spread.padding = nonNegative(raw.spreadPadding);
+    config.defaultLayout = spreadLayoutFromConfig(raw.defaultLayout);
+    config.motionBlur = raw.motionBlur != 0;
+    config.renderTransform = raw.renderTransform != 0;
+
+    config.thumbnails.budgetBytes = static_cast<std::size_t>(std::max<std::int64_t>(raw.thumbnailBudgetMb, 0)) << 20;
+    config.thumbnails.scale = static_cast<float>(std::clamp(raw.thumbnailScale, 0.05, 1.0));
+    config.thumbnails.refreshIntervalMs = static_cast<double>(std::max<std::int64_t>(raw.thumbnailRefreshMs, 0));
+
+    config.notify.verbosity = static_cast<int>(std::clamp<std::int64_t>(raw.notifyLevel, 0, 3));
+    config.notify.intervalMs = static_cast<double>(std::max<std::int64_t>(raw.notifyIntervalMs, 0));
+    return config;
+}
@@ -0,0 +1,213 @@
+#include "StackController.hpp"
+
+#include <algorithm>
+
+void StackController::saveWindows(std::span<const WindowState> windows, bool keepSaved) {
+    m_windowBatch.clear();
+    // Every window is saved afresh, so records still filed under the
+    // workspace belong to windows that left it since the last restore
+    if (!keepSaved && !windows.empty()) {
+        m_saved.eraseWorkspace(windows.front().workspace);
+    }
+    m_saved.reserve(m_saved.size() + windows.size());
+
+    // Store original positions, sizes, opacity and floating state
+    for (const WindowState& window : windows) {
+        const SavedGeometry* saved = keepSaved ? m_saved.find(window.id) : nullptr;
+        if (!saved || saved->workspace != window.workspace) {
+            m_saved.save(SavedGeometry{
+                .id = window.id,
+                .workspace = window.workspace,
+                .x = window.x,
+                .y = window.y,
+                .width = window.width,
+                .height = window.height,
+                .alpha = window.alpha,
+                .floating = window.floating,
+                .fingerprint = window.fingerprint,
+            });
+            saved = m_saved.find(window.id);
+        }
+        m_windowBatch.push(window.id, saved->width, saved->height);
+    }
+}
+
+const LayoutBatch& StackController::stack(std::span<const WindowState> windows, const MonitorGeometry& monitor,
+                                          const StackLayoutParams& params, const PerspectiveProjection* projection,
+                                          bool keepSaved) {
+    saveWindows(windows, keepSaved);
+
+    // Calculate the whole stack layout in one batched pass
+    if (projection) {
+        computePerspectiveStackLayout(m_windowBatch, monitor, params, *projection, m_layoutBatch);
+    } else {
+        computeStackLayout(m_windowBatch, monitor, params, m_layoutBatch);
+    }
+    return m_layoutBatch;
+}
+
+const LayoutBatch& StackController::spread(std::span<const WindowState> windows, const MonitorGeometry& monitor,
+                                           SpreadLayoutFn kernel, const SpreadParams& params, bool keepSaved) {
+    saveWindows(windows, keepSaved);
+    kernel(m_windowBatch, monitor, params, m_layoutBatch);
+    return m_layoutBatch;
+}
+
+const LayoutBatch& StackController::restore(std::span<const WindowState> windows) {
+    m_restoreSlots.clear();
+    m_restoreBatch.resize(windows.size());
+
+    for (std::uint32_t i = 0; i < windows.size(); ++i) {
+        const SavedGeometry* saved = m_saved.find(windows[i].id);
+        if (!saved) {
+            continue; // opened while stacked, never moved by us
+        }
+        // Moved to another workspace since; the geometry is not its own
+        // there any more
+        if (saved->workspace != windows[i].workspace) {
+            m_saved.erase(windows[i].id);
+            continue;
+        }
+
+        const std::size_t slot = m_restoreSlots.size();
+        m_restoreSlots.push_back(RestoreSlot{.index = i, .floating = saved->floating});
+        m_restoreBatch.x[slot] = saved->x;
+        m_restoreBatch.y[slot] = saved->y;
+        m_restoreBatch.width[slot] = saved->width;
+        m_restoreBatch.height[slot] = saved->height;
+        m_restoreBatch.alpha[slot] = saved->alpha;
+    }
+    m_restoreBatch.resize(m_restoreSlots.size());
+    return m_restoreBatch;
+}
+
+const std::vector<std::uint32_t>& StackController::cycle(std::size_t windowCount, const StackLayoutParams& params,
+                                                         int oldFront) {
+    collectFrontLayerChanges(windowCount, params.windowsPerStack, oldFront, params.frontLayer, m_dirtySlots);
+    return m_dirtySlots;
+}
+
+float StackController::alphaFor(std::uint32_t slot, const StackLayoutParams& params) {
+    const int positionInStack = static_cast<int>(slot % static_cast<std::uint32_t>(params.windowsPerStack));
+    return calculateAlpha(positionInStack, params.frontLayer, params);
+}
+
+const LayoutBatch& StackController::stackWorkspace(StackWorkspace& workspace, std::span<const WindowState> windows,
+                                                   const MonitorGeometry& monitor, const Stack3DConfig& config,
+                                                   bool keepSaved) {
+    workspace.mode = StackMode::STACKED;
+    workspace.frontLayer = 0;
+    workspace.layout = layoutFor(config, monitor, windows.size());
+    return stack(windows, monitor, workspace.layout, projectionFor(workspace, config, monitor, workspace.layout),
+                 keepSaved);
+}
+
+const LayoutBatch& StackController::spreadWorkspace(StackWorkspace& workspace, std::span<const WindowState> windows,
+                                                    const MonitorGeometry& monitor, const Stack3DConfig& config,
+                                                    std::optional<SpreadLayout> layout, bool motionActive) {
+    const bool keepSaved = motionActive || workspace.mode != StackMode::NORMAL;
+    workspace.mode = StackMode::SPREAD;
+    // The kernel is picked once; its loop has no per-window layout branch
+    workspace.spreadLayout = layout.value_or(config.defaultLayout);
+    return spread(windows, monitor, spreadLayoutKernel(workspace.spreadLayout), config.spread, keepSaved);
+}
+
+const std::vector<WindowId>& StackController::savedWindows(std::int64_t workspace) {
+    m_savedWindows.clear();
+    for (const SavedGeometry& saved : m_saved.records()) {
+        if (saved.workspace == workspace) {
+            m_savedWindows.push_back(saved.id);
+        }
+    }
+    return m_savedWindows;
+}
+
+const LayoutBatch& StackController::restoreWorkspace(StackWorkspace& workspace, std::span<const WindowState> windows) {
+    workspace.mode = StackMode::NORMAL;
+    return restore(windows);
+}
+
+const std::vector<std::uint32_t>& StackController::cycleWorkspace(StackWorkspace& workspace, std::size_t windowCount,
+                                                                  int step, std::optional<int> layer) {
+    const int layers = std::max(1, workspace.layout.windowsPerStack);
+    const int oldFront = workspace.frontLayer;
+    workspace.frontLayer = layer ? *layer : ((oldFront + step) % layers + layers) % layers;
+    return cycle(windowCount, frontParams(workspace), oldFront);
+}
+
+void StackController::diffMembers(std::span<const WindowId> previous, std::span<const WindowState> windows) {
+    m_previous.assign(previous.begin(), previous.end());
+    m_current.clear();
+    for (const WindowState& window : windows) {
+        m_current.push_back(window.id);
+    }
+    std::ranges::sort(m_previous);
+    std::ranges::sort(m_current);
+
+    m_arrivals.clear();
+    for (std::uint32_t i = 0; i < windows.size(); ++i) {
+        if (!std::ranges::binary_search(m_previous, windows[i].id)) {
+            m_arrivals.push_back(i);
+        }
+    }
+}
+
+bool StackController::departed(WindowId id) const {
+    return std::ranges::binary_search(m_previous, id) && !std::ranges::binary_search(m_current, id);
+}
+
+const LayoutBatch& StackController::relayoutWorkspace(StackWorkspace& workspace,
+                                                      std::span<const WindowState> windows,
+                                                      const MonitorGeometry& monitor, const Stack3DConfig& config) {
+    if (workspace.mode == StackMode::SPREAD) {
+        return spread(windows, monitor, spreadLayoutKernel(workspace.spreadLayout), config.spread, true);
+    }
+    if (config.adaptive) {
+        workspace.layout = layoutFor(config, monitor, windows.size());
+    }
+    workspace.frontLayer = std::min(workspace.frontLayer, std::max(1, workspace.layout.windowsPerStack) - 1);
+    const StackLayoutParams params = frontParams(workspace);
+    return stack(windows, monitor, params, projectionFor(workspace, config, monitor, params), true);
+}
+
+StackLayoutParams StackController::layoutFor(const Stack3DConfig& config, const MonitorGeometry& monitor,
+                                             std::size_t windowCount) {
+    if (config.adaptive) {
+        return fitStackLayout(windowCount, monitor, config.layout, config.spread.padding);
+    }
+    return config.layout;
+}
+
+StackLayoutParams StackController::frontParams(const StackWorkspace& workspace) {
+    StackLayoutParams params = workspace.layout;
+    params.frontLayer = workspace.frontLayer;
+    return params;
+}
+
+const PerspectiveProjection* StackController::projectionFor(StackWorkspace& workspace, const Stack3DConfig& config,
+                                                            const MonitorGeometry& monitor,
+                                                            const StackLayoutParams& params) {
+    if (config.projection != ProjectionMode::PERSPECTIVE) {
+        return nullptr;
+    }
+    ProjectionParams projection;
+    projection.perspective = config.perspective;
+    projection.eyeDistance = config.eyeDistance;
+    projection.depthStep = config.stackDepthStep;
+    projection.layers = params.windowsPerStack;
+    projection.monitorWidth = monitor.width;
+    projection.monitorHeight = monitor.height;
+    workspace.projection.update(projection);
+    return &workspace.projection;
+}
+
+void StackController::clear() {
+    m_saved.clear();
+    m_windowBatch.clear();
+    m_restoreSlots.clear();
+    m_dirtySlots.clear();
+    m_previous.clear();
+    m_current.clear();
+    m_arrivals.clear();
+    m_savedWindows.clear();
+}
@@ -0,0 +1,228 @@
+#include "ThumbnailCache.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+void ThumbnailCache::configure(const ThumbnailParams& params) {
+    m_params = params;
+    if (!enabled()) {
+        // Hand every framebuffer back, the entries stay for a re-enable
+        for (std::uint32_t index = m_head; index != NONE;) {
+            const std::uint32_t next = m_entries[index].next;
+            m_evicted.push_back(m_entries[index].id);
+            drop(index);
+            index = next;
+        }
+        return;
+    }
+    // Snapshots a smaller budget drops come back on their next miss
+    evictOverBudget(0.0);
+}
+
+ThumbnailCache::Entry* ThumbnailCache::find(WindowId id) {
+    const auto it = m_lookup.find(id);
+    return it != m_lookup.end() ? &m_entries[it->second] : nullptr;
+}
+
+ThumbnailCache::Entry& ThumbnailCache::obtain(WindowId id) {
+    if (Entry* entry = find(id)) {
+        return *entry;
+    }
+
+    std::uint32_t index;
+    if (!m_free.empty()) {
+        index = m_free.back();
+        m_free.pop_back();
+        m_entries[index] = Entry{};
+    } else {
+        index = static_cast<std::uint32_t>(m_entries.size());
+        m_entries.emplace_back();
+    }
+    m_entries[index].id = id;
+    m_lookup.emplace(id, index);
+    return m_entries[index];
+}
+
+void ThumbnailCache::link(std::uint32_t index) {
+    Entry& entry = m_entries[index];
+    entry.prev = NONE;
+    entry.next = m_head;
+    if (m_head != NONE) {
+        m_entries[m_head].prev = index;
+    }
+    m_head = index;
+    if (m_tail == NONE) {
+        m_tail = index;
+    }
+}
+
+void ThumbnailCache::unlink(std::uint32_t index) {
+    Entry& entry = m_entries[index];
+    if (entry.prev != NONE) {
+        m_entries[entry.prev].next = entry.next;
+    } else {
+        m_head = entry.next;
+    }
+    if (entry.next != NONE) {
+        m_entries[entry.next].prev = entry.prev;
+    } else {
+        m_tail = entry.prev;
+    }
+    entry.prev = NONE;
+    entry.next = NONE;
+}
+
+// Forgets the snapshot of a captured entry, keeping the entry itself
+void ThumbnailCache::drop(std::uint32_t index) {
+    Entry& entry = m_entries[index];
+    unlink(index);
+    m_bytes -= entry.bytes;
+    --m_snapshots;
+    entry.bytes = 0;
+    entry.captured = false;
+    entry.dirty = true;
+}
+
+void ThumbnailCache::evictOverBudget(double nowMs) {
+    while (m_bytes > m_params.budgetBytes && m_tail != NONE) {
+        Entry& entry = m_entries[m_tail];
+        m_evicted.push_back(entry.id);
+        entry.evicted = true;
+        entry.missed = false;
+        entry.evictedMs = nowMs;
+        drop(m_tail);
+    }
+}
+
+void ThumbnailCache::setBackLayer(WindowId id, bool back) {
+    if (!back) {
+        if (Entry* entry = find(id)) {
+            entry->back = false;
+        }
+        return;
+    }
+
+    Entry& entry = obtain(id);
+    if (!entry.back) {
+        entry.back = true;
+        entry.dirty = true;
+        entry.evicted = false;
+    }
+}
+
+void ThumbnailCache::markDirty(WindowId id) {
+    if (Entry* entry = find(id)) {
+        entry->dirty = true;
+    }
+}
+
+const std::vector<WindowId>& ThumbnailCache::refreshes(double nowMs) {
+    m_refreshes.clear();
+    const std::size_t count = m_entries.size();
+    if (!enabled() || count == 0) {
+        return m_refreshes;
+    }
+
+    m_cursor %= count;
+    for (std::size_t scanned = 0; scanned < count && m_refreshes.size() < MAX_REFRESHES_PER_FRAME; ++scanned) {
+        const Entry& entry = m_entries[m_cursor];
+        m_cursor = (m_cursor + 1) % count;
+
+        // An evicted snapshot waits until a draw wants it again and the
+        // interval has passed, or a back-layer set larger than the budget
+        // would capture and evict every frame
+        bool due = true;
+        if (entry.captured) {
+            due = nowMs - entry.refreshedMs >= m_params.refreshIntervalMs;
+        } else if (entry.evicted) {
+            due = entry.missed && nowMs - entry.evictedMs >= m_params.refreshIntervalMs;
+        }
+        if (entry.id != 0 && entry.back && entry.dirty && due) {
+            m_refreshes.push_back(entry.id);
+        }
+    }
+    return m_refreshes;
+}
+
+void ThumbnailCache::snapshotSize(float width, float height, std::uint32_t& outWidth,
+                                  std::uint32_t& outHeight) const {
+    const float scale = std::clamp(m_params.scale, 0.05f, 1.0f);
+    outWidth = static_cast<std::uint32_t>(std::max(1.0f, std::round(width * scale)));
+    outHeight = static_cast<std::uint32_t>(std::max(1.0f, std::round(height * scale)));
+}
+
+void ThumbnailCache::stored(WindowId id, std::uint32_t width, std::uint32_t height, double nowMs) {
+    const auto it = m_lookup.find(id);
+    if (it == m_lookup.end()) {
+        return;
+    }
+
+    const std::uint32_t index = it->second;
+    Entry& entry = m_entries[index];
+    if (entry.captured) {
+        unlink(index);
+        m_bytes -= entry.bytes;
+    } else {
+        ++m_snapshots;
+    }
+
+    entry.bytes = static_cast<std::size_t>(width) * height * BYTES_PER_PIXEL;
+    entry.refreshedMs = nowMs;
+    entry.dirty = false;
+    entry.captured = true;
+    entry.evicted = false;
+    m_bytes += entry.bytes;
+    link(index);
+
+    // A snapshot larger than the whole budget evicts itself
+    evictOverBudget(nowMs);
+}
+
+bool ThumbnailCache::draw(WindowId id) {
+    const auto it = m_lookup.find(id);
+    if (it == m_lookup.end() || !m_entries[it->second].back) {
+        return false;
+    }
+
+    const std::uint32_t index = it->second;
+    if (!m_entries[index].captured) {
+        m_entries[index].missed = true;
+        ++m_misses;
+        return false;
+    }
+
+    ++m_hits;
+    if (m_head != index) {
+        unlink(index);
+        link(index);
+    }
+    return true;
+}
+
+void ThumbnailCache::erase(WindowId id) {
+    const auto it = m_lookup.find(id);
+    if (it == m_lookup.end()) {
+        return;
+    }
+
+    const std::uint32_t index = it->second;
+    if (m_entries[index].captured) {
+        drop(index);
+    }
+    m_entries[index] = Entry{};
+    m_free.push_back(index);
+    m_lookup.erase(it);
+}
+
+void ThumbnailCache::clear() {
+    m_entries.clear();
+    m_free.clear();
+    m_lookup.clear();
+    m_refreshes.clear();
+    m_evicted.clear();
+    m_head = NONE;
+    m_tail = NONE;
+    m_cursor = 0;
+    m_bytes = 0;
+    m_snapshots = 0;
+}
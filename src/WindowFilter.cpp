@@ -0,0 +1,72 @@
+#include "WindowFilter.hpp"
+
+namespace {
+
+// Compiled `pattern`, or nothing if it is empty or invalid; invalid ones
+// are appended to `error`
+std::optional<std::regex> compilePattern(const std::string& pattern, const char* option, std::string& error) {
+    if (pattern.empty()) {
+        return std::nullopt;
+    }
+    try {
+        return std::regex(pattern, std::regex::ECMAScript | std::regex::optimize);
+    } catch (const std::regex_error& e) {
+        if (!error.empty()) {
+            error += "; ";
+        }
+        error += std::string(option) + ": " + e.what();
+        return std::nullopt;
+    }
+}
+
+bool fullMatch(const std::optional<std::regex>& regex, std::string_view text) {
+    return regex && std::regex_match(text.begin(), text.end(), *regex);
+}
+
+} // namespace
+
+void WindowFilter::configure(const WindowRuleParams& params) {
+    m_params = params;
+    m_error.clear();
+    m_classRegex = compilePattern(params.classPattern, "exclude_class", m_error);
+    m_titleRegex = compilePattern(params.titlePattern, "exclude_title", m_error);
+    m_verdicts.clear();
+}
+
+bool WindowFilter::accepts(WindowId id, const WindowFacts& facts) {
+    if ((m_params.excludeFloating && facts.floating) || (m_params.excludePinned && facts.pinned)) {
+        return false;
+    }
+    if (facts.width < m_params.minWidth || facts.height < m_params.minHeight) {
+        return false;
+    }
+    return !hasPatterns() || !excludedByPatterns(id, facts.windowClass, facts.title);
+}
+
+bool WindowFilter::refresh(WindowId id, std::string_view windowClass, std::string_view title) {
+    if (!hasPatterns()) {
+        return false;
+    }
+    const auto it = m_verdicts.find(id);
+    if (it == m_verdicts.end()) {
+        excludedByPatterns(id, windowClass, title);
+        return false;
+    }
+    const bool before = it->second.excluded;
+    return excludedByPatterns(id, windowClass, title) != before;
+}
+
+bool WindowFilter::matchesPatterns(std::string_view windowClass, std::string_view title) const {
+    return fullMatch(m_classRegex, windowClass) || fullMatch(m_titleRegex, title);
+}
+
+bool WindowFilter::excludedByPatterns(WindowId id, std::string_view windowClass, std::string_view title) {
+    auto [it, inserted] = m_verdicts.try_emplace(id);
+    Verdict& verdict = it->second;
+    if (inserted || verdict.windowClass != windowClass || verdict.title != title) {
+        verdict.windowClass.assign(windowClass);
+        verdict.title.assign(title);
+        verdict.excluded = matchesPatterns(windowClass, title);
+    }
+    return verdict.excluded;
+}
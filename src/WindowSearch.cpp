@@ -0,0 +1,180 @@
+#include "WindowSearch.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+char lowerAscii(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// Bytes in the UTF-8 sequence starting with `lead`; stray continuation
+// bytes count as one
+std::size_t sequenceLength(char lead) {
+    const auto byte = static_cast<std::uint8_t>(lead);
+    if (byte >= 0xF0) {
+        return 4;
+    }
+    if (byte >= 0xE0) {
+        return 3;
+    }
+    if (byte >= 0xC0) {
+        return 2;
+    }
+    return 1;
+}
+
+} // namespace
+
+void WindowSearch::reset() {
+    m_texts.clear();
+    m_postings.clear();
+    m_query.clear();
+    m_levels.assign(1, Level{});
+    m_visible.clear();
+    m_changed.clear();
+}
+
+std::uint32_t WindowSearch::add(std::string_view title, std::string_view windowClass) {
+    if (m_levels.empty()) {
+        m_levels.emplace_back();
+    }
+    const auto slot = static_cast<std::uint32_t>(m_texts.size());
+    std::string& text = m_texts.emplace_back();
+    text.reserve(title.size() + 1 + windowClass.size());
+    for (const char c : title) {
+        text.push_back(lowerAscii(c));
+    }
+    text.push_back('\n');
+    for (const char c : windowClass) {
+        text.push_back(lowerAscii(c));
+    }
+
+    // Slots are added in ascending order, so posting lists stay sorted;
+    // a trigram repeated within one text is listed once
+    for (std::size_t i = 0; i + 3 <= text.size(); ++i) {
+        auto& posting = m_postings[trigram(text.data() + i)];
+        if (posting.empty() || posting.back() != slot) {
+            posting.push_back(slot);
+        }
+    }
+
+    m_levels.front().slots.push_back(slot);
+    m_visible.push_back(1);
+    return slot;
+}
+
+void WindowSearch::type(std::string_view text) {
+    m_changed.clear();
+    while (!text.empty()) {
+        const std::size_t length = std::min(sequenceLength(text.front()), text.size());
+        push(text.substr(0, length));
+        text.remove_prefix(length);
+    }
+}
+
+void WindowSearch::erase() {
+    m_changed.clear();
+    pop();
+}
+
+void WindowSearch::setQuery(std::string_view query) {
+    m_changed.clear();
+    std::size_t common = 0;
+    while (common < m_query.size() && common < query.size() && m_query[common] == lowerAscii(query[common])) {
+        ++common;
+    }
+    while (m_query.size() > common) {
+        pop();
+    }
+    // The common prefix may end inside a code point the pops removed
+    query.remove_prefix(m_query.size());
+    while (!query.empty()) {
+        const std::size_t length = std::min(sequenceLength(query.front()), query.size());
+        push(query.substr(0, length));
+        query.remove_prefix(length);
+    }
+}
+
+void WindowSearch::push(std::string_view character) {
+    for (const char c : character) {
+        m_query.push_back(lowerAscii(c));
+    }
+    const std::vector<std::uint32_t>& previous = m_levels.back().slots;
+    Level level;
+    level.length = m_query.size();
+
+    // The trigram ending at the new character, if the last term has one
+    const std::size_t space = m_query.rfind(' ');
+    const std::size_t termStart = space == std::string::npos ? 0 : space + 1;
+    const std::vector<std::uint32_t>* candidates = &previous;
+    if (m_query.size() - termStart >= 3) {
+        const auto posting = m_postings.find(trigram(m_query.data() + m_query.size() - 3));
+        m_scratch.clear();
+        if (posting != m_postings.end()) {
+            std::ranges::set_intersection(previous, posting->second, std::back_inserter(m_scratch));
+        }
+        candidates = &m_scratch;
+    }
+
+    level.slots.reserve(candidates->size());
+    for (const auto slot : *candidates) {
+        if (matchesQuery(slot)) {
+            level.slots.push_back(slot);
+        }
+    }
+
+    // Typing only narrows: the slots that dropped out are the change
+    auto kept = level.slots.begin();
+    for (const auto slot : previous) {
+        if (kept != level.slots.end() && *kept == slot) {
+            ++kept;
+        } else {
+            markChanged(slot);
+        }
+    }
+    m_levels.push_back(std::move(level));
+}
+
+void WindowSearch::pop() {
+    if (m_levels.size() <= 1) {
+        return;
+    }
+    Level level = std::move(m_levels.back());
+    m_levels.pop_back();
+    const Level& previous = m_levels.back();
+
+    // Whatever the popped level dropped comes back
+    auto kept = level.slots.begin();
+    for (const auto slot : previous.slots) {
+        if (kept != level.slots.end() && *kept == slot) {
+            ++kept;
+        } else {
+            markChanged(slot);
+        }
+    }
+    m_query.resize(previous.length);
+}
+
+bool WindowSearch::matchesQuery(std::uint32_t slot) const {
+    const std::string& text = m_texts[slot];
+    std::string_view query = m_query;
+    while (!query.empty()) {
+        const std::size_t space = query.find(' ');
+        const std::string_view term = query.substr(0, space);
+        if (!term.empty() && text.find(term) == std::string::npos) {
+            return false;
+        }
+        if (space == std::string_view::npos) {
+            break;
+        }
+        query.remove_prefix(space + 1);
+    }
+    return true;
+}
+
+void WindowSearch::markChanged(std::uint32_t slot) {
+    m_visible[slot] ^= 1;
+    m_changed.push_back(slot);
+}
@@ -0,0 +1,330 @@
+// Headless benchmark for the toggle / cycle / restore dispatches. Builds
+// synthetic workspaces of mock windows and drives StackController the way
+// main.cpp does: snapshot the active workspace, dispatch, apply the result
+// to the windows. Reports latency, ns/window and heap allocations per
+// dispatch; --json writes the same numbers for diffing between releases.
+//
+//   cd tests && make bench-dispatch
+//   ./bench_dispatch [--json out.json] [--iterations N] [windows...]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "StackController.hpp"
+#include "mocks/hyprland_mocks.hpp"
+
+using HyprlandMocks::MockHyprlandAPI;
+using HyprlandMocks::MockMonitor;
+using HyprlandMocks::MockWindow;
+using HyprlandMocks::MockWorkspace;
+
+// Heap allocation counter; only counts while a dispatch is being timed
+static std::size_t g_allocations = 0;
+static bool g_countAllocations = false;
+
+void* operator new(std::size_t size) {
+    if (g_countAllocations) {
+        ++g_allocations;
+    }
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+// GCC cannot see that operator new above is malloc-based
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+#pragma GCC diagnostic pop
+
+namespace {
+
+enum class Operation {
+    TOGGLE,
+    CYCLE,
+    RESTORE,
+};
+
+constexpr const char* OPERATION_NAMES[] = {"toggle", "cycle", "restore"};
+constexpr int OPERATION_COUNT = 3;
+
+struct Result {
+    std::size_t windows = 0;
+    Operation operation = Operation::TOGGLE;
+    std::size_t iterations = 0;
+    double meanNs = 0.0;
+    double p50Ns = 0.0;
+    double p99Ns = 0.0;
+    double allocationsPerDispatch = 0.0;
+};
+
+// Synthetic workspace registered with the mock API
+struct Scene {
+    MockMonitor monitor{"DP-1", 2560, 1440};
+    MockWorkspace workspace{1};
+    std::vector<std::unique_ptr<MockWindow>> windows;
+    // Mock windows carry no opacity
+    std::vector<float> alphas;
+
+    explicit Scene(std::size_t count) {
+        auto& api = MockHyprlandAPI::getInstance();
+        api.reset();
+        api.addMonitor(&monitor);
+        api.addWorkspace(&workspace);
+        api.setActiveMonitor(&monitor);
+        api.setActiveWorkspace(&workspace);
+
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<double> position(0.0, 2000.0);
+        std::uniform_real_distribution<double> size(300.0, 1200.0);
+        windows.reserve(count);
+        alphas.assign(count, 1.0f);
+        for (std::size_t i = 0; i < count; ++i) {
+            auto window = std::make_unique<MockWindow>("bench " + std::to_string(i));
+            window->setPosition(Vector2D(position(rng), position(rng) * 0.5));
+            window->setSize(Vector2D(size(rng), size(rng) * 0.75));
+            window->setFloating(i % 4 == 0);
+            workspace.addWindow(window.get());
+            api.addWindow(window.get());
+            windows.push_back(std::move(window));
+        }
+    }
+};
+
+// Same snapshot main.cpp takes with captureWindowStates()
+void captureWindowStates(const std::vector<MockWindow*>& windows, const std::vector<float>& alphas,
+                         std::vector<WindowState>& out) {
+    out.clear();
+    for (std::size_t i = 0; i < windows.size(); ++i) {
+        const MockWindow* window = windows[i];
+        out.push_back(WindowState{
+            .id = reinterpret_cast<WindowId>(window),
+            .workspace = window->getWorkspace() ? window->getWorkspace()->getID() : 0,
+            .x = static_cast<float>(window->getPosition().x),
+            .y = static_cast<float>(window->getPosition().y),
+            .width = static_cast<float>(window->getSize().x),
+            .height = static_cast<float>(window->getSize().y),
+            .alpha = alphas[i],
+            .floating = window->isFloating(),
+        });
+    }
+}
+
+MonitorGeometry getMonitorGeometry(const MockMonitor& monitor) {
+    MonitorGeometry geometry;
+    geometry.x = static_cast<float>(monitor.getPosition().x);
+    geometry.y = static_cast<float>(monitor.getPosition().y);
+    geometry.width = static_cast<float>(monitor.getSize().x);
+    geometry.height = static_cast<float>(monitor.getSize().y);
+    return geometry;
+}
+
+// Drives one scene through toggle -> cycle -> restore rounds
+class DispatchDriver {
+  public:
+    explicit DispatchDriver(Scene& scene) : m_scene(scene) {
+        m_states.reserve(scene.windows.size());
+    }
+
+    void dispatch(Operation operation) {
+        auto& api = MockHyprlandAPI::getInstance();
+        const auto& windows = api.getActiveWorkspace()->getWindows();
+
+        switch (operation) {
+            case Operation::TOGGLE: {
+                captureWindowStates(windows, m_scene.alphas, m_states);
+                m_frontLayer = 0;
+                const StackLayoutParams params = paramsFor(m_frontLayer);
+                const LayoutBatch& layout = m_controller.stack(
+                    m_states, getMonitorGeometry(*api.getActiveMonitor()), params, nullptr, false);
+                for (std::size_t i = 0; i < windows.size(); ++i) {
+                    windows[i]->setPosition(Vector2D(layout.x[i], layout.y[i]));
+                    windows[i]->setSize(Vector2D(layout.width[i], layout.height[i]));
+                    m_scene.alphas[i] = layout.alpha[i];
+                }
+                break;
+            }
+            case Operation::CYCLE: {
+                const int oldFront = m_frontLayer;
+                m_frontLayer = (m_frontLayer + 1) % m_params.windowsPerStack;
+                const StackLayoutParams params = paramsFor(m_frontLayer);
+                for (const auto i : m_controller.cycle(windows.size(), params, oldFront)) {
+                    m_scene.alphas[i] = StackController::alphaFor(i, params);
+                }
+                break;
+            }
+            case Operation::RESTORE: {
+                captureWindowStates(windows, m_scene.alphas, m_states);
+                const LayoutBatch& restore = m_controller.restore(m_states);
+                const auto& slots = m_controller.restoreSlots();
+                for (std::size_t slot = 0; slot < slots.size(); ++slot) {
+                    MockWindow* window = windows[slots[slot].index];
+                    window->setPosition(Vector2D(restore.x[slot], restore.y[slot]));
+                    window->setSize(Vector2D(restore.width[slot], restore.height[slot]));
+                    window->setFloating(slots[slot].floating);
+                    m_scene.alphas[slots[slot].index] = restore.alpha[slot];
+                }
+                break;
+            }
+        }
+    }
+
+  private:
+    StackLayoutParams paramsFor(int frontLayer) const {
+        StackLayoutParams params = m_params;
+        params.frontLayer = frontLayer;
+        return params;
+    }
+
+    Scene& m_scene;
+    StackController m_controller;
+    StackLayoutParams m_params;
+    std::vector<WindowState> m_states;
+    int m_frontLayer = 0;
+};
+
+double percentile(std::vector<double>& samples, double fraction) {
+    const std::size_t index = std::min(samples.size() - 1, static_cast<std::size_t>(fraction * samples.size()));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+void runScene(std::size_t windowCount, std::size_t iterations, std::vector<Result>& results) {
+    Scene scene(windowCount);
+    DispatchDriver driver(scene);
+
+    // Warm up so scratch buffers and the geometry table reach steady size
+    constexpr int WARMUP_ROUNDS = 3;
+    for (int round = 0; round < WARMUP_ROUNDS; ++round) {
+        for (int op = 0; op < OPERATION_COUNT; ++op) {
+            driver.dispatch(static_cast<Operation>(op));
+        }
+    }
+
+    std::vector<double> samples[OPERATION_COUNT];
+    std::size_t allocations[OPERATION_COUNT] = {};
+    for (auto& operationSamples : samples) {
+        operationSamples.reserve(iterations);
+    }
+
+    using Clock = std::chrono::steady_clock;
+    for (std::size_t i = 0; i < iterations; ++i) {
+        for (int op = 0; op < OPERATION_COUNT; ++op) {
+            g_allocations = 0;
+            g_countAllocations = true;
+            const auto begin = Clock::now();
+            driver.dispatch(static_cast<Operation>(op));
+            const auto end = Clock::now();
+            g_countAllocations = false;
+
+            allocations[op] += g_allocations;
+            samples[op].push_back(std::chrono::duration<double, std::nano>(end - begin).count());
+        }
+    }
+
+    for (int op = 0; op < OPERATION_COUNT; ++op) {
+        Result result;
+        result.windows = windowCount;
+        result.operation = static_cast<Operation>(op);
+        result.iterations = iterations;
+        double total = 0.0;
+        for (const double sample : samples[op]) {
+            total += sample;
+        }
+        result.meanNs = total / iterations;
+        result.p50Ns = percentile(samples[op], 0.50);
+        result.p99Ns = percentile(samples[op], 0.99);
+        result.allocationsPerDispatch = static_cast<double>(allocations[op]) / iterations;
+        results.push_back(result);
+    }
+}
+
+bool writeJson(const char* path, const std::vector<Result>& results) {
+    std::FILE* file = std::strcmp(path, "-") == 0 ? stdout : std::fopen(path, "w");
+    if (!file) {
+        std::perror(path);
+        return false;
+    }
+
+    std::fprintf(file, "{\n  \"benchmark\": \"dispatch\",\n  \"results\": [\n");
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        std::fprintf(file,
+                     "    {\"windows\": %zu, \"operation\": \"%s\", \"iterations\": %zu, "
+                     "\"mean_ns\": %.1f, \"p50_ns\": %.1f, \"p99_ns\": %.1f, "
+                     "\"ns_per_window\": %.3f, \"allocs_per_dispatch\": %.3f}%s\n",
+                     r.windows, OPERATION_NAMES[static_cast<int>(r.operation)], r.iterations, r.meanNs, r.p50Ns,
+                     r.p99Ns, r.meanNs / r.windows, r.allocationsPerDispatch, i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(file, "  ]\n}\n");
+
+    if (file != stdout) {
+        std::fclose(file);
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* jsonPath = nullptr;
+    std::size_t fixedIterations = 0;
+    std::vector<std::size_t> sizes;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            fixedIterations = std::strtoul(argv[++i], nullptr, 10);
+        } else {
+            sizes.push_back(std::strtoul(argv[i], nullptr, 10));
+        }
+    }
+    if (sizes.empty()) {
+        sizes = {10, 100, 1000, 10000};
+    }
+
+    std::vector<Result> results;
+    for (const std::size_t windowCount : sizes) {
+        if (windowCount == 0) {
+            continue;
+        }
+        // Roughly constant work per size unless overridden
+        const std::size_t iterations = fixedIterations
+            ? fixedIterations
+            : std::clamp<std::size_t>(1000000 / windowCount, 100, 10000);
+        runScene(windowCount, iterations, results);
+    }
+
+    // Keep stdout clean when the JSON goes there
+    std::FILE* table = jsonPath && std::strcmp(jsonPath, "-") == 0 ? stderr : stdout;
+    std::fprintf(table, "%8s  %-8s %10s %12s %12s %12s %10s %8s\n", "windows", "dispatch", "iterations", "mean ns",
+                 "p50 ns", "p99 ns", "ns/window", "allocs");
+    for (const Result& r : results) {
+        std::fprintf(table, "%8zu  %-8s %10zu %12.0f %12.0f %12.0f %10.2f %8.2f\n", r.windows,
+                     OPERATION_NAMES[static_cast<int>(r.operation)], r.iterations, r.meanNs, r.p50Ns, r.p99Ns,
+                     r.meanNs / r.windows, r.allocationsPerDispatch);
+    }
+
+    if (jsonPath && !writeJson(jsonPath, results)) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,74 @@
+// Headless benchmark for PhysicsMotion: steps 1,000 spring bodies from
+// random start to random target geometry until every body is asleep.
+//
+//   cd tests && make bench-physics && ./bench_physics [bodies]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include "PhysicsMotion.hpp"
+
+namespace {
+
+void fillRandom(LayoutBatch& batch, std::mt19937& rng) {
+    std::uniform_real_distribution<float> position(0.0f, 3840.0f);
+    std::uniform_real_distribution<float> size(200.0f, 1600.0f);
+    std::uniform_real_distribution<float> alpha(0.4f, 1.0f);
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        batch.x[i] = position(rng);
+        batch.y[i] = position(rng) * 0.5625f;
+        batch.width[i] = size(rng);
+        batch.height[i] = size(rng) * 0.75f;
+        batch.alpha[i] = alpha(rng);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t bodies = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000;
+    constexpr int MAX_STEPS = 100000;
+
+    std::mt19937 rng(42);
+    LayoutBatch from;
+    LayoutBatch to;
+    from.resize(bodies);
+    to.resize(bodies);
+    fillRandom(from, rng);
+    fillRandom(to, rng);
+
+    PhysicsMotion physics;
+    physics.start(from, to, PhysicsParams{}, 0.0);
+
+    using Clock = std::chrono::steady_clock;
+    int steps = 0;
+    const auto begin = Clock::now();
+    while (physics.active() && steps < MAX_STEPS) {
+        physics.step();
+        ++steps;
+    }
+    const auto end = Clock::now();
+
+    // Cost of ticking a fully settled system, which should be ~nothing
+    constexpr int IDLE_TICKS = 1000000;
+    const auto idleBegin = Clock::now();
+    for (int i = 0; i < IDLE_TICKS; ++i) {
+        physics.tick(i * 4.0);
+    }
+    const auto idleEnd = Clock::now();
+
+    const double totalNs = std::chrono::duration<double, std::nano>(end - begin).count();
+    const double idleNs = std::chrono::duration<double, std::nano>(idleEnd - idleBegin).count();
+    const double simulatedMs = steps * PhysicsMotion::TIMESTEP_SECONDS * 1000.0;
+
+    std::printf("bodies:            %zu\n", bodies);
+    std::printf("steps to settle:   %d (%.1f ms simulated)\n", steps, simulatedMs);
+    std::printf("awake at end:      %zu\n", physics.awakeCount());
+    std::printf("ns/step:           %.1f\n", steps ? totalNs / steps : 0.0);
+    std::printf("ns/body-step:      %.3f\n", steps ? totalNs / (static_cast<double>(steps) * bodies) : 0.0);
+    std::printf("ns/idle tick:      %.3f\n", idleNs / IDLE_TICKS);
+
+    return physics.active() ? 1 : 0;
+}
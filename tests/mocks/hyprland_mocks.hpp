@@ -55,8 +55,8 @@ struct CBox {
 class MockWindow {
 public:
     MockWindow(const std::string& title = "Test Window", const std::string& className = "TestClass") 
-        : m_title(title), m_className(className), m_workspace(nullptr), m_monitor(nullptr),
-          m_position(0, 0), m_size(800, 600), m_floating(false), m_fullscreen(false) {}
+        : m_title(title), m_className(className), m_position(0, 0), m_size(800, 600),
+          m_floating(false), m_fullscreen(false), m_workspace(nullptr), m_monitor(nullptr) {}
     
     // Properties
     Vector2D m_vRealPosition;
@@ -0,0 +1,501 @@
+// Headless replayer for dispatch traces recorded with "stack3d trace start"
+// and "stack3d trace stop". Feeds every record through the mock API's
+// event callbacks (MockHyprlandAPI::triggerEvent) into the same dispatch
+// core main.cpp uses, as fast as it goes, then checks each window's final
+// geometry and opacity against the FINAL records and reports the time
+// spent per event type.
+//
+//   cd tests && make replay TRACE=$XDG_RUNTIME_DIR/stack3d-trace.bin
+//   ./replay_trace [--repeat N] trace.bin
+//
+// Transitions land instantly: a trace holds the window state every
+// dispatch read, so the timing of the live animation does not matter.
+// Exits 1 when the trace cannot be read or a window ends up elsewhere.
+
+#include <algorithm>
+#include <any>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "DispatchTrace.hpp"
+#include "Stack3DConfig.hpp"
+#include "StackController.hpp"
+#include "WindowIndex.hpp"
+#include "mocks/hyprland_mocks.hpp"
+
+using HyprlandMocks::MockHyprlandAPI;
+using HyprlandMocks::MockWindow;
+
+namespace {
+
+// Largest difference a FINAL record tolerates
+constexpr float POSITION_TOLERANCE = 0.5f;
+constexpr float ALPHA_TOLERANCE = 0.01f;
+// Mismatches printed before the rest are only counted
+constexpr std::size_t MISMATCH_REPORT_LIMIT = 20;
+
+constexpr std::size_t EVENT_TYPES = static_cast<std::size_t>(TraceEventType::COUNT);
+
+// Mock event each record type is delivered as
+const char* eventNameFor(TraceEventType type) {
+    switch (type) {
+        case TraceEventType::CONFIG: return "configReloaded";
+        case TraceEventType::TOGGLE:
+        case TraceEventType::CYCLE:
+        case TraceEventType::LAYER:
+        case TraceEventType::SPREAD: return "dispatch:stack3d";
+        case TraceEventType::WINDOW_OPEN: return "openWindow";
+        case TraceEventType::WINDOW_CLOSE: return "closeWindow";
+        case TraceEventType::WINDOW_MOVE: return "moveWindow";
+        case TraceEventType::WINDOW_STATE: return "windowState";
+        case TraceEventType::RELAYOUT: return "preRender";
+        case TraceEventType::WORKSPACE_DESTROY: return "destroyWorkspace";
+        case TraceEventType::FINAL: return "replay:final";
+        case TraceEventType::COUNT: break;
+    }
+    return "";
+}
+
+// A traced window: mock geometry plus what the mocks do not carry
+struct ReplayWindow {
+    std::uint32_t number = 0;
+    MockWindow window;
+    float alpha = 1.0f;
+    // Render box of a transform-mode stack
+    std::optional<CBox> box;
+};
+
+// Mirror of main.cpp's WorkspaceStackState without the motion drivers
+struct ReplayState : StackWorkspace {
+    bool renderTransform = false;
+    // Numbers of the windows the last transition moved
+    std::vector<std::uint32_t> animatedWindows;
+};
+
+// Replays one trace into fresh state, driving StackController the way
+// main.cpp does
+class TraceReplayer {
+  public:
+    TraceReplayer() {
+        auto& api = MockHyprlandAPI::getInstance();
+        api.reset();
+        on(api, TraceEventType::CONFIG, &TraceReplayer::onConfig);
+        on(api, TraceEventType::TOGGLE, &TraceReplayer::onDispatch);
+        on(api, TraceEventType::WINDOW_OPEN, &TraceReplayer::onWindowOpen);
+        on(api, TraceEventType::WINDOW_CLOSE, &TraceReplayer::onWindowClose);
+        on(api, TraceEventType::WINDOW_MOVE, &TraceReplayer::onWindowMove);
+        on(api, TraceEventType::WINDOW_STATE, &TraceReplayer::onWindowState);
+        on(api, TraceEventType::RELAYOUT, &TraceReplayer::onRelayout);
+        on(api, TraceEventType::WORKSPACE_DESTROY, &TraceReplayer::onWorkspaceDestroy);
+        on(api, TraceEventType::FINAL, &TraceReplayer::onFinal);
+    }
+
+    ~TraceReplayer() { MockHyprlandAPI::getInstance().reset(); }
+
+    TraceReplayer(const TraceReplayer&) = delete;
+    TraceReplayer& operator=(const TraceReplayer&) = delete;
+
+    void replay(const TraceEvent& event) {
+        MockHyprlandAPI::getInstance().triggerEvent(eventNameFor(event.type), &event);
+    }
+
+    std::size_t finalChecks() const { return m_finalChecks; }
+    const std::vector<std::string>& mismatches() const { return m_mismatches; }
+    std::size_t mismatchCount() const { return m_mismatchCount; }
+
+  private:
+    using Handler = void (TraceReplayer::*)(const TraceEvent&);
+
+    void on(MockHyprlandAPI& api, TraceEventType type, Handler handler) {
+        api.registerCallback(eventNameFor(type), [this, handler](void*, std::any data) {
+            (this->*handler)(*std::any_cast<const TraceEvent*>(data));
+        });
+    }
+
+    ReplayWindow& windowFor(std::uint32_t number) {
+        auto& slot = m_windows[number];
+        if (!slot) {
+            slot = std::make_unique<ReplayWindow>();
+            slot->number = number;
+        }
+        return *slot;
+    }
+
+    ReplayWindow* findWindow(std::uint32_t number) {
+        const auto it = m_windows.find(number);
+        return it != m_windows.end() ? it->second.get() : nullptr;
+    }
+
+    // Stackable windows of `workspace` in index order
+    const std::vector<ReplayWindow*>& workspaceWindows(std::int64_t workspace) {
+        m_workspaceWindows.clear();
+        for (auto* window : m_index.windowsOn(workspace)) {
+            if (!window->window.m_bHidden) {
+                m_workspaceWindows.push_back(window);
+            }
+        }
+        return m_workspaceWindows;
+    }
+
+    void captureWindowStates(std::span<ReplayWindow* const> windows) {
+        m_states.clear();
+        for (ReplayWindow* window : windows) {
+            m_states.push_back(WindowState{
+                .id = window->number,
+                .workspace = m_index.workspaceOf(window).value_or(0),
+                .x = static_cast<float>(window->window.getPosition().x),
+                .y = static_cast<float>(window->window.getPosition().y),
+                .width = static_cast<float>(window->window.getSize().x),
+                .height = static_cast<float>(window->window.getSize().y),
+                .alpha = window->alpha,
+                .floating = window->window.isFloating(),
+            });
+        }
+    }
+
+    void applyWindowLayout(const ReplayState& state, ReplayWindow& window, const LayoutBatch& layout, std::size_t i) {
+        if (state.renderTransform) {
+            window.box = CBox(layout.x[i], layout.y[i], layout.width[i], layout.height[i]);
+        } else {
+            window.window.setPosition(Vector2D(layout.x[i], layout.y[i]));
+            window.window.setSize(Vector2D(layout.width[i], layout.height[i]));
+        }
+        window.alpha = layout.alpha[i];
+    }
+
+    // Lands a transition at once; a landed transform-mode restore drops
+    // its render boxes
+    void transitionWindows(ReplayState& state, std::span<ReplayWindow* const> windows, const LayoutBatch& target) {
+        state.animatedWindows.clear();
+        for (std::size_t i = 0; i < windows.size(); ++i) {
+            state.animatedWindows.push_back(windows[i]->number);
+            applyWindowLayout(state, *windows[i], target, i);
+        }
+        if (state.renderTransform && state.mode == StackMode::NORMAL) {
+            for (const std::uint32_t number : state.animatedWindows) {
+                if (ReplayWindow* window = findWindow(number)) {
+                    window->box.reset();
+                }
+            }
+            state.renderTransform = false;
+        }
+    }
+
+    void selectRenderMode(ReplayState& state, std::uint8_t flags) {
+        if (state.mode == StackMode::NORMAL) {
+            state.renderTransform = flags & TRACE_RENDER_TRANSFORM;
+        }
+    }
+
+    // Walks the saved records like main.cpp, excluded windows included
+    void restoreWindows(ReplayState& state, std::int64_t workspace) {
+        m_restoreWindows.clear();
+        for (const WindowId id : m_controller.savedWindows(workspace)) {
+            m_restoreWindows.push_back(findWindow(static_cast<std::uint32_t>(id)));
+        }
+        captureWindowStates(m_restoreWindows);
+        const LayoutBatch& restore = m_controller.restoreWorkspace(state, m_states);
+        for (const RestoreSlot& slot : m_controller.restoreSlots()) {
+            m_restoreWindows[slot.index]->window.setFloating(slot.floating);
+        }
+        transitionWindows(state, m_restoreWindows, restore);
+    }
+
+    void releaseDepartedWindow(ReplayWindow& window) {
+        window.box.reset();
+        if (const SavedGeometry* saved = m_controller.savedGeometry().find(window.number)) {
+            window.window.setPosition(Vector2D(saved->x, saved->y));
+            window.window.setSize(Vector2D(saved->width, saved->height));
+            window.alpha = saved->alpha;
+            window.window.setFloating(saved->floating);
+            m_controller.savedGeometry().erase(window.number);
+        }
+    }
+
+    void onConfig(const TraceEvent& event) { m_config = buildStack3DConfig(event.config); }
+
+    void onDispatch(const TraceEvent& event) {
+        ReplayState& state = m_workspaceStates[event.workspace];
+        switch (event.type) {
+            case TraceEventType::TOGGLE: toggle(state, event); break;
+            case TraceEventType::CYCLE:
+            case TraceEventType::LAYER: cycle(state, event); break;
+            case TraceEventType::SPREAD: spread(state, event); break;
+            default: break;
+        }
+    }
+
+    void toggle(ReplayState& state, const TraceEvent& event) {
+        if (StackController::toggleRestores(state)) {
+            restoreWindows(state, event.workspace);
+            return;
+        }
+        const auto& windows = workspaceWindows(event.workspace);
+        if (windows.empty()) {
+            return;
+        }
+
+        selectRenderMode(state, event.flags);
+        captureWindowStates(windows);
+        const LayoutBatch& layout = m_controller.stackWorkspace(state, m_states, event.monitor, m_config,
+                                                                event.flags & TRACE_MOTION_ACTIVE);
+        transitionWindows(state, windows, layout);
+    }
+
+    void spread(ReplayState& state, const TraceEvent& event) {
+        const std::optional<SpreadLayout> layout =
+            event.value == TRACE_DEFAULT_LAYOUT ? std::nullopt : std::optional(static_cast<SpreadLayout>(event.value));
+        if (StackController::spreadRestores(state, layout)) {
+            restoreWindows(state, event.workspace);
+            return;
+        }
+        const auto& windows = workspaceWindows(event.workspace);
+        if (windows.empty()) {
+            return;
+        }
+
+        selectRenderMode(state, event.flags);
+        captureWindowStates(windows);
+        const LayoutBatch& target = m_controller.spreadWorkspace(state, m_states, event.monitor, m_config, layout,
+                                                                 event.flags & TRACE_MOTION_ACTIVE);
+        transitionWindows(state, windows, target);
+    }
+
+    void cycle(ReplayState& state, const TraceEvent& event) {
+        const auto& windows = workspaceWindows(event.workspace);
+        if (windows.empty() || state.mode != StackMode::STACKED) {
+            return;
+        }
+        const bool toLayer = event.type == TraceEventType::LAYER;
+        if (toLayer && !StackController::layerInRange(state, event.value)) {
+            return;
+        }
+
+        const auto& cycled = m_controller.cycleWorkspace(state, windows.size(), event.value,
+                                                         toLayer ? std::optional(event.value) : std::nullopt);
+        const StackLayoutParams params = StackController::frontParams(state);
+        for (const auto i : cycled) {
+            windows[i]->alpha = StackController::alphaFor(i, params);
+        }
+    }
+
+    void onRelayout(const TraceEvent& event) {
+        const auto found = m_workspaceStates.find(event.workspace);
+        if (found == m_workspaceStates.end() || found->second.mode == StackMode::NORMAL) {
+            return;
+        }
+        ReplayState& state = found->second;
+
+        const auto& windows = workspaceWindows(event.workspace);
+        captureWindowStates(windows);
+        m_previous.assign(state.animatedWindows.begin(), state.animatedWindows.end());
+        m_controller.diffMembers(m_previous, m_states);
+
+        for (const std::uint32_t number : state.animatedWindows) {
+            ReplayWindow* window = findWindow(number);
+            if (window && m_controller.departed(number)) {
+                releaseDepartedWindow(*window);
+            }
+        }
+        for (const std::uint32_t i : m_controller.arrivals()) {
+            m_controller.savedGeometry().erase(windows[i]->number);
+        }
+
+        if (windows.empty()) {
+            state.animatedWindows.clear();
+            state.mode = StackMode::NORMAL;
+            state.renderTransform = false;
+            return;
+        }
+
+        const LayoutBatch& target = m_controller.relayoutWorkspace(state, m_states, event.monitor, m_config);
+        transitionWindows(state, windows, target);
+    }
+
+    void onWindowOpen(const TraceEvent& event) { m_index.insert(&windowFor(event.window), event.workspace); }
+
+    void onWindowMove(const TraceEvent& event) { m_index.move(&windowFor(event.window), event.workspace); }
+
+    void onWindowClose(const TraceEvent& event) {
+        if (ReplayWindow* window = findWindow(event.window)) {
+            m_index.erase(window);
+            m_controller.savedGeometry().erase(window->number);
+            m_windows.erase(event.window);
+        }
+    }
+
+    void onWindowState(const TraceEvent& event) {
+        ReplayWindow& window = windowFor(event.window);
+        window.window.setPosition(Vector2D(event.x, event.y));
+        window.window.setSize(Vector2D(event.width, event.height));
+        window.window.setFloating(event.flags & TRACE_WINDOW_FLOATING);
+        window.window.m_bHidden = event.flags & TRACE_WINDOW_EXCLUDED;
+        window.alpha = event.alpha;
+    }
+
+    void onWorkspaceDestroy(const TraceEvent& event) {
+        m_index.eraseWorkspace(event.workspace);
+        const auto found = m_workspaceStates.find(event.workspace);
+        if (found != m_workspaceStates.end()) {
+            for (const std::uint32_t number : found->second.animatedWindows) {
+                if (ReplayWindow* window = findWindow(number)) {
+                    releaseDepartedWindow(*window);
+                }
+            }
+            m_workspaceStates.erase(found);
+        }
+        m_controller.savedGeometry().eraseWorkspace(event.workspace);
+    }
+
+    void onFinal(const TraceEvent& event) {
+        ++m_finalChecks;
+        const ReplayWindow* window = findWindow(event.window);
+        if (!window) {
+            mismatch("window " + std::to_string(event.window) + ": not open after replay");
+            return;
+        }
+        const CBox shown = window->box.value_or(window->window.getGeometry());
+        const float got[] = {static_cast<float>(shown.x), static_cast<float>(shown.y),
+                             static_cast<float>(shown.width), static_cast<float>(shown.height)};
+        const float want[] = {event.x, event.y, event.width, event.height};
+        bool matches = std::abs(window->alpha - event.alpha) <= ALPHA_TOLERANCE;
+        for (std::size_t i = 0; i < 4; ++i) {
+            matches = matches && std::abs(got[i] - want[i]) <= POSITION_TOLERANCE;
+        }
+        if (!matches) {
+            char text[256];
+            std::snprintf(text, sizeof(text),
+                          "window %u: replayed %.1f,%.1f %.1fx%.1f a=%.3f, recorded %.1f,%.1f %.1fx%.1f a=%.3f",
+                          event.window, got[0], got[1], got[2], got[3], window->alpha, want[0], want[1], want[2],
+                          want[3], event.alpha);
+            mismatch(text);
+        }
+    }
+
+    void mismatch(std::string text) {
+        if (++m_mismatchCount <= MISMATCH_REPORT_LIMIT) {
+            m_mismatches.push_back(std::move(text));
+        }
+    }
+
+    Stack3DConfig m_config = buildStack3DConfig(RawStack3DConfig{});
+    StackController m_controller;
+    WindowIndex<ReplayWindow*> m_index;
+    std::unordered_map<std::uint32_t, std::unique_ptr<ReplayWindow>> m_windows;
+    std::unordered_map<std::int64_t, ReplayState> m_workspaceStates;
+
+    // Scratch buffers reused across events
+    std::vector<ReplayWindow*> m_workspaceWindows;
+    std::vector<ReplayWindow*> m_restoreWindows;
+    std::vector<WindowState> m_states;
+    std::vector<WindowId> m_previous;
+
+    std::size_t m_finalChecks = 0;
+    std::size_t m_mismatchCount = 0;
+    std::vector<std::string> m_mismatches;
+};
+
+double percentile(std::vector<double>& samples, double fraction) {
+    const std::size_t index = std::min(samples.size() - 1, static_cast<std::size_t>(fraction * samples.size()));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* path = nullptr;
+    std::size_t repeat = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = std::max<std::size_t>(1, std::strtoul(argv[++i], nullptr, 10));
+        } else {
+            path = argv[i];
+        }
+    }
+    if (!path) {
+        std::fprintf(stderr, "usage: %s [--repeat N] trace.bin\n", argv[0]);
+        return 1;
+    }
+
+    const auto bytes = readTraceFile(path);
+    if (!bytes) {
+        std::perror(path);
+        return 1;
+    }
+
+    // Decoded once, so the timings cover only the replay
+    std::vector<TraceEvent> events;
+    TraceReader reader(*bytes);
+    if (!reader.valid()) {
+        std::fprintf(stderr, "%s: not a Stack3D trace, or of another version\n", path);
+        return 1;
+    }
+    for (TraceEvent event; reader.next(event);) {
+        events.push_back(event);
+    }
+    if (reader.corrupt()) {
+        std::fprintf(stderr, "%s: trace is cut short after %zu events\n", path, events.size());
+        return 1;
+    }
+
+    using Clock = std::chrono::steady_clock;
+    std::vector<double> samples[EVENT_TYPES];
+    double totalNs = 0.0;
+    std::size_t finalChecks = 0;
+    std::size_t mismatchCount = 0;
+    std::vector<std::string> mismatches;
+    for (std::size_t run = 0; run < repeat; ++run) {
+        TraceReplayer replayer;
+        for (const TraceEvent& event : events) {
+            const auto begin = Clock::now();
+            replayer.replay(event);
+            const double ns = std::chrono::duration<double, std::nano>(Clock::now() - begin).count();
+            samples[static_cast<std::size_t>(event.type)].push_back(ns);
+            totalNs += ns;
+        }
+        // Every run replays the same trace, so one run's verdict is enough
+        if (run == 0) {
+            finalChecks = replayer.finalChecks();
+            mismatchCount = replayer.mismatchCount();
+            mismatches = replayer.mismatches();
+        }
+    }
+
+    std::printf("%s: %zu events, %zu bytes, %zu run(s), %.3f ms total, %.0f events/s\n", path, events.size(),
+                bytes->size(), repeat, totalNs / 1e6, events.size() * repeat / (totalNs / 1e9));
+    std::printf("%-10s %10s %12s %12s %12s %12s\n", "event", "count", "mean ns", "p50 ns", "p99 ns", "max ns");
+    for (std::size_t type = 0; type < EVENT_TYPES; ++type) {
+        std::vector<double>& typeSamples = samples[type];
+        if (typeSamples.empty()) {
+            continue;
+        }
+        double total = 0.0;
+        for (const double sample : typeSamples) {
+            total += sample;
+        }
+        const double maxNs = *std::ranges::max_element(typeSamples);
+        std::printf("%-10s %10zu %12.0f %12.0f %12.0f %12.0f\n", traceEventName(static_cast<TraceEventType>(type)),
+                    typeSamples.size(), total / typeSamples.size(), percentile(typeSamples, 0.50),
+                    percentile(typeSamples, 0.99), maxNs);
+    }
+
+    for (const std::string& text : mismatches) {
+        std::printf("MISMATCH %s\n", text.c_str());
+    }
+    if (mismatchCount > 0) {
+        std::printf("FAIL: %zu of %zu windows differ from the recorded final geometry\n", mismatchCount,
+                    finalChecks);
+        return 1;
+    }
+    std::printf("OK: %zu windows match the recorded final geometry\n", finalChecks);
+    return 0;
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+// Minimal test framework shared by tests/unit. A failed assertion throws,
+// ends its test and is reported with the assertion's message; the runner
+// exits non-zero if any test of any suite failed.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct TestFailure : std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+// Failed tests of every suite run so far
+inline int& testFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+class TestSuite {
+  public:
+    explicit TestSuite(std::string name) : m_name(std::move(name)) {}
+
+    void addTest(std::string name, std::function<void()> test) { m_tests.emplace_back(std::move(name), std::move(test)); }
+
+    // Runs every test; returns the number that failed
+    int run() const {
+        std::printf("[%s]\n", m_name.c_str());
+        int failed = 0;
+        for (const auto& [name, test] : m_tests) {
+            const auto start = std::chrono::steady_clock::now();
+            std::string error;
+            try {
+                test();
+            } catch (const std::exception& e) {
+                error = e.what();
+            }
+            const double ms =
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            if (error.empty()) {
+                std::printf("  PASS  %s (%.2fms)\n", name.c_str(), ms);
+            } else {
+                std::printf("  FAIL  %s\n        %s\n", name.c_str(), error.c_str());
+                ++failed;
+            }
+        }
+        testFailures() += failed;
+        return failed;
+    }
+
+  private:
+    std::string m_name;
+    std::vector<std::pair<std::string, std::function<void()>>> m_tests;
+};
+
+namespace TestDetail {
+
+template <typename T>
+std::string describe(const T& value) {
+    if constexpr (requires(std::ostream& out) { out << value; }) {
+        std::ostringstream out;
+        out << value;
+        return out.str();
+    } else {
+        return "?";
+    }
+}
+
+[[noreturn]] inline void fail(const char* file, int line, const std::string& what, const std::string& message) {
+    std::ostringstream out;
+    out << file << ":" << line << ": " << message << " (" << what << ")";
+    throw TestFailure(out.str());
+}
+
+} // namespace TestDetail
+
+#define ASSERT_TRUE(condition, message)                                                                       \
+    do {                                                                                                      \
+        if (!(condition)) {                                                                                   \
+            TestDetail::fail(__FILE__, __LINE__, #condition, message);                                        \
+        }                                                                                                     \
+    } while (0)
+
+#define ASSERT_FALSE(condition, message) ASSERT_TRUE(!(condition), message)
+
+#define ASSERT_EQ(actual, expected, message)                                                                  \
+    do {                                                                                                      \
+        const auto& assertActual = (actual);                                                                  \
+        const auto& assertExpected = (expected);                                                              \
+        if (!(assertActual == assertExpected)) {                                                              \
+            TestDetail::fail(__FILE__, __LINE__,                                                              \
+                             #actual " = " + TestDetail::describe(assertActual) + ", expected " +              \
+                                 TestDetail::describe(assertExpected),                                        \
+                             message);                                                                        \
+        }                                                                                                     \
+    } while (0)
+
+#define ASSERT_NEAR(actual, expected, tolerance, message)                                                     \
+    do {                                                                                                      \
+        const double assertActual = static_cast<double>(actual);                                              \
+        const double assertExpected = static_cast<double>(expected);                                          \
+        if (!(std::abs(assertActual - assertExpected) <= (tolerance))) {                                      \
+            TestDetail::fail(__FILE__, __LINE__,                                                              \
+                             #actual " = " + TestDetail::describe(assertActual) + ", expected " +              \
+                                 TestDetail::describe(assertExpected),                                        \
+                             message);                                                                        \
+        }                                                                                                     \
+    } while (0)
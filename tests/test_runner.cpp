@@ -0,0 +1,92 @@
+// Runs the unit test suites in tests/unit.
+//
+//   cd tests && make test
+//   ./test_stack3d [suite...]     e.g. ./test_stack3d thumbnails session
+
+#include <cstdio>
+#include <cstring>
+
+#include "test_framework.hpp"
+
+namespace AnimationSystemTests { void runAllTests(); }
+namespace PhysicsMotionTests { void runAllTests(); }
+namespace ThumbnailCacheTests { void runAllTests(); }
+namespace OcclusionCullerTests { void runAllTests(); }
+namespace LatencyStatsTests { void runAllTests(); }
+namespace WindowFilterTests { void runAllTests(); }
+namespace WindowSearchTests { void runAllTests(); }
+namespace SessionStoreTests { void runAllTests(); }
+namespace FrameGovernorTests { void runAllTests(); }
+namespace NotificationManagerTests { void runAllTests(); }
+namespace LayoutCalculatorTests { void runAllTests(); }
+namespace StackControllerTests { void runAllTests(); }
+namespace WindowIndexTests { void runAllTests(); }
+namespace GeometryStoreTests { void runAllTests(); }
+namespace PerspectiveProjectionTests { void runAllTests(); }
+namespace Stack3DConfigTests { void runAllTests(); }
+namespace BezierCurveTests { void runAllTests(); }
+namespace SpreadLayoutTests { void runAllTests(); }
+namespace RenderTransformTests { void runAllTests(); }
+namespace DispatchTraceTests { void runAllTests(); }
+namespace MotionBlurTests { void runAllTests(); }
+
+namespace {
+
+struct Suite {
+    const char* name;
+    void (*run)();
+};
+
+constexpr Suite SUITES[] = {
+    {"animation", AnimationSystemTests::runAllTests},
+    {"physics", PhysicsMotionTests::runAllTests},
+    {"thumbnails", ThumbnailCacheTests::runAllTests},
+    {"occlusion", OcclusionCullerTests::runAllTests},
+    {"latency", LatencyStatsTests::runAllTests},
+    {"filter", WindowFilterTests::runAllTests},
+    {"search", WindowSearchTests::runAllTests},
+    {"session", SessionStoreTests::runAllTests},
+    {"governor", FrameGovernorTests::runAllTests},
+    {"notify", NotificationManagerTests::runAllTests},
+    {"layout", LayoutCalculatorTests::runAllTests},
+    {"controller", StackControllerTests::runAllTests},
+    {"windows", WindowIndexTests::runAllTests},
+    {"geometry", GeometryStoreTests::runAllTests},
+    {"perspective", PerspectiveProjectionTests::runAllTests},
+    {"config", Stack3DConfigTests::runAllTests},
+    {"bezier", BezierCurveTests::runAllTests},
+    {"spread", SpreadLayoutTests::runAllTests},
+    {"transform", RenderTransformTests::runAllTests},
+    {"trace", DispatchTraceTests::runAllTests},
+    {"blur", MotionBlurTests::runAllTests},
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        for (const Suite& suite : SUITES) {
+            suite.run();
+        }
+    }
+    for (int i = 1; i < argc; ++i) {
+        const Suite* match = nullptr;
+        for (const Suite& suite : SUITES) {
+            if (std::strcmp(suite.name, argv[i]) == 0) {
+                match = &suite;
+            }
+        }
+        if (!match) {
+            std::fprintf(stderr, "Unknown suite: %s\n", argv[i]);
+            return 2;
+        }
+        match->run();
+    }
+
+    if (testFailures() > 0) {
+        std::printf("\n%d test(s) failed\n", testFailures());
+        return 1;
+    }
+    std::printf("\nAll tests passed\n");
+    return 0;
+}
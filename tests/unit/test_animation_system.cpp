@@ -0,0 +1,111 @@
+#include "../test_framework.hpp"
+
+#include "AnimationSystem.hpp"
+
+namespace AnimationSystemTests {
+
+namespace {
+
+LayoutBatch batch(std::initializer_list<float> xs, float alpha = 1.0f) {
+    LayoutBatch out;
+    out.resize(xs.size());
+    std::size_t i = 0;
+    for (const float x : xs) {
+        out.x[i] = x;
+        out.y[i] = 10.0f;
+        out.width[i] = 800.0f;
+        out.height[i] = 600.0f;
+        out.alpha[i] = alpha;
+        ++i;
+    }
+    return out;
+}
+
+TransitionParams linear(float durationMs, float staggerMs) {
+    TransitionParams params;
+    params.durationMs = durationMs;
+    params.staggerMs = staggerMs;
+    params.style = TransitionStyle::SMOOTH_SLIDE;
+    return params;
+}
+
+} // namespace
+
+void testSettledSlotsNeverMove() {
+    AnimationSystem animation;
+    const LayoutBatch from = batch({0.0f, 100.0f});
+    animation.start(from, from, linear(100.0f, 0.0f), 0.0);
+    ASSERT_FALSE(animation.active(), "a transition onto the start geometry is done at once");
+    ASSERT_FALSE(animation.tick(50.0), "tick of a finished transition reports idle");
+    ASSERT_TRUE(animation.moved().empty(), "nothing moved");
+}
+
+void testReachesTargetExactly() {
+    AnimationSystem animation;
+    const LayoutBatch from = batch({0.0f, 100.0f}, 1.0f);
+    LayoutBatch to = batch({500.0f, 100.0f}, 0.4f);
+    to.alpha[1] = 1.0f;
+    animation.start(from, to, linear(100.0f, 0.0f), 1000.0);
+    ASSERT_TRUE(animation.active(), "slot 0 has to move");
+
+    ASSERT_TRUE(animation.tick(1050.0), "running halfway");
+    ASSERT_EQ(animation.moved().size(), std::size_t{1}, "only the slot off its target moves");
+    ASSERT_EQ(animation.moved()[0], 0u, "slot 0 moves");
+    ASSERT_TRUE(animation.current().x[0] > 0.0f && animation.current().x[0] < 500.0f, "x in between");
+
+    ASSERT_FALSE(animation.tick(1100.0), "done after the duration");
+    ASSERT_EQ(animation.current().x[0], 500.0f, "x lands on the target");
+    ASSERT_NEAR(animation.current().alpha[0], 0.4f, 1e-6, "alpha lands on the target");
+}
+
+void testStaggerDelaysLaterSlots() {
+    AnimationSystem animation;
+    animation.start(batch({0.0f, 0.0f}), batch({100.0f, 100.0f}), linear(100.0f, 50.0f), 0.0);
+
+    animation.tick(25.0);
+    ASSERT_EQ(animation.moved().size(), std::size_t{1}, "slot 1 waits for its stagger");
+    ASSERT_EQ(animation.current().x[1], 0.0f, "slot 1 still at its start");
+
+    animation.tick(100.0);
+    ASSERT_EQ(animation.moved().size(), std::size_t{2}, "both slots move once slot 1 started");
+    ASSERT_EQ(animation.current().x[0], 100.0f, "slot 0 done");
+
+    ASSERT_FALSE(animation.tick(150.0), "slot 1 done after stagger + duration");
+    ASSERT_EQ(animation.current().x[1], 100.0f, "slot 1 landed");
+}
+
+void testOvershootKeepsAlphaInRange() {
+    AnimationSystem animation;
+    TransitionParams params = linear(100.0f, 0.0f);
+    params.style = TransitionStyle::ELASTIC_OUT;
+    animation.start(batch({0.0f}, 0.4f), batch({100.0f}, 1.0f), params, 0.0);
+
+    bool overshot = false;
+    for (double now = 5.0; now < 100.0; now += 5.0) {
+        animation.tick(now);
+        overshot = overshot || animation.current().x[0] > 100.0f;
+        ASSERT_TRUE(animation.current().alpha[0] <= 1.0f, "alpha never exceeds 1");
+        ASSERT_TRUE(animation.current().alpha[0] >= 0.0f, "alpha never drops below 0");
+    }
+    ASSERT_TRUE(overshot, "the elastic easing overshoots the geometry");
+}
+
+void testCancelStops() {
+    AnimationSystem animation;
+    animation.start(batch({0.0f}), batch({100.0f}), linear(100.0f, 0.0f), 0.0);
+    animation.cancel();
+    ASSERT_FALSE(animation.active(), "cancelled");
+    ASSERT_FALSE(animation.tick(50.0), "a cancelled transition does not tick");
+}
+
+void runAllTests() {
+    TestSuite suite("AnimationSystem");
+    suite.addTest("Settled slots never move", testSettledSlotsNeverMove);
+    suite.addTest("Reaches target exactly", testReachesTargetExactly);
+    suite.addTest("Stagger delays later slots", testStaggerDelaysLaterSlots);
+    suite.addTest("Overshoot keeps alpha in range", testOvershootKeepsAlphaInRange);
+    suite.addTest("Cancel stops", testCancelStops);
+    suite.run();
+}
+
+} // namespace AnimationSystemTests
@@ -0,0 +1,57 @@
+#include "../test_framework.hpp"
+
+#include "BezierCurve.hpp"
+
+namespace BezierCurveTests {
+
+void testLinearCurveIsIdentity() {
+    const BezierCurve linear(0.25f, 0.25f, 0.75f, 0.75f);
+    for (float t : {0.0f, 0.1f, 0.5f, 0.9f, 1.0f}) {
+        ASSERT_NEAR(linear.evaluate(t), t, 1e-3, "a curve on the diagonal is the identity");
+    }
+    ASSERT_NEAR(linear.evaluate(-1.0f), 0.0f, 1e-6, "time is clamped below");
+    ASSERT_NEAR(linear.evaluate(2.0f), 1.0f, 1e-6, "time is clamped above");
+}
+
+void testEaseInOutIsSymmetric() {
+    const BezierCurve easeInOut(0.42f, 0.0f, 0.58f, 1.0f);
+    ASSERT_NEAR(easeInOut.evaluate(0.5f), 0.5f, 1e-3, "half way at half time");
+    ASSERT_TRUE(easeInOut.evaluate(0.2f) < 0.2f, "slow start");
+    ASSERT_NEAR(easeInOut.evaluate(0.2f) + easeInOut.evaluate(0.8f), 1.0f, 1e-3, "mirrored end");
+}
+
+void testEveryStyleSpansZeroToOne() {
+    for (std::int64_t value = 0; value <= static_cast<std::int64_t>(TransitionStyle::LIQUID_FLOW); ++value) {
+        const EasingFn ease = easingForStyle(transitionStyleFromConfig(value));
+        ASSERT_NEAR(ease(0.0f), 0.0f, 1e-3, "every style starts at 0");
+        ASSERT_NEAR(ease(1.0f), 1.0f, 1e-3, "and ends at 1");
+    }
+}
+
+void testBounceOutBouncesOnArrival() {
+    const EasingFn bounce = easingForStyle(TransitionStyle::BOUNCE_OUT);
+    ASSERT_TRUE(bounce(0.2f) < 0.5f, "starts slowly");
+    ASSERT_NEAR(bounce(1.0f / 2.75f), 1.0f, 1e-5, "touches the target early");
+    ASSERT_TRUE(bounce(0.5f) < bounce(1.0f / 2.75f), "and bounces back off it");
+    for (float t = 0.0f; t <= 1.0f; t += 0.05f) {
+        ASSERT_TRUE(bounce(t) <= 1.0f + 1e-6f, "never passes the target");
+    }
+}
+
+void testUnknownStyleFallsBack() {
+    ASSERT_TRUE(transitionStyleFromConfig(-1) == TransitionStyle::SMOOTH_SLIDE, "negative value");
+    ASSERT_TRUE(transitionStyleFromConfig(42) == TransitionStyle::SMOOTH_SLIDE, "value past the last style");
+    ASSERT_TRUE(transitionStyleFromConfig(2) == TransitionStyle::ELASTIC_OUT, "known values map through");
+}
+
+void runAllTests() {
+    TestSuite suite("BezierCurve");
+    suite.addTest("Linear curve is identity", testLinearCurveIsIdentity);
+    suite.addTest("Ease in-out is symmetric", testEaseInOutIsSymmetric);
+    suite.addTest("Every style spans zero to one", testEveryStyleSpansZeroToOne);
+    suite.addTest("Bounce out bounces on arrival", testBounceOutBouncesOnArrival);
+    suite.addTest("Unknown style falls back", testUnknownStyleFallsBack);
+    suite.run();
+}
+
+} // namespace BezierCurveTests
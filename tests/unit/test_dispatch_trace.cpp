@@ -0,0 +1,143 @@
+#include "../test_framework.hpp"
+
+#include "DispatchTrace.hpp"
+
+namespace DispatchTraceTests {
+
+namespace {
+
+TraceEvent dispatch(TraceEventType type, std::int64_t workspace, std::int32_t value) {
+    TraceEvent event;
+    event.type = type;
+    event.workspace = workspace;
+    event.value = value;
+    event.flags = TRACE_RENDER_TRANSFORM;
+    event.monitor = MonitorGeometry{-1920.0f, 0.0f, 1920.0f, 1080.0f, 1.5f};
+    return event;
+}
+
+std::vector<TraceEvent> readAll(const std::vector<std::uint8_t>& bytes) {
+    std::vector<TraceEvent> events;
+    TraceReader reader(bytes);
+    TraceEvent event;
+    while (reader.next(event)) {
+        events.push_back(event);
+    }
+    return events;
+}
+
+} // namespace
+
+void testRecordsRoundTrip() {
+    TraceWriter writer;
+    writer.start(1000.0);
+    TraceEvent config;
+    config.type = TraceEventType::CONFIG;
+    config.config.springStrength = 1.75;
+    config.config.windowsPerStack = 9;
+    writer.append(config, 1000.0);
+    writer.append(dispatch(TraceEventType::CYCLE, -98, -1), 1002.5);
+    writer.append(dispatch(TraceEventType::SPREAD, 3, TRACE_DEFAULT_LAYOUT), 1010.0);
+
+    const auto events = readAll(writer.bytes());
+    ASSERT_EQ(events.size(), std::size_t{3}, "every record is read back");
+    ASSERT_EQ(events[0].config.springStrength, 1.75, "config doubles round trip");
+    ASSERT_EQ(events[0].config.windowsPerStack, std::int64_t{9}, "config ints round trip");
+
+    const TraceEvent& cycle = events[1];
+    ASSERT_TRUE(cycle.type == TraceEventType::CYCLE, "the type is kept");
+    ASSERT_EQ(cycle.timeUs, std::uint64_t{2500}, "times are microseconds since start");
+    ASSERT_EQ(cycle.workspace, std::int64_t{-98}, "negative workspaces are zigzag encoded");
+    ASSERT_EQ(cycle.value, -1, "as are cycle steps");
+    ASSERT_EQ(cycle.flags, TRACE_RENDER_TRANSFORM, "dispatch flags are kept");
+    ASSERT_EQ(cycle.monitor.x, -1920.0f, "monitor geometry is kept");
+    ASSERT_EQ(cycle.monitor.scale, 1.5f, "with its scale");
+    ASSERT_EQ(events[2].value, TRACE_DEFAULT_LAYOUT, "a bare spread keeps the default layout");
+    ASSERT_EQ(events[2].timeUs, std::uint64_t{10000}, "times accumulate record deltas");
+}
+
+void testWindowNumbersAreSequential() {
+    TraceWriter writer;
+    writer.start(0.0);
+    ASSERT_EQ(writer.windowNumber(0x5600'0000'0400ULL), 0u, "the first window is 0");
+    ASSERT_EQ(writer.windowNumber(0x5600'0000'0800ULL), 1u, "the next one 1");
+    ASSERT_EQ(writer.windowNumber(0x5600'0000'0400ULL), 0u, "a known window keeps its number");
+
+    writer.forgetWindow(0x5600'0000'0400ULL);
+    ASSERT_EQ(writer.windowNumber(0x5600'0000'0400ULL), 2u, "a reused address gets a new number");
+}
+
+void testSyncWritesOnlyChanges() {
+    constexpr WindowId ID = 0x5600'0000'0400ULL;
+    TraceWriter writer;
+    writer.start(0.0);
+    const TraceWindow window{.x = 10.0f, .y = 20.0f, .width = 640.0f, .height = 480.0f, .flags = TRACE_WINDOW_FLOATING};
+    writer.syncWindow(ID, window, 1.0);
+    writer.syncWindow(ID, window, 2.0);
+    ASSERT_EQ(writer.events(), std::size_t{1}, "an unchanged window is written once");
+
+    TraceWindow stacked = window;
+    stacked.x = 500.0f;
+    stacked.alpha = 0.6f;
+    writer.expectWindow(ID, stacked);
+    writer.syncWindow(ID, stacked, 3.0);
+    ASSERT_EQ(writer.events(), std::size_t{1}, "the state the plugin left is not written");
+
+    writer.syncWindow(ID, window, 4.0);
+    const auto events = readAll(writer.bytes());
+    ASSERT_EQ(events.size(), std::size_t{2}, "a compositor move is written");
+    ASSERT_TRUE(events[1].type == TraceEventType::WINDOW_STATE, "as a window state");
+    ASSERT_EQ(events[1].x, 10.0f, "with the new geometry");
+    ASSERT_EQ(events[1].flags, TRACE_WINDOW_FLOATING, "and flags");
+}
+
+void testStoppedWriterAppendsNothing() {
+    TraceWriter writer;
+    writer.append(dispatch(TraceEventType::TOGGLE, 1, 0), 0.0);
+    ASSERT_TRUE(writer.bytes().empty(), "nothing is recorded before start");
+
+    writer.start(0.0);
+    writer.append(dispatch(TraceEventType::TOGGLE, 1, 0), 1.0);
+    writer.stop();
+    const std::size_t size = writer.bytes().size();
+    writer.append(dispatch(TraceEventType::TOGGLE, 1, 0), 2.0);
+    ASSERT_EQ(writer.bytes().size(), size, "nor after stop");
+    ASSERT_EQ(writer.events(), std::size_t{1}, "only the recorded dispatch counts");
+}
+
+void testReaderRejectsBadInput() {
+    const std::vector<std::uint8_t> foreign{'n', 'o', 't', ' ', 'a', ' ', 't', 'r', 'a', 'c', 'e'};
+    TraceReader reader(foreign);
+    TraceEvent event;
+    ASSERT_FALSE(reader.valid(), "a foreign header is rejected");
+    ASSERT_FALSE(reader.next(event), "and yields no events");
+
+    TraceWriter writer;
+    writer.start(0.0);
+    writer.append(dispatch(TraceEventType::LAYER, 1, 2), 0.0);
+    std::vector<std::uint8_t> cut = writer.bytes();
+    cut.pop_back();
+    TraceReader truncated(cut);
+    ASSERT_TRUE(truncated.valid(), "the header of a cut trace is fine");
+    ASSERT_FALSE(truncated.next(event), "a record cut short is not decoded");
+    ASSERT_TRUE(truncated.corrupt(), "and marks the trace corrupt");
+
+    std::vector<std::uint8_t> unknown = writer.bytes();
+    unknown.push_back(static_cast<std::uint8_t>(TraceEventType::COUNT));
+    TraceReader tail(unknown);
+    ASSERT_TRUE(tail.next(event), "records before an unknown type are read");
+    ASSERT_FALSE(tail.next(event), "an unknown type stops decoding");
+    ASSERT_TRUE(tail.corrupt(), "as corruption");
+}
+
+void runAllTests() {
+    TestSuite suite("DispatchTrace");
+    suite.addTest("Records round trip", testRecordsRoundTrip);
+    suite.addTest("Window numbers are sequential", testWindowNumbersAreSequential);
+    suite.addTest("Sync writes only changes", testSyncWritesOnlyChanges);
+    suite.addTest("Stopped writer appends nothing", testStoppedWriterAppendsNothing);
+    suite.addTest("Reader rejects bad input", testReaderRejectsBadInput);
+    suite.run();
+}
+
+} // namespace DispatchTraceTests
@@ -0,0 +1,101 @@
+#include "../test_framework.hpp"
+
+#include "FrameGovernor.hpp"
+
+namespace FrameGovernorTests {
+
+namespace {
+
+// 60 Hz: a 16.7 ms interval, 4.2 ms budget
+constexpr double INTERVAL_MS = 1000.0 / 60.0;
+constexpr double OVER_MS = 6.0;
+constexpr double TIGHT_MS = 3.0;
+constexpr double LIGHT_MS = 0.5;
+
+// Feeds `frames` frames of `costMs` starting at `nowMs`; true if the tier
+// changed on any of them
+bool feed(FrameGovernor& governor, int frames, double costMs, double& nowMs) {
+    bool changed = false;
+    for (int i = 0; i < frames; ++i) {
+        nowMs += INTERVAL_MS;
+        changed |= governor.record(costMs, INTERVAL_MS, nowMs);
+    }
+    return changed;
+}
+
+} // namespace
+
+void testStepsDownAfterConsecutiveOverruns() {
+    FrameGovernor governor;
+    double now = 0.0;
+    ASSERT_FALSE(feed(governor, FrameGovernor::OVERRUN_FRAMES - 1, OVER_MS, now), "a few slow frames are tolerated");
+    ASSERT_TRUE(governor.tier() == QualityTier::FULL, "still full");
+    ASSERT_TRUE(feed(governor, 1, OVER_MS, now), "the next overrun steps down");
+    ASSERT_TRUE(governor.tier() == QualityTier::NO_BLUR, "blur goes first");
+}
+
+void testHitchesDoNotCount() {
+    FrameGovernor governor;
+    double now = 0.0;
+    for (int i = 0; i < 10; ++i) {
+        feed(governor, FrameGovernor::OVERRUN_FRAMES - 1, OVER_MS, now);
+        feed(governor, 1, LIGHT_MS, now);
+    }
+    ASSERT_TRUE(governor.tier() == QualityTier::FULL, "overruns broken up by a fast frame never step down");
+}
+
+void testStopsAtWarp() {
+    FrameGovernor governor;
+    double now = 0.0;
+    feed(governor, FrameGovernor::OVERRUN_FRAMES * 10, OVER_MS, now);
+    ASSERT_TRUE(governor.tier() == QualityTier::WARP, "a sustained overload ends at warp");
+}
+
+void testRecoversWithHeadroom() {
+    FrameGovernor governor;
+    double now = 0.0;
+    feed(governor, FrameGovernor::OVERRUN_FRAMES * 2, OVER_MS, now);
+    ASSERT_TRUE(governor.tier() == QualityTier::CAPPED, "two tiers down");
+
+    const double changedAt = now;
+    ASSERT_FALSE(governor.idle(changedAt + FrameGovernor::RECOVER_MS - 1.0), "too early to step up");
+    ASSERT_TRUE(governor.idle(changedAt + FrameGovernor::RECOVER_MS), "idle frames count as headroom");
+    ASSERT_TRUE(governor.tier() == QualityTier::NO_BLUR, "one tier up");
+    ASSERT_FALSE(governor.idle(changedAt + FrameGovernor::RECOVER_MS + 1.0), "one tier at a time");
+}
+
+void testTightFramesPostponeRecovery() {
+    FrameGovernor governor;
+    double now = 0.0;
+    feed(governor, FrameGovernor::OVERRUN_FRAMES, OVER_MS, now);
+    ASSERT_TRUE(governor.tier() == QualityTier::NO_BLUR, "one tier down");
+
+    // Under budget but above the headroom: no step up for as long as it lasts
+    ASSERT_FALSE(feed(governor, 400, TIGHT_MS, now), "tight frames neither step down nor up");
+    const double tightUntil = now;
+    ASSERT_FALSE(feed(governor, 60, LIGHT_MS, now), "headroom has to last RECOVER_MS");
+    ASSERT_TRUE(governor.idle(tightUntil + FrameGovernor::RECOVER_MS), "then the tier comes back");
+    ASSERT_TRUE(governor.tier() == QualityTier::FULL, "full effects again");
+}
+
+void testReset() {
+    FrameGovernor governor;
+    double now = 0.0;
+    feed(governor, FrameGovernor::OVERRUN_FRAMES * 3, OVER_MS, now);
+    governor.reset();
+    ASSERT_TRUE(governor.tier() == QualityTier::FULL, "reset returns to full");
+    ASSERT_TRUE(governor.report().find("steps down: 0") != std::string::npos, "and clears the counters");
+}
+
+void runAllTests() {
+    TestSuite suite("FrameGovernor");
+    suite.addTest("Steps down after consecutive overruns", testStepsDownAfterConsecutiveOverruns);
+    suite.addTest("Hitches do not count", testHitchesDoNotCount);
+    suite.addTest("Stops at warp", testStopsAtWarp);
+    suite.addTest("Recovers with headroom", testRecoversWithHeadroom);
+    suite.addTest("Tight frames postpone recovery", testTightFramesPostponeRecovery);
+    suite.addTest("Reset", testReset);
+    suite.run();
+}
+
+} // namespace FrameGovernorTests
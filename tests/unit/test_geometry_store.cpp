@@ -0,0 +1,89 @@
+#include "../test_framework.hpp"
+
+#include "GeometryStore.hpp"
+
+namespace GeometryStoreTests {
+
+namespace {
+
+// Window ids are CWindow addresses in the plugin: aligned, close together
+WindowId windowId(std::size_t i) {
+    return 0x5600'0000'0000ULL + i * 0x400;
+}
+
+SavedGeometry geometry(WindowId id, std::int64_t workspace, float x) {
+    return SavedGeometry{.id = id, .workspace = workspace, .x = x, .y = 10.0f, .width = 640.0f, .height = 480.0f};
+}
+
+} // namespace
+
+void testSaveOverwritesById() {
+    GeometryStore store;
+    ASSERT_TRUE(store.find(windowId(1)) == nullptr, "an empty store finds nothing");
+    store.save(geometry(windowId(1), 1, 100.0f));
+    store.save(geometry(windowId(2), 1, 200.0f));
+    store.save(geometry(windowId(1), 1, 150.0f));
+
+    ASSERT_EQ(store.size(), std::size_t{2}, "one record per window");
+    ASSERT_EQ(store.find(windowId(1))->x, 150.0f, "a second save overwrites the record");
+    ASSERT_EQ(store.find(windowId(2))->x, 200.0f, "other records are untouched");
+}
+
+void testEraseKeepsOthersFindable() {
+    constexpr std::size_t COUNT = 1000;
+    GeometryStore store;
+    for (std::size_t i = 0; i < COUNT; ++i) {
+        store.save(geometry(windowId(i), 1, static_cast<float>(i)));
+    }
+    for (std::size_t i = 0; i < COUNT; i += 2) {
+        ASSERT_TRUE(store.erase(windowId(i)), "a saved record is erased");
+    }
+    ASSERT_FALSE(store.erase(windowId(0)), "erasing twice reports nothing erased");
+
+    ASSERT_EQ(store.size(), COUNT / 2, "half the records are left");
+    for (std::size_t i = 0; i < COUNT; ++i) {
+        const SavedGeometry* saved = store.find(windowId(i));
+        if (i % 2 == 0) {
+            ASSERT_TRUE(saved == nullptr, "an erased record is gone");
+        } else {
+            ASSERT_TRUE(saved != nullptr && saved->x == static_cast<float>(i), "the rest keep their geometry");
+        }
+    }
+}
+
+void testEraseWorkspace() {
+    GeometryStore store;
+    for (std::size_t i = 0; i < 20; ++i) {
+        store.save(geometry(windowId(i), static_cast<std::int64_t>(i % 3), static_cast<float>(i)));
+    }
+    store.eraseWorkspace(1);
+
+    for (const SavedGeometry& saved : store.records()) {
+        ASSERT_TRUE(saved.workspace != 1, "no record of the erased workspace is left");
+    }
+    ASSERT_EQ(store.size(), std::size_t{13}, "the other workspaces keep theirs");
+    ASSERT_TRUE(store.contains(windowId(3)), "records moved within the pool stay findable");
+}
+
+void testClearKeepsStoreUsable() {
+    GeometryStore store;
+    store.reserve(64);
+    store.save(geometry(windowId(1), 1, 1.0f));
+    store.clear();
+    ASSERT_TRUE(store.empty(), "clear drops every record");
+    ASSERT_FALSE(store.contains(windowId(1)), "and its index entry");
+
+    store.save(geometry(windowId(1), 2, 5.0f));
+    ASSERT_EQ(store.find(windowId(1))->workspace, std::int64_t{2}, "a cleared store takes new records");
+}
+
+void runAllTests() {
+    TestSuite suite("GeometryStore");
+    suite.addTest("Save overwrites by id", testSaveOverwritesById);
+    suite.addTest("Erase keeps others findable", testEraseKeepsOthersFindable);
+    suite.addTest("Erase workspace", testEraseWorkspace);
+    suite.addTest("Clear keeps store usable", testClearKeepsStoreUsable);
+    suite.run();
+}
+
+} // namespace GeometryStoreTests
@@ -0,0 +1,48 @@
+#include "../test_framework.hpp"
+
+#include "LatencyStats.hpp"
+
+namespace LatencyStatsTests {
+
+void testBucketBoundsAreTight() {
+    for (std::uint64_t ns : {0ull, 1ull, 15ull, 16ull, 17ull, 100ull, 1000ull, 123456ull, 9876543210ull}) {
+        const std::uint64_t bound = LatencyHistogram::bucketUpperBound(LatencyHistogram::bucketOf(ns));
+        ASSERT_TRUE(bound >= ns, "a bucket bound covers its values");
+        ASSERT_TRUE(static_cast<double>(bound - ns) <= 0.125 * static_cast<double>(ns) + 1.0,
+                    "and is within 12.5% of them");
+    }
+}
+
+void testSummary() {
+    LatencyHistogram histogram;
+    for (std::uint64_t ns = 1; ns <= 100; ++ns) {
+        histogram.record(ns * 1000);
+    }
+    const LatencySummary summary = histogram.summary();
+    ASSERT_EQ(summary.count, std::uint64_t{100}, "every sample counted");
+    ASSERT_NEAR(summary.meanNs, 50500.0, 0.5, "exact mean");
+    ASSERT_EQ(summary.maxNs, std::uint64_t{100000}, "exact max");
+    ASSERT_TRUE(summary.p50Ns >= 50000 && summary.p50Ns <= 50000 * 1.125, "p50 within a bucket");
+    ASSERT_TRUE(summary.p99Ns >= 99000 && summary.p99Ns <= 100000, "p99 within a bucket, capped at max");
+}
+
+void testReportListsPhasesWithSamples() {
+    LatencyStats stats;
+    ASSERT_EQ(stats.report(), std::string("no samples"), "empty report");
+    stats.record(LatencyPhase::TOGGLE, 2500);
+    const std::string report = stats.report();
+    ASSERT_TRUE(report.find("toggle: n=1") != std::string::npos, "the toggle phase is listed");
+    ASSERT_TRUE(report.find("cycle") == std::string::npos, "phases without samples are not");
+    stats.reset();
+    ASSERT_EQ(stats.summary(LatencyPhase::TOGGLE).count, std::uint64_t{0}, "reset clears the samples");
+}
+
+void runAllTests() {
+    TestSuite suite("LatencyStats");
+    suite.addTest("Bucket bounds are tight", testBucketBoundsAreTight);
+    suite.addTest("Summary", testSummary);
+    suite.addTest("Report lists phases with samples", testReportListsPhasesWithSamples);
+    suite.run();
+}
+
+} // namespace LatencyStatsTests
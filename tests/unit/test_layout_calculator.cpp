@@ -0,0 +1,176 @@
+#include "../test_framework.hpp"
+
+#include <algorithm>
+
+#include "LayoutCalculator.hpp"
+
+namespace LayoutCalculatorTests {
+
+namespace {
+
+constexpr MonitorGeometry MONITOR_1080P{0.0f, 0.0f, 1920.0f, 1080.0f, 1.0f};
+constexpr float PADDING = 20.0f;
+
+WindowBatch windows(std::size_t count) {
+    WindowBatch batch;
+    for (std::size_t i = 0; i < count; ++i) {
+        batch.push(i + 1, 1280.0f, 800.0f);
+    }
+    return batch;
+}
+
+// Every laid-out window lies inside the monitor
+void assertOnMonitor(const LayoutBatch& layout, const MonitorGeometry& monitor) {
+    for (std::size_t i = 0; i < layout.size(); ++i) {
+        ASSERT_TRUE(layout.x[i] >= monitor.x - 0.5f && layout.y[i] >= monitor.y - 0.5f, "window left or above");
+        ASSERT_TRUE(layout.x[i] + layout.width[i] <= monitor.x + monitor.width + 0.5f, "window right of monitor");
+        ASSERT_TRUE(layout.y[i] + layout.height[i] <= monitor.y + monitor.height + 0.5f, "window below monitor");
+    }
+}
+
+} // namespace
+
+void testStacksAroundMonitorCentre() {
+    LayoutBatch layout;
+    computeStackLayout(windows(12), MONITOR_1080P, StackLayoutParams{}, layout);
+    ASSERT_EQ(layout.size(), std::size_t{12}, "one slot per window");
+
+    // Two stacks of six, 400 apart around x = 960
+    ASSERT_NEAR(layout.x[0], 960.0f - 200.0f - 400.0f, 0.001, "first stack left of centre");
+    ASSERT_NEAR(layout.x[6], 960.0f + 200.0f - 400.0f, 0.001, "second stack right of centre");
+    ASSERT_NEAR(layout.y[0], 540.0f - 300.0f, 0.001, "front window centred vertically");
+    ASSERT_EQ(layout.width[3], 800.0f, "resized to the window box");
+    ASSERT_EQ(layout.height[3], 600.0f, "resized to the window box");
+
+    // Every layer is shifted by the depth offset
+    ASSERT_NEAR(layout.x[0] - layout.x[2], 40.0f, 0.001, "two layers deep shifts x by 2 * 20");
+    ASSERT_NEAR(layout.y[0] - layout.y[2], 30.0f, 0.001, "two layers deep shifts y by 2 * 15");
+}
+
+void testAlphaFollowsFrontLayer() {
+    StackLayoutParams params;
+    LayoutBatch layout;
+    computeStackLayout(windows(6), MONITOR_1080P, params, layout);
+    ASSERT_EQ(layout.alpha[0], 1.0f, "the front layer is opaque");
+    ASSERT_NEAR(layout.alpha[1], 0.85f, 1e-6, "one transparency step per layer");
+    ASSERT_EQ(layout.alpha[5], params.minAlpha, "the ramp stops at min_alpha");
+
+    params.frontLayer = 2;
+    computeStackLayout(windows(6), MONITOR_1080P, params, layout);
+    ASSERT_EQ(layout.alpha[2], 1.0f, "the moved front layer is opaque");
+    ASSERT_NEAR(layout.alpha[0], 1.0f, 1e-6, "layer 0 keeps its ramp value");
+    ASSERT_NEAR(layout.alpha[3], calculateAlpha(3, 2, params), 1e-6, "the kernel matches calculateAlpha()");
+}
+
+void testKeepAspectFitsTheBox() {
+    StackLayoutParams params;
+    params.keepAspect = true;
+    WindowBatch batch;
+    batch.push(1, 1600.0f, 600.0f);
+    batch.push(2, 400.0f, 300.0f);
+
+    LayoutBatch layout;
+    computeStackLayout(batch, MONITOR_1080P, params, layout);
+    ASSERT_NEAR(layout.width[0], 800.0f, 0.001, "a wide window is scaled to the box width");
+    ASSERT_NEAR(layout.height[0], 300.0f, 0.001, "with its own aspect ratio");
+    ASSERT_EQ(layout.width[1], 400.0f, "a small window is never scaled up");
+    ASSERT_EQ(layout.height[1], 300.0f, "a small window is never scaled up");
+}
+
+void testRowsCentreTheLastRow() {
+    StackLayoutParams params;
+    params.windowsPerStack = 1;
+    params.stacksPerRow = 2;
+    params.rowSpacing = 500.0f;
+
+    LayoutBatch layout;
+    computeStackLayout(windows(3), MONITOR_1080P, params, layout);
+    ASSERT_NEAR(layout.x[0] + 400.0f, layout.x[1], 0.001, "the first row holds two stacks");
+    ASSERT_NEAR(layout.y[1] + 500.0f, layout.y[2], 0.001, "the third stack starts a second row");
+    ASSERT_NEAR(layout.x[2], 960.0f - 400.0f, 0.001, "a short last row is centred");
+}
+
+void testEmptyBatch() {
+    LayoutBatch layout;
+    computeStackLayout(windows(4), MONITOR_1080P, StackLayoutParams{}, layout);
+    computeStackLayout(WindowBatch{}, MONITOR_1080P, StackLayoutParams{}, layout);
+    ASSERT_EQ(layout.size(), std::size_t{0}, "no windows, no slots");
+}
+
+void testFrontLayerChangesTouchTwoPerStack() {
+    std::vector<std::uint32_t> dirty;
+    // Stacks of six over 14 windows: the last stack only has layers 0-1
+    collectFrontLayerChanges(14, 6, 0, 2, dirty);
+    const std::vector<std::uint32_t> expected{0, 2, 6, 8, 12};
+    ASSERT_TRUE(dirty == expected, "old and new front slot of every stack deep enough, in slot order");
+
+    collectFrontLayerChanges(14, 6, 3, 3, dirty);
+    ASSERT_TRUE(dirty.empty(), "an unchanged front layer touches nothing");
+}
+
+void testFrontLayerChangesMatchKernel() {
+    StackLayoutParams params;
+    params.frontLayer = 1;
+    LayoutBatch before;
+    LayoutBatch after;
+    computeStackLayout(windows(20), MONITOR_1080P, params, before);
+    params.frontLayer = 4;
+    computeStackLayout(windows(20), MONITOR_1080P, params, after);
+
+    std::vector<std::uint32_t> dirty;
+    collectFrontLayerChanges(20, params.windowsPerStack, 1, 4, dirty);
+    for (std::uint32_t slot = 0; slot < 20; ++slot) {
+        const bool listed = std::find(dirty.begin(), dirty.end(), slot) != dirty.end();
+        ASSERT_TRUE(listed == (before.alpha[slot] != after.alpha[slot]),
+                    "exactly the slots whose alpha changed are listed");
+    }
+}
+
+void testFitsFortyWindows() {
+    const StackLayoutParams params = fitStackLayout(40, MONITOR_1080P, StackLayoutParams{}, PADDING);
+    ASSERT_EQ(params.windowsPerStack, 4, "40 windows on 1080p go in stacks of 4");
+    ASSERT_EQ(stackCount(40, params.windowsPerStack), 10, "10 stacks");
+
+    LayoutBatch layout;
+    computeStackLayout(windows(40), MONITOR_1080P, params, layout);
+    assertOnMonitor(layout, MONITOR_1080P);
+}
+
+void testHugeCountKeepsMinimumBox() {
+    const StackLayoutParams params = fitStackLayout(10000, MONITOR_1080P, StackLayoutParams{}, PADDING);
+    ASSERT_TRUE(std::min(params.windowWidth, params.windowHeight) >= ADAPTIVE_MIN_BOX - 0.01f,
+                "the box does not shrink below the minimum");
+    ASSERT_TRUE(params.windowsPerStack > StackLayoutParams{}.windowsPerStack,
+                "stacks get deeper once no more fit side by side");
+
+    LayoutBatch layout;
+    computeStackLayout(windows(10000), MONITOR_1080P, params, layout);
+    assertOnMonitor(layout, MONITOR_1080P);
+}
+
+void testMonitorSmallerThanABox() {
+    const MonitorGeometry tiny{0.0f, 0.0f, 50.0f, 40.0f, 1.0f};
+    const StackLayoutParams params = fitStackLayout(5, tiny, StackLayoutParams{}, 0.0f);
+    ASSERT_EQ(stackCount(5, params.windowsPerStack), 1, "a single stack");
+
+    LayoutBatch layout;
+    computeStackLayout(windows(5), tiny, params, layout);
+    assertOnMonitor(layout, tiny);
+}
+
+void runAllTests() {
+    TestSuite suite("LayoutCalculator");
+    suite.addTest("Stacks around monitor centre", testStacksAroundMonitorCentre);
+    suite.addTest("Alpha follows front layer", testAlphaFollowsFrontLayer);
+    suite.addTest("Keep aspect fits the box", testKeepAspectFitsTheBox);
+    suite.addTest("Rows centre the last row", testRowsCentreTheLastRow);
+    suite.addTest("Empty batch", testEmptyBatch);
+    suite.addTest("Front layer changes touch two per stack", testFrontLayerChangesTouchTwoPerStack);
+    suite.addTest("Front layer changes match kernel", testFrontLayerChangesMatchKernel);
+    suite.addTest("Fits forty windows", testFitsFortyWindows);
+    suite.addTest("Huge count keeps minimum box", testHugeCountKeepsMinimumBox);
+    suite.addTest("Monitor smaller than a box", testMonitorSmallerThanABox);
+    suite.run();
+}
+
+} // namespace LayoutCalculatorTests
@@ -0,0 +1,121 @@
+#include "../test_framework.hpp"
+
+#include <cmath>
+
+#include "MotionBlur.hpp"
+
+namespace MotionBlurTests {
+
+namespace {
+
+// `count` 100x100 windows in a row at y = 0
+LayoutBatch row(std::size_t count) {
+    LayoutBatch batch;
+    batch.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        batch.x[i] = 200.0f * static_cast<float>(i);
+        batch.width[i] = 100.0f;
+        batch.height[i] = 100.0f;
+        batch.alpha[i] = 1.0f;
+    }
+    return batch;
+}
+
+} // namespace
+
+void testVelocityFromMovedSlots() {
+    MotionBlur blur;
+    LayoutBatch layout = row(3);
+    blur.start(layout, 0.0);
+    layout.x[1] += 5.0f;
+    layout.y[1] -= 10.0f;
+    const std::uint32_t moved[] = {1};
+    blur.update(layout, moved, 10.0);
+
+    ASSERT_NEAR(blur.velocityX(1), 500.0, 0.01, "velocity is the centre step over the frame time");
+    ASSERT_NEAR(blur.velocityY(1), -1000.0, 0.01, "on both axes");
+    ASSERT_EQ(blur.velocityX(0), 0.0f, "slots that did not move are at rest");
+}
+
+void testOnlyFastSlotsBlur() {
+    MotionBlur blur;
+    LayoutBatch layout = row(3);
+    blur.start(layout, 0.0);
+    // 16 ms frame: 5 px is 312 px/s, 40 px is 2500 px/s
+    layout.x[0] += 5.0f;
+    layout.x[2] += 40.0f;
+    const std::uint32_t moved[] = {0, 2};
+    blur.update(layout, moved, 16.0);
+
+    ASSERT_EQ(blur.blurred().size(), std::size_t{1}, "only windows above MIN_SPEED blur");
+    ASSERT_EQ(blur.blurred()[0], 2u, "the fast one");
+    ASSERT_NEAR(blur.streak(2).dx, -40.0, 0.001, "the streak points back along the move");
+    ASSERT_NEAR(blur.streak(2).dy, 0.0, 0.001, "and only along it");
+}
+
+void testStreakIsCapped() {
+    MotionBlur blur;
+    LayoutBatch layout = row(1);
+    blur.start(layout, 0.0);
+    layout.x[0] += 300.0f;
+    layout.y[0] += 400.0f;
+    const std::uint32_t moved[] = {0};
+    blur.update(layout, moved, 16.0);
+
+    const BlurStreak streak = blur.streak(0);
+    ASSERT_NEAR(std::hypot(streak.dx, streak.dy), MotionBlur::MAX_STREAK, 0.001, "a long jump is capped");
+    ASSERT_NEAR(streak.dx / streak.dy, 0.75, 0.001, "keeping its direction");
+}
+
+void testRestingSlotsStopBlurring() {
+    MotionBlur blur;
+    LayoutBatch layout = row(2);
+    blur.start(layout, 0.0);
+    layout.x[0] += 50.0f;
+    const std::uint32_t first[] = {0};
+    blur.update(layout, first, 16.0);
+    ASSERT_FALSE(blur.blurred().empty(), "the moving window blurs");
+
+    // Too close to the last frame to measure: ignored
+    blur.update(layout, {}, 16.5);
+    ASSERT_FALSE(blur.blurred().empty(), "a sub-millisecond frame keeps the last state");
+
+    blur.update(layout, {}, 32.0);
+    ASSERT_TRUE(blur.blurred().empty(), "a window that stopped is not blurred");
+    ASSERT_EQ(blur.velocityX(0), 0.0f, "and is at rest");
+}
+
+void testIgnoresSlotsPastBatch() {
+    MotionBlur blur;
+    blur.start(row(1), 0.0);
+    LayoutBatch grown = row(2);
+    grown.x[1] += 100.0f;
+    const std::uint32_t moved[] = {1};
+    blur.update(grown, moved, 16.0);
+    ASSERT_TRUE(blur.blurred().empty(), "a slot start() did not see is ignored");
+
+    blur.clear();
+    ASSERT_TRUE(blur.blurred().empty(), "clear blurs nothing");
+}
+
+void testTapsFadeAlongStreak() {
+    ASSERT_NEAR(MotionBlur::tapFraction(MotionBlur::TAPS - 1), 1.0, 1e-6, "the last tap sits at the streak end");
+    ASSERT_NEAR(MotionBlur::tapAlpha(1), MotionBlur::TAP_ALPHA, 1e-6, "the nearest tap is TAP_ALPHA");
+    for (int k = 2; k < MotionBlur::TAPS; ++k) {
+        ASSERT_TRUE(MotionBlur::tapFraction(k) > MotionBlur::tapFraction(k - 1), "taps move out along the streak");
+        ASSERT_TRUE(MotionBlur::tapAlpha(k) < MotionBlur::tapAlpha(k - 1), "and fade");
+    }
+}
+
+void runAllTests() {
+    TestSuite suite("MotionBlur");
+    suite.addTest("Velocity from moved slots", testVelocityFromMovedSlots);
+    suite.addTest("Only fast slots blur", testOnlyFastSlotsBlur);
+    suite.addTest("Streak is capped", testStreakIsCapped);
+    suite.addTest("Resting slots stop blurring", testRestingSlotsStopBlurring);
+    suite.addTest("Ignores slots past batch", testIgnoresSlotsPastBatch);
+    suite.addTest("Taps fade along streak", testTapsFadeAlongStreak);
+    suite.run();
+}
+
+} // namespace MotionBlurTests
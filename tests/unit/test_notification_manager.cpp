@@ -0,0 +1,87 @@
+#include "../test_framework.hpp"
+
+#include "NotificationManager.hpp"
+
+namespace NotificationManagerTests {
+
+namespace {
+
+std::vector<std::string> g_shown;
+
+void record(const std::string& text, const NotifyColor&, int) {
+    g_shown.push_back(text);
+}
+
+NotificationManager manager(double intervalMs) {
+    g_shown.clear();
+    NotificationManager notifications(record);
+    notifications.configure(NotifyParams{.verbosity = 2, .intervalMs = intervalMs});
+    return notifications;
+}
+
+} // namespace
+
+void testFirstToastWaitsForItsWindow() {
+    NotificationManager notifications = manager(250.0);
+    notifications.post(NotifyLevel::INFO, NotifyTopic::CYCLE, NotifyColor{}, 1000, 0.0, "layer 1");
+    ASSERT_TRUE(g_shown.empty(), "the first toast is not shown at once");
+    ASSERT_EQ(notifications.nextFlushDelayMs(0.0), 250.0, "it is due when its window closes");
+
+    notifications.flush(249.0);
+    ASSERT_TRUE(g_shown.empty(), "not before");
+    notifications.flush(250.0);
+    ASSERT_EQ(g_shown.size(), std::size_t{1}, "shown when the window closes");
+}
+
+void testBurstShowsOnlyTheLatest() {
+    NotificationManager notifications = manager(250.0);
+    for (int i = 0; i < 5; ++i) {
+        notifications.post(NotifyLevel::INFO, NotifyTopic::CYCLE, NotifyColor{}, 1000, i * 30.0,
+                           [i] { return "layer " + std::to_string(i); });
+    }
+    notifications.flush(250.0);
+    ASSERT_EQ(g_shown.size(), std::size_t{1}, "one toast for the whole burst");
+    ASSERT_EQ(g_shown[0], std::string("layer 4"), "carrying the latest text");
+    ASSERT_EQ(notifications.coalesced(), std::uint64_t{4}, "the others were replaced");
+}
+
+void testToastsOfATopicStayApart() {
+    NotificationManager notifications = manager(250.0);
+    notifications.post(NotifyLevel::INFO, NotifyTopic::CYCLE, NotifyColor{}, 1000, 0.0, "a");
+    notifications.flush(250.0);
+    notifications.post(NotifyLevel::INFO, NotifyTopic::CYCLE, NotifyColor{}, 1000, 260.0, "b");
+    notifications.post(NotifyLevel::INFO, NotifyTopic::TOGGLE, NotifyColor{}, 1000, 260.0, "c");
+    notifications.flush(509.0);
+    ASSERT_EQ(g_shown.size(), std::size_t{1}, "nothing due yet");
+    notifications.flush(510.0);
+    ASSERT_EQ(g_shown.size(), std::size_t{3}, "both topics flushed together");
+}
+
+void testQuietLevelsBuildNoText() {
+    NotificationManager notifications = manager(250.0);
+    bool built = false;
+    notifications.post(NotifyLevel::DEBUG, NotifyTopic::COMMAND, NotifyColor{}, 1000, 0.0, [&] {
+        built = true;
+        return "verbose";
+    });
+    ASSERT_FALSE(built, "text above the verbosity is never built");
+    ASSERT_EQ(notifications.nextFlushDelayMs(0.0), -1.0, "nothing pending");
+}
+
+void testZeroIntervalShowsAtOnce() {
+    NotificationManager notifications = manager(0.0);
+    notifications.post(NotifyLevel::WARNING, NotifyTopic::WARNING, NotifyColor{}, 1000, 0.0, "now");
+    ASSERT_EQ(g_shown.size(), std::size_t{1}, "no coalescing without an interval");
+}
+
+void runAllTests() {
+    TestSuite suite("NotificationManager");
+    suite.addTest("First toast waits for its window", testFirstToastWaitsForItsWindow);
+    suite.addTest("Burst shows only the latest", testBurstShowsOnlyTheLatest);
+    suite.addTest("Toasts of a topic stay apart", testToastsOfATopicStayApart);
+    suite.addTest("Quiet levels build no text", testQuietLevelsBuildNoText);
+    suite.addTest("Zero interval shows at once", testZeroIntervalShowsAtOnce);
+    suite.run();
+}
+
+} // namespace NotificationManagerTests
@@ -0,0 +1,89 @@
+#include "../test_framework.hpp"
+
+#include <vector>
+
+#include "OcclusionCuller.hpp"
+
+namespace OcclusionCullerTests {
+
+namespace {
+
+struct Scene {
+    LayoutBatch rects;
+    std::vector<std::uint8_t> opaque;
+    std::vector<int> depth;
+
+    void add(float x, float y, float width, float height, bool isOpaque, int z) {
+        const std::size_t i = rects.size();
+        rects.resize(i + 1);
+        rects.x[i] = x;
+        rects.y[i] = y;
+        rects.width[i] = width;
+        rects.height[i] = height;
+        rects.alpha[i] = 1.0f;
+        opaque.push_back(isOpaque ? 1 : 0);
+        depth.push_back(z);
+    }
+};
+
+float visibleArea(const OcclusionCuller& culler, std::size_t i) {
+    float area = 0.0f;
+    for (const VisibleRect& rect : culler.visibleRects(i)) {
+        area += rect.width * rect.height;
+    }
+    return area;
+}
+
+} // namespace
+
+void testCoveredWindowIsHidden() {
+    Scene scene;
+    scene.add(0.0f, 0.0f, 800.0f, 600.0f, true, 0);
+    scene.add(20.0f, 15.0f, 700.0f, 500.0f, true, 1);
+    OcclusionCuller culler;
+    culler.compute(scene.rects, scene.opaque, scene.depth);
+    ASSERT_TRUE(culler.visibility(0) == Visibility::VISIBLE, "the front window shows");
+    ASSERT_TRUE(culler.visibility(1) == Visibility::HIDDEN, "the window behind it does not");
+    ASSERT_EQ(culler.stats().hidden, std::size_t{1}, "one hidden window counted");
+}
+
+void testOffsetWindowIsPartial() {
+    Scene scene;
+    scene.add(0.0f, 0.0f, 800.0f, 600.0f, true, 0);
+    scene.add(20.0f, 15.0f, 800.0f, 600.0f, true, 1);
+    OcclusionCuller culler;
+    culler.compute(scene.rects, scene.opaque, scene.depth);
+    ASSERT_TRUE(culler.visibility(1) == Visibility::PARTIAL, "the depth offset shows");
+    const float expected = 800.0f * 600.0f - 780.0f * 585.0f;
+    ASSERT_NEAR(visibleArea(culler, 1), expected, 1.0, "only the uncovered L-shape is visible");
+}
+
+void testTranslucentWindowCoversNothing() {
+    Scene scene;
+    scene.add(0.0f, 0.0f, 800.0f, 600.0f, false, 0);
+    scene.add(0.0f, 0.0f, 800.0f, 600.0f, true, 1);
+    OcclusionCuller culler;
+    culler.compute(scene.rects, scene.opaque, scene.depth);
+    ASSERT_TRUE(culler.visibility(1) == Visibility::VISIBLE, "a translucent window occludes nothing");
+}
+
+void testFartherWindowCoversNothing() {
+    Scene scene;
+    scene.add(0.0f, 0.0f, 800.0f, 600.0f, true, 2);
+    scene.add(0.0f, 0.0f, 800.0f, 600.0f, true, 1);
+    OcclusionCuller culler;
+    culler.compute(scene.rects, scene.opaque, scene.depth);
+    ASSERT_TRUE(culler.visibility(1) == Visibility::VISIBLE, "the closer window shows");
+    ASSERT_TRUE(culler.visibility(0) == Visibility::HIDDEN, "the farther one is covered");
+}
+
+void runAllTests() {
+    TestSuite suite("OcclusionCuller");
+    suite.addTest("Covered window is hidden", testCoveredWindowIsHidden);
+    suite.addTest("Offset window is partial", testOffsetWindowIsPartial);
+    suite.addTest("Translucent window covers nothing", testTranslucentWindowCoversNothing);
+    suite.addTest("Farther window covers nothing", testFartherWindowCoversNothing);
+    suite.run();
+}
+
+} // namespace OcclusionCullerTests
@@ -0,0 +1,88 @@
+#include "../test_framework.hpp"
+
+#include "PerspectiveProjection.hpp"
+
+namespace PerspectiveProjectionTests {
+
+namespace {
+
+constexpr MonitorGeometry MONITOR_1080P{0.0f, 0.0f, 1920.0f, 1080.0f, 1.0f};
+
+ProjectionParams params1080p() {
+    ProjectionParams params;
+    params.monitorWidth = MONITOR_1080P.width;
+    params.monitorHeight = MONITOR_1080P.height;
+    return params;
+}
+
+WindowBatch windows(std::size_t count) {
+    WindowBatch batch;
+    for (std::size_t i = 0; i < count; ++i) {
+        batch.push(i + 1, 1280.0f, 800.0f);
+    }
+    return batch;
+}
+
+} // namespace
+
+void testLayersShrinkAndRise() {
+    PerspectiveProjection projection;
+    projection.update(params1080p());
+    ASSERT_EQ(projection.layers(), 6, "one entry per layer");
+    ASSERT_EQ(projection.scales()[0], 1.0f, "the front layer is not scaled");
+    ASSERT_EQ(projection.lifts()[0], 0.0f, "nor lifted");
+    ASSERT_NEAR(projection.scales()[1], 1000.0f / 1100.0f, 1e-6, "scale is eye / (eye + depth)");
+    for (int layer = 1; layer < projection.layers(); ++layer) {
+        ASSERT_TRUE(projection.scales()[layer] < projection.scales()[layer - 1], "deeper layers are smaller");
+        ASSERT_TRUE(projection.lifts()[layer] < projection.lifts()[layer - 1], "and sit higher");
+    }
+}
+
+void testVanishingPointStaysOnMonitor() {
+    ProjectionParams params = params1080p();
+    params.perspective = 5000.0f;
+    PerspectiveProjection projection;
+    projection.update(params);
+    const float scale = projection.scales()[5];
+    ASSERT_NEAR(projection.lifts()[5], -540.0f * (1.0f - scale), 0.001,
+                "the vanishing point is clamped to half the monitor height");
+}
+
+void testUpdateRebuildsOnlyOnChange() {
+    PerspectiveProjection projection;
+    ASSERT_TRUE(projection.update(params1080p()), "the first update builds the table");
+    ASSERT_FALSE(projection.update(params1080p()), "the same inputs keep it");
+
+    ProjectionParams deeper = params1080p();
+    deeper.layers = 8;
+    ASSERT_TRUE(projection.update(deeper), "a config change rebuilds it");
+    ASSERT_EQ(projection.layers(), 8, "with the new layer count");
+}
+
+void testLayoutCentresProjectedLayers() {
+    PerspectiveProjection projection;
+    projection.update(params1080p());
+    LayoutBatch layout;
+    computePerspectiveStackLayout(windows(6), MONITOR_1080P, StackLayoutParams{}, projection, layout);
+
+    for (int layer = 0; layer < 6; ++layer) {
+        const float scale = projection.scales()[layer];
+        ASSERT_NEAR(layout.width[layer], 800.0f * scale, 0.001, "the box is scaled per layer");
+        ASSERT_NEAR(layout.x[layer] + layout.width[layer] / 2.0f, 960.0f, 0.001,
+                    "every layer stays centred on the stack");
+        ASSERT_NEAR(layout.y[layer] + layout.height[layer] / 2.0f, 540.0f + projection.lifts()[layer], 0.001,
+                    "and is lifted towards the vanishing point");
+    }
+    ASSERT_EQ(layout.alpha[0], 1.0f, "the front layer is opaque");
+}
+
+void runAllTests() {
+    TestSuite suite("PerspectiveProjection");
+    suite.addTest("Layers shrink and rise", testLayersShrinkAndRise);
+    suite.addTest("Vanishing point stays on monitor", testVanishingPointStaysOnMonitor);
+    suite.addTest("Update rebuilds only on change", testUpdateRebuildsOnlyOnChange);
+    suite.addTest("Layout centres projected layers", testLayoutCentresProjectedLayers);
+    suite.run();
+}
+
+} // namespace PerspectiveProjectionTests
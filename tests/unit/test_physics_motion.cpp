@@ -0,0 +1,108 @@
+#include "../test_framework.hpp"
+
+#include "PhysicsMotion.hpp"
+
+namespace PhysicsMotionTests {
+
+namespace {
+
+LayoutBatch batch(std::initializer_list<float> xs, float alpha = 1.0f) {
+    LayoutBatch out;
+    out.resize(xs.size());
+    std::size_t i = 0;
+    for (const float x : xs) {
+        out.x[i] = x;
+        out.y[i] = 0.0f;
+        out.width[i] = 800.0f;
+        out.height[i] = 600.0f;
+        out.alpha[i] = alpha;
+        ++i;
+    }
+    return out;
+}
+
+// Ticks at 60 Hz until the bodies sleep; the number of frames it took
+int runToRest(PhysicsMotion& physics, double startMs, int maxFrames = 600) {
+    for (int frame = 1; frame <= maxFrames; ++frame) {
+        if (!physics.tick(startMs + frame * (1000.0 / 60.0))) {
+            return frame;
+        }
+    }
+    return -1;
+}
+
+} // namespace
+
+void testBodiesOnTargetStartAsleep() {
+    PhysicsMotion physics;
+    const LayoutBatch from = batch({0.0f, 50.0f});
+    LayoutBatch to = from;
+    to.x[1] = 300.0f;
+    physics.start(from, to, PhysicsParams{}, 0.0);
+    ASSERT_EQ(physics.awakeCount(), std::size_t{1}, "only the body off its target is awake");
+}
+
+void testSettlesOnTarget() {
+    PhysicsMotion physics;
+    const LayoutBatch to = batch({400.0f, -200.0f}, 0.4f);
+    physics.start(batch({0.0f, 0.0f}, 1.0f), to, PhysicsParams{}, 0.0);
+    ASSERT_TRUE(runToRest(physics, 0.0) > 0, "bodies go to sleep");
+    for (std::size_t i = 0; i < to.size(); ++i) {
+        ASSERT_TRUE(physics.current().sameSlot(to, i), "a sleeping body sits exactly on its target");
+    }
+    ASSERT_FALSE(physics.tick(100000.0), "an idle simulation stays idle");
+    ASSERT_TRUE(physics.moved().empty(), "nothing moves once asleep");
+}
+
+void testUnderdampedOvershoots() {
+    PhysicsMotion physics;
+    physics.start(batch({0.0f}), batch({100.0f}), PhysicsParams{.springStrength = 0.8f, .damping = 0.2f}, 0.0);
+    float furthest = 0.0f;
+    for (int frame = 1; frame <= 120 && physics.tick(frame * (1000.0 / 60.0)); ++frame) {
+        furthest = std::max(furthest, physics.current().x[0]);
+    }
+    ASSERT_TRUE(furthest > 100.0f, "a low damping ratio overshoots the target");
+}
+
+void testShortFrameMovesNothing() {
+    PhysicsMotion physics;
+    physics.start(batch({0.0f}), batch({100.0f}), PhysicsParams{}, 0.0);
+    ASSERT_TRUE(physics.tick(1.0), "still running");
+    ASSERT_TRUE(physics.moved().empty(), "no step ran, so no body is reported");
+    ASSERT_EQ(physics.current().x[0], 0.0f, "the body did not move");
+}
+
+void testAlphaSwingKeepsBodyAwake() {
+    // With these constants the alpha channel passes within ALPHA_EPSILON of
+    // its target on step 30 while still moving at ~10/s
+    PhysicsMotion physics;
+    physics.start(batch({0.0f}, 0.0f), batch({0.0f}, 1.0f), PhysicsParams{.springStrength = 0.5f, .damping = 0.2f},
+                  0.0);
+    for (int i = 0; i < 30; ++i) {
+        physics.step();
+    }
+    ASSERT_TRUE(physics.active(), "a body whose opacity is still moving does not sleep");
+    ASSERT_TRUE(runToRest(physics, 0.0) > 0, "it sleeps once the swing dies down");
+    ASSERT_EQ(physics.current().alpha[0], 1.0f, "and lands on the target");
+}
+
+void testCancelStops() {
+    PhysicsMotion physics;
+    physics.start(batch({0.0f}), batch({100.0f}), PhysicsParams{}, 0.0);
+    physics.cancel();
+    ASSERT_FALSE(physics.active(), "cancelled");
+    ASSERT_FALSE(physics.tick(16.0), "a cancelled simulation does not tick");
+}
+
+void runAllTests() {
+    TestSuite suite("PhysicsMotion");
+    suite.addTest("Bodies on target start asleep", testBodiesOnTargetStartAsleep);
+    suite.addTest("Settles on target", testSettlesOnTarget);
+    suite.addTest("Underdamped overshoots", testUnderdampedOvershoots);
+    suite.addTest("Short frame moves nothing", testShortFrameMovesNothing);
+    suite.addTest("Alpha swing keeps body awake", testAlphaSwingKeepsBodyAwake);
+    suite.addTest("Cancel stops", testCancelStops);
+    suite.run();
+}
+
+} // namespace PhysicsMotionTests
@@ -0,0 +1,62 @@
+#include "../test_framework.hpp"
+
+#include "RenderTransform.hpp"
+
+namespace RenderTransformTests {
+
+void testIdenticalBoxIsIdentity() {
+    const RenderBox box{100.0f, 50.0f, 800.0f, 600.0f};
+    const RenderTransform transform = fitRenderTransform(box, box);
+    ASSERT_EQ(transform.scale, 1.0f, "no scale");
+    ASSERT_EQ(transform.x, 100.0f, "drawn where it is");
+    ASSERT_EQ(transform.y, 50.0f, "drawn where it is");
+}
+
+void testFitsCentredWithAspectKept() {
+    // A 1600x900 window drawn into an 800x600 box: width limits the scale
+    const RenderTransform transform = fitRenderTransform(RenderBox{0.0f, 0.0f, 1600.0f, 900.0f},
+                                                         RenderBox{200.0f, 100.0f, 800.0f, 600.0f});
+    ASSERT_NEAR(transform.scale, 0.5f, 1e-6, "scaled to the box width");
+    ASSERT_NEAR(transform.x, 200.0f, 1e-3, "fills the box horizontally");
+    ASSERT_NEAR(transform.y, 100.0f + (600.0f - 450.0f) / 2.0f, 1e-3, "centred vertically");
+}
+
+void testScalesUpIntoLargerBox() {
+    const RenderTransform transform = fitRenderTransform(RenderBox{0.0f, 0.0f, 400.0f, 300.0f},
+                                                         RenderBox{0.0f, 0.0f, 800.0f, 800.0f});
+    ASSERT_NEAR(transform.scale, 2.0f, 1e-6, "a small window is drawn up to the box");
+    ASSERT_NEAR(transform.y, (800.0f - 600.0f) / 2.0f, 1e-3, "centred in the taller box");
+}
+
+void testDegenerateWindowStaysFinite() {
+    const RenderTransform transform = fitRenderTransform(RenderBox{0.0f, 0.0f, 0.0f, 0.0f},
+                                                         RenderBox{0.0f, 0.0f, 100.0f, 100.0f});
+    ASSERT_NEAR(transform.scale, 100.0f, 1e-3, "an empty window is treated as one pixel");
+    ASSERT_NEAR(transform.x, 50.0f, 1e-3, "and centred");
+}
+
+void testTableKeysByWindow() {
+    RenderTransformTable table;
+    table.set(1, RenderBox{0.0f, 0.0f, 10.0f, 10.0f});
+    table.set(2, RenderBox{5.0f, 5.0f, 20.0f, 20.0f});
+    table.set(1, RenderBox{1.0f, 1.0f, 30.0f, 30.0f});
+    ASSERT_EQ(table.size(), std::size_t{2}, "one box per window");
+    ASSERT_EQ(table.find(1)->width, 30.0f, "a second set replaces the box");
+    ASSERT_TRUE(table.erase(2), "a known window is erased");
+    ASSERT_FALSE(table.erase(2), "only once");
+    ASSERT_TRUE(table.find(2) == nullptr, "an erased window has no box");
+    table.clear();
+    ASSERT_TRUE(table.empty(), "clear drops every box");
+}
+
+void runAllTests() {
+    TestSuite suite("RenderTransform");
+    suite.addTest("Identical box is identity", testIdenticalBoxIsIdentity);
+    suite.addTest("Fits centred with aspect kept", testFitsCentredWithAspectKept);
+    suite.addTest("Scales up into larger box", testScalesUpIntoLargerBox);
+    suite.addTest("Degenerate window stays finite", testDegenerateWindowStaysFinite);
+    suite.addTest("Table keys by window", testTableKeysByWindow);
+    suite.run();
+}
+
+} // namespace RenderTransformTests
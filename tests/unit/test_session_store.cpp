@@ -0,0 +1,139 @@
+#include "../test_framework.hpp"
+
+#include <filesystem>
+#include <vector>
+
+#include <unistd.h>
+
+#include "SessionStore.hpp"
+
+namespace SessionStoreTests {
+
+namespace {
+
+// Fresh file path per test, removed when the test ends
+struct TempPath {
+    std::string path;
+
+    explicit TempPath(const char* name)
+        : path((std::filesystem::temp_directory_path() /
+                ("stack3d-test-" + std::to_string(getpid()) + "-" + name + ".bin"))
+                   .string()) {
+        std::filesystem::remove(path);
+    }
+    ~TempPath() { std::filesystem::remove(path); }
+};
+
+SessionWindow window(WindowId id, float x) {
+    return SessionWindow{.id = id, .fingerprint = sessionFingerprint("kitty"), .workspace = 1, .x = x, .y = 20.0f,
+                         .width = 800.0f, .height = 600.0f, .alpha = 1.0f, .floating = 0};
+}
+
+std::vector<SessionWindow> stored(const SessionStore& store) {
+    std::vector<SessionWindow> windows;
+    for (const SessionWindow& record : store.windows()) {
+        if (record.id != 0) {
+            windows.push_back(record);
+        }
+    }
+    return windows;
+}
+
+const SessionWindow* findWindow(const std::vector<SessionWindow>& windows, WindowId id) {
+    for (const SessionWindow& record : windows) {
+        if (record.id == id) {
+            return &record;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+void testRoundTrip() {
+    TempPath file("roundtrip");
+    {
+        SessionStore store;
+        ASSERT_TRUE(store.open(file.path, 7), "a new file is created");
+        std::vector<SessionWindow> windows{window(0x1000, 10.0f), window(0x2000, 20.0f)};
+        windows[0].slot = 1;
+        const std::vector<SessionWorkspace> workspaces{SessionWorkspace{.workspace = 3, .mode = 1, .frontLayer = 2, .layout = {}}};
+        store.sync(windows, workspaces);
+    }
+
+    SessionStore store;
+    ASSERT_TRUE(store.open(file.path, 7), "the file is mapped again");
+    const std::vector<SessionWindow> windows = stored(store);
+    ASSERT_EQ(windows.size(), std::size_t{2}, "both windows were kept");
+    ASSERT_TRUE(findWindow(windows, 0x2000) && findWindow(windows, 0x2000)->x == 20.0f, "with their geometry");
+    ASSERT_TRUE(findWindow(windows, 0x1000) && findWindow(windows, 0x1000)->slot == 1u, "and their slot order");
+    ASSERT_EQ(store.workspaces()[0].workspace, std::int64_t{3}, "the workspace was kept");
+    ASSERT_EQ(store.workspaces()[0].frontLayer, 2, "with its front layer");
+}
+
+void testSyncRemovesDroppedRecords() {
+    TempPath file("drop");
+    SessionStore store;
+    ASSERT_TRUE(store.open(file.path, 7), "opened");
+    store.sync(std::vector<SessionWindow>{window(0x1000, 10.0f), window(0x2000, 20.0f)}, {});
+    store.sync(std::vector<SessionWindow>{window(0x2000, 25.0f)}, {});
+    const std::vector<SessionWindow> windows = stored(store);
+    ASSERT_EQ(windows.size(), std::size_t{1}, "the dropped window's slot is freed");
+    ASSERT_EQ(windows[0].x, 25.0f, "the kept window is updated in place");
+}
+
+void testOtherInstanceResets() {
+    TempPath file("instance");
+    {
+        SessionStore store;
+        ASSERT_TRUE(store.open(file.path, 7), "opened");
+        store.sync(std::vector<SessionWindow>{window(0x1000, 10.0f)},
+                   std::vector<SessionWorkspace>{SessionWorkspace{.workspace = 1, .mode = 1, .layout = {}}});
+    }
+    SessionStore store;
+    ASSERT_TRUE(store.open(file.path, 8), "a file of another instance is opened");
+    ASSERT_TRUE(stored(store).empty(), "but its windows are dropped");
+    ASSERT_EQ(store.workspaces()[0].mode, 0, "and so are its workspaces");
+}
+
+void testGrowsPastInitialCapacity() {
+    TempPath file("grow");
+    const std::uint32_t count = SessionStore::INITIAL_WINDOWS * 2 + 10;
+    {
+        SessionStore store;
+        ASSERT_TRUE(store.open(file.path, 7), "opened");
+        std::vector<SessionWindow> windows;
+        for (std::uint32_t i = 1; i <= count; ++i) {
+            windows.push_back(window(i * 16, static_cast<float>(i)));
+        }
+        store.sync(windows, {});
+        ASSERT_EQ(stored(store).size(), std::size_t{count}, "every window fits after growing");
+    }
+    SessionStore store;
+    ASSERT_TRUE(store.open(file.path, 7), "the grown file is mapped again");
+    const std::vector<SessionWindow> windows = stored(store);
+    ASSERT_EQ(windows.size(), std::size_t{count}, "every window survives the reopen");
+    ASSERT_EQ(findWindow(windows, count * 16)->x, static_cast<float>(count), "the last one intact");
+}
+
+void testSymlinkRefused() {
+    TempPath target("target");
+    TempPath link("link");
+    std::filesystem::create_symlink(target.path, link.path);
+
+    SessionStore store;
+    ASSERT_FALSE(store.open(link.path, 7), "a symlink at the path is not followed");
+    ASSERT_FALSE(std::filesystem::exists(target.path), "nothing is created behind it");
+}
+
+void runAllTests() {
+    TestSuite suite("SessionStore");
+    suite.addTest("Round trip", testRoundTrip);
+    suite.addTest("Sync removes dropped records", testSyncRemovesDroppedRecords);
+    suite.addTest("Other instance resets", testOtherInstanceResets);
+    suite.addTest("Grows past initial capacity", testGrowsPastInitialCapacity);
+    suite.addTest("Symlink refused", testSymlinkRefused);
+    suite.run();
+}
+
+} // namespace SessionStoreTests
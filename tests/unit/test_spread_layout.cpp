@@ -0,0 +1,93 @@
+#include "../test_framework.hpp"
+
+#include "SpreadLayout.hpp"
+
+namespace SpreadLayoutTests {
+
+namespace {
+
+constexpr MonitorGeometry MONITOR_1080P{0.0f, 0.0f, 1920.0f, 1080.0f, 1.0f};
+constexpr float EPSILON = 0.5f;
+
+// Mixed sizes so aspect ratios differ between slots
+WindowBatch windows(std::size_t count) {
+    WindowBatch batch;
+    for (std::size_t i = 0; i < count; ++i) {
+        batch.push(i + 1, i % 2 ? 1280.0f : 600.0f, i % 3 ? 800.0f : 900.0f);
+    }
+    return batch;
+}
+
+bool overlaps(const LayoutBatch& layout, std::size_t a, std::size_t b) {
+    const auto& l = layout;
+    return l.x[a] + EPSILON < l.x[b] + l.width[b] && l.x[b] + EPSILON < l.x[a] + l.width[a] &&
+        l.y[a] + EPSILON < l.y[b] + l.height[b] && l.y[b] + EPSILON < l.y[a] + l.height[a];
+}
+
+} // namespace
+
+void testEveryLayoutSpreadsWithoutOverlap() {
+    for (int value = 0; value < SPREAD_LAYOUT_COUNT; ++value) {
+        const SpreadLayoutFn kernel = spreadLayoutKernel(static_cast<SpreadLayout>(value));
+        for (std::size_t count : {1, 2, 5, 13, 40}) {
+            const WindowBatch batch = windows(count);
+            LayoutBatch layout;
+            kernel(batch, MONITOR_1080P, SpreadParams{}, layout);
+            ASSERT_EQ(layout.size(), count, "one slot per window");
+
+            for (std::size_t i = 0; i < count; ++i) {
+                ASSERT_TRUE(layout.x[i] >= -EPSILON && layout.y[i] >= -EPSILON &&
+                                layout.x[i] + layout.width[i] <= MONITOR_1080P.width + EPSILON &&
+                                layout.y[i] + layout.height[i] <= MONITOR_1080P.height + EPSILON,
+                            "every window is on the monitor");
+                ASSERT_TRUE(layout.width[i] <= batch.widths[i] + EPSILON, "windows are never scaled up");
+                ASSERT_NEAR(layout.width[i] / layout.height[i], batch.widths[i] / batch.heights[i], 0.01,
+                            "the aspect ratio is kept");
+                ASSERT_EQ(layout.alpha[i], 1.0f, "spread windows are opaque");
+                for (std::size_t j = i + 1; j < count; ++j) {
+                    ASSERT_FALSE(overlaps(layout, i, j), "cells never overlap");
+                }
+            }
+        }
+    }
+}
+
+void testGridPicksSquareCells() {
+    WindowBatch batch;
+    for (std::size_t i = 0; i < 4; ++i) {
+        batch.push(i + 1, 1920.0f, 1080.0f);
+    }
+    LayoutBatch layout;
+    computeSpreadLayout<SpreadLayout::GRID>(batch, MONITOR_1080P, SpreadParams{}, layout);
+    ASSERT_NEAR(layout.y[0], layout.y[1], 0.001, "two windows in the first row");
+    ASSERT_TRUE(layout.y[2] > layout.y[0], "two in the second");
+    ASSERT_NEAR(layout.x[0], layout.x[2], 0.001, "columns line up");
+}
+
+void testSpiralStartsAtCentre() {
+    LayoutBatch layout;
+    computeSpreadLayout<SpreadLayout::SPIRAL>(windows(1), MONITOR_1080P, SpreadParams{}, layout);
+    ASSERT_NEAR(layout.x[0] + layout.width[0] / 2.0f, 960.0f, 0.001, "a single window is centred");
+    ASSERT_NEAR(layout.y[0] + layout.height[0] / 2.0f, 540.0f, 0.001, "a single window is centred");
+}
+
+void testNamesAndConfigValues() {
+    ASSERT_TRUE(parseSpreadLayout("circular") == SpreadLayout::CIRCULAR, "layouts parse by name");
+    ASSERT_TRUE(parseSpreadLayout("3") == SpreadLayout::FIBONACCI, "and by number");
+    ASSERT_FALSE(parseSpreadLayout("4").has_value(), "a number past the last layout is rejected");
+    ASSERT_FALSE(parseSpreadLayout("2x").has_value(), "trailing garbage is rejected");
+    ASSERT_FALSE(parseSpreadLayout("hexagon").has_value(), "unknown names are rejected");
+    ASSERT_TRUE(spreadLayoutFromConfig(-1) == SpreadLayout::GRID, "a bad config value falls back to grid");
+    ASSERT_EQ(std::string(spreadLayoutName(SpreadLayout::SPIRAL)), std::string("spiral"), "names round-trip");
+}
+
+void runAllTests() {
+    TestSuite suite("SpreadLayout");
+    suite.addTest("Every layout spreads without overlap", testEveryLayoutSpreadsWithoutOverlap);
+    suite.addTest("Grid picks square cells", testGridPicksSquareCells);
+    suite.addTest("Spiral starts at centre", testSpiralStartsAtCentre);
+    suite.addTest("Names and config values", testNamesAndConfigValues);
+    suite.run();
+}
+
+} // namespace SpreadLayoutTests
@@ -0,0 +1,72 @@
+#include "../test_framework.hpp"
+
+#include "Stack3DConfig.hpp"
+
+namespace Stack3DConfigTests {
+
+void testDefaultsPassThrough() {
+    const Stack3DConfig config = buildStack3DConfig(RawStack3DConfig{});
+    ASSERT_EQ(config.layout.windowsPerStack, 6, "windows_per_stack default");
+    ASSERT_NEAR(config.transition.durationMs, 800.0f, 0.01, "seconds become milliseconds");
+    ASSERT_NEAR(config.physics.springStrength, 0.8f, 1e-6, "spring_strength default");
+    ASSERT_NEAR(config.physics.damping, 0.92f, 1e-6, "damping default");
+    ASSERT_TRUE(config.animationMode == AnimationMode::EASED, "eased by default");
+}
+
+void testSpringClampedToDocumentedRange() {
+    RawStack3DConfig raw;
+    raw.springStrength = 50.0;
+    raw.damping = 3.0;
+    Stack3DConfig config = buildStack3DConfig(raw);
+    ASSERT_NEAR(config.physics.springStrength, 2.0f, 1e-6, "spring_strength is capped at 2.0");
+    ASSERT_NEAR(config.physics.damping, 1.0f, 1e-6, "damping is capped at 1.0");
+
+    raw.springStrength = 0.0;
+    raw.damping = -1.0;
+    config = buildStack3DConfig(raw);
+    ASSERT_NEAR(config.physics.springStrength, 0.1f, 1e-6, "spring_strength is at least 0.1");
+    ASSERT_NEAR(config.physics.damping, 0.1f, 1e-6, "damping is at least 0.1");
+}
+
+void testLayoutValuesClamped() {
+    RawStack3DConfig raw;
+    raw.windowsPerStack = 0;
+    raw.windowWidth = -5.0;
+    raw.transparencyStep = 4.0;
+    raw.minAlpha = -1.0;
+    Stack3DConfig config = buildStack3DConfig(raw);
+    ASSERT_EQ(config.layout.windowsPerStack, 1, "a stack holds at least one window");
+    ASSERT_EQ(config.layout.windowWidth, 1.0f, "the window box is never empty");
+    ASSERT_EQ(config.layout.transparencyStep, 1.0f, "transparency_step is at most 1");
+    ASSERT_EQ(config.layout.minAlpha, 0.0f, "min_alpha is at least 0");
+
+    raw.windowsPerStack = 1000;
+    config = buildStack3DConfig(raw);
+    ASSERT_EQ(config.layout.windowsPerStack, MAX_WINDOWS_PER_STACK, "windows_per_stack is capped");
+}
+
+void testMotionValuesClamped() {
+    RawStack3DConfig raw;
+    raw.transitionDuration = -1.0;
+    raw.staggerDelay = -0.5;
+    raw.transitionStyle = 99;
+    raw.thumbnailScale = 0.0;
+    raw.notifyLevel = 9;
+    const Stack3DConfig config = buildStack3DConfig(raw);
+    ASSERT_EQ(config.transition.durationMs, 0.0f, "no negative duration");
+    ASSERT_EQ(config.transition.staggerMs, 0.0f, "no negative stagger");
+    ASSERT_TRUE(config.transition.style == TransitionStyle::SMOOTH_SLIDE, "an unknown style falls back");
+    ASSERT_NEAR(config.thumbnails.scale, 0.05f, 1e-6, "thumbnail_scale has a floor");
+    ASSERT_EQ(config.notify.verbosity, 3, "notify_level is capped");
+}
+
+void runAllTests() {
+    TestSuite suite("Stack3DConfig");
+    suite.addTest("Defaults pass through", testDefaultsPassThrough);
+    suite.addTest("Spring clamped to documented range", testSpringClampedToDocumentedRange);
+    suite.addTest("Layout values clamped", testLayoutValuesClamped);
+    suite.addTest("Motion values clamped", testMotionValuesClamped);
+    suite.run();
+}
+
+} // namespace Stack3DConfigTests
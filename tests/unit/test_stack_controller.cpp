@@ -0,0 +1,181 @@
+#include "../test_framework.hpp"
+
+#include <algorithm>
+
+#include "StackController.hpp"
+
+namespace StackControllerTests {
+
+namespace {
+
+constexpr MonitorGeometry MONITOR_1080P{0.0f, 0.0f, 1920.0f, 1080.0f, 1.0f};
+
+std::vector<WindowState> windows(std::size_t count) {
+    std::vector<WindowState> states;
+    for (std::size_t i = 0; i < count; ++i) {
+        states.push_back(WindowState{.id = i + 1,
+                                     .workspace = 1,
+                                     .x = 10.0f * static_cast<float>(i),
+                                     .y = 20.0f,
+                                     .width = 640.0f,
+                                     .height = 480.0f});
+    }
+    return states;
+}
+
+Stack3DConfig config() {
+    return buildStack3DConfig(RawStack3DConfig{});
+}
+
+} // namespace
+
+void testToggleRoundTrip() {
+    StackController controller;
+    StackWorkspace workspace;
+    const auto states = windows(8);
+    const Stack3DConfig cfg = config();
+
+    ASSERT_FALSE(StackController::toggleRestores(workspace), "a normal workspace stacks");
+    controller.stackWorkspace(workspace, states, MONITOR_1080P, cfg, false);
+    ASSERT_TRUE(workspace.mode == StackMode::STACKED, "toggle enters stack mode");
+    ASSERT_EQ(workspace.frontLayer, 0, "front layer starts at 0");
+
+    ASSERT_TRUE(StackController::toggleRestores(workspace), "a stacked workspace restores");
+    const LayoutBatch& restore = controller.restoreWorkspace(workspace, states);
+    ASSERT_TRUE(workspace.mode == StackMode::NORMAL, "restore leaves stack mode");
+    ASSERT_EQ(restore.size(), states.size(), "every window has saved geometry");
+    ASSERT_NEAR(restore.x[3], states[3].x, 0.001, "restored to the saved position");
+}
+
+void testRestoreWalksSavedRecords() {
+    StackController controller;
+    StackWorkspace workspace;
+    const Stack3DConfig cfg = config();
+    auto states = windows(3);
+    controller.stackWorkspace(workspace, states, MONITOR_1080P, cfg, false);
+    states[2].workspace = 2;
+    controller.stackWorkspace(workspace, std::span(states).subspan(2), MONITOR_1080P, cfg, false);
+
+    // Window 2 was excluded since; its record still lists it
+    const auto& saved = controller.savedWindows(1);
+    ASSERT_EQ(saved.size(), std::size_t{2}, "only the records of workspace 1");
+    ASSERT_TRUE(std::ranges::find(saved, WindowId{2}) != saved.end(), "the excluded window is restored too");
+}
+
+void testMovedWindowLeavesRestore() {
+    StackController controller;
+    StackWorkspace workspace;
+    const Stack3DConfig cfg = config();
+    auto states = windows(3);
+    controller.stackWorkspace(workspace, states, MONITOR_1080P, cfg, false);
+    controller.restoreWorkspace(workspace, states);
+
+    // Window 1 moves to workspace 2 while workspace 1 is back to normal
+    states[0].workspace = 2;
+    const std::span<const WindowState> stayed = std::span(states).subspan(1);
+    controller.stackWorkspace(workspace, stayed, MONITOR_1080P, cfg, false);
+    const auto& saved = controller.savedWindows(1);
+    ASSERT_EQ(saved.size(), std::size_t{2}, "the re-stack drops the moved window's record");
+    ASSERT_TRUE(std::ranges::find(saved, WindowId{1}) == saved.end(), "it is not restored with workspace 1");
+
+    const LayoutBatch& restore = controller.restoreWorkspace(workspace, stayed);
+    ASSERT_EQ(restore.size(), std::size_t{2}, "only the windows still on the workspace are restored");
+    ASSERT_FALSE(controller.savedGeometry().contains(1), "no record is left for the moved window");
+}
+
+void testRestoreSkipsWindowsMovedAway() {
+    StackController controller;
+    StackWorkspace workspace;
+    const Stack3DConfig cfg = config();
+    auto states = windows(3);
+    controller.stackWorkspace(workspace, states, MONITOR_1080P, cfg, false);
+    controller.restoreWorkspace(workspace, states);
+
+    // Re-stacked while the restore still runs: the records are kept, and
+    // window 1 has moved to workspace 2 in between
+    states[0].workspace = 2;
+    controller.stackWorkspace(workspace, std::span(states).subspan(1), MONITOR_1080P, cfg, true);
+    const LayoutBatch& restore = controller.restoreWorkspace(workspace, states);
+    ASSERT_EQ(restore.size(), std::size_t{2}, "a window on another workspace is skipped");
+    ASSERT_EQ(controller.restoreSlots()[0].index, 1u, "the slots map to the windows still there");
+    ASSERT_FALSE(controller.savedGeometry().contains(1), "and its record is dropped");
+}
+
+void testBareSpreadRestores() {
+    StackController controller;
+    StackWorkspace workspace;
+    const auto states = windows(4);
+    const Stack3DConfig cfg = config();
+
+    controller.spreadWorkspace(workspace, states, MONITOR_1080P, cfg, std::nullopt, false);
+    ASSERT_TRUE(workspace.spreadLayout == cfg.defaultLayout, "default_layout when none is given");
+    ASSERT_TRUE(StackController::spreadRestores(workspace, std::nullopt), "a bare spread while spread restores");
+    ASSERT_FALSE(StackController::spreadRestores(workspace, SpreadLayout::GRID), "a named layout re-spreads");
+}
+
+void testCycleWrapsBothWays() {
+    StackController controller;
+    StackWorkspace workspace;
+    const Stack3DConfig cfg = config();
+    controller.stackWorkspace(workspace, windows(12), MONITOR_1080P, cfg, false);
+    const int layers = workspace.layout.windowsPerStack;
+
+    controller.cycleWorkspace(workspace, 12, -1, std::nullopt);
+    ASSERT_EQ(workspace.frontLayer, layers - 1, "cycling back from 0 wraps to the last layer");
+    controller.cycleWorkspace(workspace, 12, 1, std::nullopt);
+    ASSERT_EQ(workspace.frontLayer, 0, "cycling forward wraps to 0");
+    ASSERT_FALSE(StackController::layerInRange(workspace, layers), "no layer past the stack depth");
+    controller.cycleWorkspace(workspace, 12, 0, 2);
+    ASSERT_EQ(workspace.frontLayer, 2, "a layer is jumped to directly");
+}
+
+void testRelayoutDiffsMembers() {
+    StackController controller;
+    StackWorkspace workspace;
+    const Stack3DConfig cfg = config();
+    const auto before = windows(3);
+    controller.stackWorkspace(workspace, before, MONITOR_1080P, cfg, false);
+
+    // Window 2 closed, window 9 opened
+    std::vector<WindowState> after{before[0], before[2]};
+    after.push_back(WindowState{.id = 9, .workspace = 1, .width = 300.0f, .height = 200.0f});
+    const std::vector<WindowId> previous{1, 2, 3};
+    controller.diffMembers(previous, after);
+    ASSERT_TRUE(controller.departed(2), "the closed window departed");
+    ASSERT_FALSE(controller.departed(3), "a remaining window did not");
+    ASSERT_FALSE(controller.departed(9), "a newcomer did not depart");
+    ASSERT_EQ(controller.arrivals().size(), std::size_t{1}, "one newcomer");
+    ASSERT_EQ(controller.arrivals()[0], 2u, "indexed in the new window list");
+
+    const LayoutBatch& layout = controller.relayoutWorkspace(workspace, after, MONITOR_1080P, cfg);
+    ASSERT_EQ(layout.size(), after.size(), "every window is laid out again");
+    ASSERT_TRUE(controller.savedGeometry().contains(9), "the newcomer's geometry is saved");
+}
+
+void testRelayoutClampsFrontLayer() {
+    StackController controller;
+    StackWorkspace workspace;
+    Stack3DConfig cfg = config();
+    cfg.adaptive = true;
+    controller.stackWorkspace(workspace, windows(40), MONITOR_1080P, cfg, false);
+    workspace.frontLayer = workspace.layout.windowsPerStack - 1;
+
+    controller.relayoutWorkspace(workspace, windows(2), MONITOR_1080P, cfg);
+    ASSERT_TRUE(StackController::layerInRange(workspace, workspace.frontLayer),
+                "the front layer stays within the re-fitted stacks");
+}
+
+void runAllTests() {
+    TestSuite suite("StackController");
+    suite.addTest("Toggle round trip", testToggleRoundTrip);
+    suite.addTest("Restore walks saved records", testRestoreWalksSavedRecords);
+    suite.addTest("Moved window leaves restore", testMovedWindowLeavesRestore);
+    suite.addTest("Restore skips windows moved away", testRestoreSkipsWindowsMovedAway);
+    suite.addTest("Bare spread restores", testBareSpreadRestores);
+    suite.addTest("Cycle wraps both ways", testCycleWrapsBothWays);
+    suite.addTest("Relayout diffs members", testRelayoutDiffsMembers);
+    suite.addTest("Relayout clamps front layer", testRelayoutClampsFrontLayer);
+    suite.run();
+}
+
+} // namespace StackControllerTests
@@ -0,0 +1,173 @@
+#include "../test_framework.hpp"
+
+#include <algorithm>
+
+#include "ThumbnailCache.hpp"
+
+namespace ThumbnailCacheTests {
+
+namespace {
+
+// 100x100 RGBA8 snapshots
+constexpr std::size_t SNAPSHOT_BYTES = 100 * 100 * ThumbnailCache::BYTES_PER_PIXEL;
+
+ThumbnailParams params(std::size_t snapshots, double refreshIntervalMs = 100.0) {
+    return ThumbnailParams{.budgetBytes = snapshots * SNAPSHOT_BYTES, .scale = 0.5f,
+                           .refreshIntervalMs = refreshIntervalMs};
+}
+
+bool contains(const std::vector<WindowId>& ids, WindowId id) {
+    return std::ranges::find(ids, id) != ids.end();
+}
+
+} // namespace
+
+void testBackLayerIsDueOnce() {
+    ThumbnailCache cache;
+    cache.configure(params(4));
+    cache.setBackLayer(1, true);
+    ASSERT_TRUE(contains(cache.refreshes(0.0), 1), "a new back layer needs a snapshot");
+
+    cache.stored(1, 100, 100, 0.0);
+    ASSERT_TRUE(cache.refreshes(1000.0).empty(), "a clean snapshot is not re-captured");
+    ASSERT_TRUE(cache.draw(1), "the back layer is drawn from its snapshot");
+}
+
+void testCommitsAreRateLimited() {
+    ThumbnailCache cache;
+    cache.configure(params(4, 100.0));
+    cache.setBackLayer(1, true);
+    cache.stored(1, 100, 100, 0.0);
+
+    cache.markDirty(1);
+    ASSERT_TRUE(cache.refreshes(50.0).empty(), "a commit within refresh_ms waits");
+    ASSERT_TRUE(contains(cache.refreshes(100.0), 1), "and is captured once refresh_ms passed");
+}
+
+void testFrontLayersAreNeverCaptured() {
+    ThumbnailCache cache;
+    cache.configure(params(4));
+    cache.setBackLayer(1, true);
+    cache.setBackLayer(1, false);
+    ASSERT_TRUE(cache.refreshes(0.0).empty(), "a window back at the front is drawn live");
+    ASSERT_FALSE(cache.draw(1), "and not from a snapshot");
+}
+
+void testRefreshesAreSpreadOverFrames() {
+    ThumbnailCache cache;
+    cache.configure(params(16));
+    for (WindowId id = 1; id <= 6; ++id) {
+        cache.setBackLayer(id, true);
+    }
+    const std::vector<WindowId> first = cache.refreshes(0.0);
+    ASSERT_EQ(first.size(), ThumbnailCache::MAX_REFRESHES_PER_FRAME, "captures per frame are capped");
+    for (const WindowId id : first) {
+        cache.stored(id, 100, 100, 0.0);
+    }
+    const std::vector<WindowId>& second = cache.refreshes(0.0);
+    ASSERT_EQ(second.size(), std::size_t{2}, "the rest come next frame");
+    for (const WindowId id : second) {
+        ASSERT_FALSE(contains(first, id), "each window gets its turn");
+    }
+}
+
+void testLeastRecentlyDrawnIsEvicted() {
+    ThumbnailCache cache;
+    cache.configure(params(2));
+    for (WindowId id = 1; id <= 3; ++id) {
+        cache.setBackLayer(id, true);
+    }
+    cache.stored(1, 100, 100, 0.0);
+    cache.stored(2, 100, 100, 0.0);
+    // 1 drawn after 2 was stored, so 2 is the least recently used
+    ASSERT_TRUE(cache.draw(1), "1 has a snapshot");
+    cache.stored(3, 100, 100, 0.0);
+
+    ASSERT_EQ(cache.evicted().size(), std::size_t{1}, "one snapshot over budget");
+    ASSERT_EQ(cache.evicted()[0], WindowId{2}, "the least recently drawn one goes");
+    ASSERT_TRUE(cache.bytes() <= params(2).budgetBytes, "the budget holds");
+    ASSERT_EQ(cache.snapshots(), std::size_t{2}, "two snapshots kept");
+    ASSERT_FALSE(cache.draw(2), "the evicted window is drawn live");
+}
+
+void testEvictedSnapshotWaitsForAMiss() {
+    ThumbnailCache cache;
+    cache.configure(params(1, 100.0));
+    cache.setBackLayer(1, true);
+    cache.setBackLayer(2, true);
+    cache.stored(1, 100, 100, 0.0);
+    cache.stored(2, 100, 100, 0.0);
+    ASSERT_EQ(cache.evicted()[0], WindowId{1}, "1 is evicted");
+
+    ASSERT_FALSE(contains(cache.refreshes(16.0), 1), "not re-captured the next frame");
+    ASSERT_FALSE(contains(cache.refreshes(200.0), 1), "nor once the interval passed without a draw");
+    ASSERT_FALSE(cache.draw(1), "a draw misses it");
+    ASSERT_TRUE(contains(cache.refreshes(200.0), 1), "which makes it due again");
+}
+
+void testBudgetSmallerThanTheSetDoesNotThrash() {
+    constexpr double FRAME_MS = 16.0;
+    constexpr int FRAMES = 60;
+    ThumbnailCache cache;
+    cache.configure(params(2, 100.0));
+    for (WindowId id = 1; id <= 3; ++id) {
+        cache.setBackLayer(id, true);
+    }
+
+    int captures = 0;
+    for (int frame = 0; frame < FRAMES; ++frame) {
+        const double now = frame * FRAME_MS;
+        const std::vector<WindowId> due = cache.refreshes(now);
+        for (const WindowId id : due) {
+            cache.stored(id, 100, 100, now);
+            ++captures;
+        }
+        cache.clearEvicted();
+        for (WindowId id = 1; id <= 3; ++id) {
+            cache.draw(id);
+        }
+        ASSERT_TRUE(cache.bytes() <= params(2).budgetBytes, "the budget holds");
+    }
+    // The initial three, then at most one recapture per interval
+    const int bound = 3 + static_cast<int>(FRAMES * FRAME_MS / 100.0) + 1;
+    ASSERT_TRUE(captures <= bound, "eviction does not recapture every frame");
+    ASSERT_TRUE(cache.hits() > cache.misses(), "most draws still come from snapshots");
+}
+
+void testOversizedSnapshotEvictsItself() {
+    ThumbnailCache cache;
+    cache.configure(params(1));
+    cache.setBackLayer(1, true);
+    cache.stored(1, 200, 200, 0.0);
+    ASSERT_EQ(cache.snapshots(), std::size_t{0}, "a snapshot larger than the budget is not kept");
+    ASSERT_EQ(cache.bytes(), std::size_t{0}, "and takes no memory");
+}
+
+void testDisablingEvictsEverything() {
+    ThumbnailCache cache;
+    cache.configure(params(4));
+    cache.setBackLayer(1, true);
+    cache.setBackLayer(2, true);
+    cache.stored(1, 100, 100, 0.0);
+    cache.stored(2, 100, 100, 0.0);
+    cache.configure(ThumbnailParams{.budgetBytes = 0});
+    ASSERT_EQ(cache.evicted().size(), std::size_t{2}, "every framebuffer is handed back");
+    ASSERT_EQ(cache.bytes(), std::size_t{0}, "no memory left in use");
+    ASSERT_TRUE(cache.refreshes(1000.0).empty(), "nothing is captured while disabled");
+}
+
+void runAllTests() {
+    TestSuite suite("ThumbnailCache");
+    suite.addTest("Back layer is due once", testBackLayerIsDueOnce);
+    suite.addTest("Commits are rate limited", testCommitsAreRateLimited);
+    suite.addTest("Front layers are never captured", testFrontLayersAreNeverCaptured);
+    suite.addTest("Refreshes are spread over frames", testRefreshesAreSpreadOverFrames);
+    suite.addTest("Least recently drawn is evicted", testLeastRecentlyDrawnIsEvicted);
+    suite.addTest("Evicted snapshot waits for a miss", testEvictedSnapshotWaitsForAMiss);
+    suite.addTest("Budget smaller than the set does not thrash", testBudgetSmallerThanTheSetDoesNotThrash);
+    suite.addTest("Oversized snapshot evicts itself", testOversizedSnapshotEvictsItself);
+    suite.addTest("Disabling evicts everything", testDisablingEvictsEverything);
+    suite.run();
+}
+
+} // namespace ThumbnailCacheTests
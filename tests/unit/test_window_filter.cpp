@@ -0,0 +1,79 @@
+#include "../test_framework.hpp"
+
+#include "WindowFilter.hpp"
+
+namespace WindowFilterTests {
+
+namespace {
+
+WindowFacts facts(std::string_view windowClass, std::string_view title = "title") {
+    return WindowFacts{windowClass, title, false, false, 800.0f, 600.0f};
+}
+
+} // namespace
+
+void testPatternsMatchWholeClass() {
+    WindowFilter filter;
+    WindowRuleParams rules;
+    rules.classPattern = "pavucontrol|org\\.gnome\\..*";
+    filter.configure(rules);
+    ASSERT_FALSE(filter.accepts(1, facts("pavucontrol")), "an exact class match is excluded");
+    ASSERT_FALSE(filter.accepts(2, facts("org.gnome.Calculator")), "so is a pattern match");
+    ASSERT_TRUE(filter.accepts(3, facts("pavucontrol-qt")), "a partial match is not");
+}
+
+void testInvalidPatternIsIgnored() {
+    WindowFilter filter;
+    WindowRuleParams rules;
+    rules.classPattern = "(";
+    rules.titlePattern = "secret";
+    filter.configure(rules);
+    ASSERT_FALSE(filter.error().empty(), "the broken pattern is reported");
+    ASSERT_TRUE(filter.accepts(1, facts("(")), "and ignored");
+    ASSERT_FALSE(filter.accepts(2, facts("kitty", "secret")), "the other pattern still applies");
+}
+
+void testPlainRules() {
+    WindowFilter filter;
+    WindowRuleParams rules;
+    rules.excludeFloating = true;
+    rules.excludePinned = true;
+    rules.minWidth = 200.0f;
+    rules.minHeight = 100.0f;
+    filter.configure(rules);
+    WindowFacts window = facts("kitty");
+    ASSERT_TRUE(filter.accepts(1, window), "a plain tiled window is stacked");
+    window.floating = true;
+    ASSERT_FALSE(filter.accepts(1, window), "floating windows are excluded");
+    window.floating = false;
+    window.pinned = true;
+    ASSERT_FALSE(filter.accepts(1, window), "pinned windows are excluded");
+    window.pinned = false;
+    window.height = 50.0f;
+    ASSERT_FALSE(filter.accepts(1, window), "small windows are excluded");
+}
+
+void testTitleChangeFlipsVerdict() {
+    WindowFilter filter;
+    WindowRuleParams rules;
+    rules.titlePattern = ".*Picture-in-Picture.*";
+    filter.configure(rules);
+    ASSERT_TRUE(filter.accepts(1, facts("firefox", "Mozilla Firefox")), "a normal title is stacked");
+    ASSERT_EQ(filter.cached(), std::size_t{1}, "the verdict is cached");
+    ASSERT_TRUE(filter.refresh(1, "firefox", "Picture-in-Picture"), "the new title flips the verdict");
+    ASSERT_FALSE(filter.refresh(1, "firefox", "Picture-in-Picture"), "the same title does not");
+    ASSERT_FALSE(filter.accepts(1, facts("firefox", "Picture-in-Picture")), "now excluded");
+    filter.forget(1);
+    ASSERT_EQ(filter.cached(), std::size_t{0}, "forget drops the verdict");
+}
+
+void runAllTests() {
+    TestSuite suite("WindowFilter");
+    suite.addTest("Patterns match the whole class", testPatternsMatchWholeClass);
+    suite.addTest("Invalid pattern is ignored", testInvalidPatternIsIgnored);
+    suite.addTest("Plain rules", testPlainRules);
+    suite.addTest("Title change flips verdict", testTitleChangeFlipsVerdict);
+    suite.run();
+}
+
+} // namespace WindowFilterTests
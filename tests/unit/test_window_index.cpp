@@ -0,0 +1,77 @@
+#include "../test_framework.hpp"
+
+#include "WindowIndex.hpp"
+#include "../mocks/hyprland_mocks.hpp"
+
+namespace WindowIndexTests {
+
+using HyprlandMocks::MockWindow;
+
+void testKeepsInsertionOrder() {
+    MockWindow a, b, c;
+    WindowIndex<MockWindow*> index;
+    index.insert(&a, 1);
+    index.insert(&b, 1);
+    index.insert(&c, 2);
+    index.insert(&a, 1);
+
+    const auto& windows = index.windowsOn(1);
+    ASSERT_EQ(windows.size(), std::size_t{2}, "a window is indexed once");
+    ASSERT_TRUE(windows[0] == &a && windows[1] == &b, "windows keep their insertion order");
+    ASSERT_EQ(index.size(), std::size_t{3}, "every window is counted once");
+    ASSERT_TRUE(index.windowsOn(7).empty(), "an unknown workspace has no windows");
+}
+
+void testMoveRefilesWindow() {
+    MockWindow a, b, c;
+    WindowIndex<MockWindow*> index;
+    index.insert(&a, 1);
+    index.insert(&b, 1);
+    index.insert(&c, 1);
+    index.move(&a, 2);
+
+    const auto& left = index.windowsOn(1);
+    ASSERT_TRUE(left.size() == 2 && left[0] == &b && left[1] == &c, "the rest keep their order");
+    ASSERT_EQ(index.windowsOn(2).size(), std::size_t{1}, "the window is filed under its new workspace");
+    ASSERT_TRUE(index.workspaceOf(&a) == 2, "workspaceOf follows the move");
+}
+
+void testEraseForgetsWindow() {
+    MockWindow a, b;
+    WindowIndex<MockWindow*> index;
+    index.insert(&a, 1);
+    index.insert(&b, 1);
+    index.erase(&a);
+    index.erase(&a);
+
+    ASSERT_FALSE(index.contains(&a), "an erased window is gone");
+    ASSERT_FALSE(index.workspaceOf(&a).has_value(), "and has no workspace");
+    ASSERT_EQ(index.windowsOn(1).size(), std::size_t{1}, "the other window stays");
+}
+
+void testEraseWorkspaceDropsItsWindows() {
+    MockWindow a, b, c;
+    WindowIndex<MockWindow*> index;
+    index.insert(&a, 1);
+    index.insert(&b, 1);
+    index.insert(&c, 2);
+    index.eraseWorkspace(1);
+
+    ASSERT_TRUE(index.windowsOn(1).empty(), "the workspace is dropped");
+    ASSERT_FALSE(index.contains(&a) || index.contains(&b), "with every window filed under it");
+    ASSERT_TRUE(index.contains(&c), "other workspaces keep theirs");
+
+    index.insert(&a, 1);
+    ASSERT_EQ(index.windowsOn(1).size(), std::size_t{1}, "a dropped window can be indexed again");
+}
+
+void runAllTests() {
+    TestSuite suite("WindowIndex");
+    suite.addTest("Keeps insertion order", testKeepsInsertionOrder);
+    suite.addTest("Move refiles window", testMoveRefilesWindow);
+    suite.addTest("Erase forgets window", testEraseForgetsWindow);
+    suite.addTest("Erase workspace drops its windows", testEraseWorkspaceDropsItsWindows);
+    suite.run();
+}
+
+} // namespace WindowIndexTests
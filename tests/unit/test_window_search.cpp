@@ -0,0 +1,85 @@
+#include "../test_framework.hpp"
+
+#include <algorithm>
+
+#include "WindowSearch.hpp"
+
+namespace WindowSearchTests {
+
+namespace {
+
+void addWindows(WindowSearch& search) {
+    search.reset();
+    search.add("Mozilla Firefox", "firefox");
+    search.add("~/src/stack3d - nvim", "kitty");
+    search.add("Stack3D README", "firefox");
+}
+
+} // namespace
+
+void testTypingNarrows() {
+    WindowSearch search;
+    addWindows(search);
+    search.type("fire");
+    ASSERT_EQ(search.matchCount(), std::size_t{2}, "both firefox windows match");
+    ASSERT_FALSE(search.matches(1), "the terminal does not");
+    ASSERT_EQ(search.changed().size(), std::size_t{1}, "only the terminal changed");
+    ASSERT_EQ(search.changed()[0], 1u, "slot 1 flipped");
+}
+
+void testCaseAndTerms() {
+    WindowSearch search;
+    addWindows(search);
+    search.type("STACK3D fire");
+    ASSERT_EQ(search.matchCount(), std::size_t{1}, "every term has to match, case-insensitively");
+    ASSERT_TRUE(search.matches(2), "the README window matches");
+}
+
+void testEraseWidensAgain() {
+    WindowSearch search;
+    addWindows(search);
+    search.type("nvim");
+    ASSERT_EQ(search.matchCount(), std::size_t{1}, "one terminal");
+    search.erase();
+    search.erase();
+    ASSERT_EQ(search.query(), std::string("nv"), "two characters erased");
+    ASSERT_EQ(search.matchCount(), std::size_t{1}, "still only nvim");
+    search.erase();
+    search.erase();
+    ASSERT_EQ(search.matchCount(), std::size_t{3}, "an empty query matches everything");
+    ASSERT_EQ(search.changed().size(), std::size_t{2}, "the two hidden windows came back");
+}
+
+void testSetQueryRefinesThroughPrefix() {
+    WindowSearch search;
+    addWindows(search);
+    search.setQuery("firefox");
+    ASSERT_EQ(search.matchCount(), std::size_t{2}, "both firefox windows");
+    search.setQuery("fireplace");
+    ASSERT_EQ(search.matchCount(), std::size_t{0}, "nothing matches");
+    for (std::uint32_t slot = 0; slot < 3; ++slot) {
+        ASSERT_FALSE(search.matches(slot), "every window hidden");
+    }
+}
+
+void testUtf8TypedPerCodePoint() {
+    WindowSearch search;
+    search.reset();
+    search.add("Café menu", "browser");
+    search.type("caf\xc3\xa9");
+    ASSERT_EQ(search.matchCount(), std::size_t{1}, "multi-byte characters match");
+    search.erase();
+    ASSERT_EQ(search.query(), std::string("caf"), "erase removes a whole code point");
+}
+
+void runAllTests() {
+    TestSuite suite("WindowSearch");
+    suite.addTest("Typing narrows", testTypingNarrows);
+    suite.addTest("Case and terms", testCaseAndTerms);
+    suite.addTest("Erase widens again", testEraseWidensAgain);
+    suite.addTest("setQuery refines through prefix", testSetQueryRefinesThroughPrefix);
+    suite.addTest("UTF-8 typed per code point", testUtf8TypedPerCodePoint);
+    suite.run();
+}
+
+} // namespace WindowSearchTests